@@ -73,6 +73,16 @@
 #include <stdio.h>
 #include <math.h>
 #include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+/* the four-step transforms of pffft_new_setup_threaded use pthreads, unless PFFFT_NO_THREADS is defined */
+#if !defined(PFFFT_NO_THREADS) && (defined(__unix__) || defined(__APPLE__))
+#  include <pthread.h>
+#  include <unistd.h>
+#  define PFFFT_HAVE_PTHREADS
+#endif
 
 #if defined(COMPILER_GCC)
 #  define ALWAYS_INLINE(return_type) inline return_type __attribute__ ((always_inline))
@@ -91,170 +101,104 @@
 #pragma warning( disable : 4244 4305 4204 4456 )
 #endif
 
-/* 
-   vector support macros: the rest of the code is independant of
-   SSE/Altivec/NEON -- adding support for other platforms with 4-element
-   vectors should be limited to these macros 
-*/
-
-
 // define PFFFT_SIMD_DISABLE if you want to use scalar code instead of simd code
 //#define PFFFT_SIMD_DISABLE
 
 /*
-   Altivec support macros 
-*/
-#if !defined(PFFFT_SIMD_DISABLE) && (defined(__ppc__) || defined(__ppc64__))
-typedef vector float v4sf;
-#  define SIMD_SZ 4
-#  define VZERO() ((vector float) vec_splat_u8(0))
-#  define VMUL(a,b) vec_madd(a,b, VZERO())
-#  define VADD(a,b) vec_add(a,b)
-#  define VMADD(a,b,c) vec_madd(a,b,c)
-#  define VSUB(a,b) vec_sub(a,b)
-inline v4sf ld_ps1(const float *p) { v4sf v=vec_lde(0,p); return vec_splat(vec_perm(v, v, vec_lvsl(0, p)), 0); }
-#  define LD_PS1(p) ld_ps1(&p)
-#  define INTERLEAVE2(in1, in2, out1, out2) { v4sf tmp__ = vec_mergeh(in1, in2); out2 = vec_mergel(in1, in2); out1 = tmp__; }
-#  define UNINTERLEAVE2(in1, in2, out1, out2) {                           \
-    vector unsigned char vperm1 =  (vector unsigned char)(0,1,2,3,8,9,10,11,16,17,18,19,24,25,26,27); \
-    vector unsigned char vperm2 =  (vector unsigned char)(4,5,6,7,12,13,14,15,20,21,22,23,28,29,30,31); \
-    v4sf tmp__ = vec_perm(in1, in2, vperm1); out2 = vec_perm(in1, in2, vperm2); out1 = tmp__; \
-  }
-#  define VTRANSPOSE4(x0,x1,x2,x3) {              \
-    v4sf y0 = vec_mergeh(x0, x2);               \
-    v4sf y1 = vec_mergel(x0, x2);               \
-    v4sf y2 = vec_mergeh(x1, x3);               \
-    v4sf y3 = vec_mergel(x1, x3);               \
-    x0 = vec_mergeh(y0, y2);                    \
-    x1 = vec_mergel(y0, y2);                    \
-    x2 = vec_mergeh(y1, y3);                    \
-    x3 = vec_mergel(y1, y3);                    \
-  }
-#  define VSWAPHL(a,b) vec_perm(a,b, (vector unsigned char)(16,17,18,19,20,21,22,23,8,9,10,11,12,13,14,15))
-#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0xF) == 0)
-
-/*
-  SSE1 support macros
+  Runtime dispatch: when building with gcc for x86 cpus, the fft kernels of
+  pffft_impl.h are compiled several times (scalar, SSE, AVX, AVX+FMA3 and
+  AVX-512 versions -- thanks to "#pragma GCC target", no special compiler flag is
+  needed for that), and pffft_new_setup picks the best version supported by
+  the cpu. Define PFFFT_NO_DISPATCH to only build the version selected by
+  the compiler flags, as on the other platforms.
 */
-#elif !defined(PFFFT_SIMD_DISABLE) && (defined(__x86_64__) || defined(_M_X64) || defined(i386) || defined(_M_IX86))
-
-#include <xmmintrin.h>
-typedef __m128 v4sf;
-#  define SIMD_SZ 4 // 4 floats by simd vector -- this is pretty much hardcoded in the preprocess/finalize functions anyway so you will have to work if you want to enable AVX with its 256-bit vectors.
-#  define VZERO() _mm_setzero_ps()
-#  define VMUL(a,b) _mm_mul_ps(a,b)
-#  define VADD(a,b) _mm_add_ps(a,b)
-#  define VMADD(a,b,c) _mm_add_ps(_mm_mul_ps(a,b), c)
-#  define VSUB(a,b) _mm_sub_ps(a,b)
-#  define LD_PS1(p) _mm_set1_ps(p)
-#  define INTERLEAVE2(in1, in2, out1, out2) { v4sf tmp__ = _mm_unpacklo_ps(in1, in2); out2 = _mm_unpackhi_ps(in1, in2); out1 = tmp__; }
-#  define UNINTERLEAVE2(in1, in2, out1, out2) { v4sf tmp__ = _mm_shuffle_ps(in1, in2, _MM_SHUFFLE(2,0,2,0)); out2 = _mm_shuffle_ps(in1, in2, _MM_SHUFFLE(3,1,3,1)); out1 = tmp__; }
-#  define VTRANSPOSE4(x0,x1,x2,x3) _MM_TRANSPOSE4_PS(x0,x1,x2,x3)
-#  define VSWAPHL(a,b) _mm_shuffle_ps(b, a, _MM_SHUFFLE(3,2,1,0))
-#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0xF) == 0)
-
-/*
-  ARM NEON support macros
-*/
-#elif !defined(PFFFT_SIMD_DISABLE) && defined(__arm__) 
-#  include <arm_neon.h>
-typedef float32x4_t v4sf;
-#  define SIMD_SZ 4
-#  define VZERO() vdupq_n_f32(0)
-#  define VMUL(a,b) vmulq_f32(a,b)
-#  define VADD(a,b) vaddq_f32(a,b)
-#  define VMADD(a,b,c) vmlaq_f32(c,a,b)
-#  define VSUB(a,b) vsubq_f32(a,b)
-#  define LD_PS1(p) vld1q_dup_f32(&(p))
-#  define INTERLEAVE2(in1, in2, out1, out2) { float32x4x2_t tmp__ = vzipq_f32(in1,in2); out1=tmp__.val[0]; out2=tmp__.val[1]; }
-#  define UNINTERLEAVE2(in1, in2, out1, out2) { float32x4x2_t tmp__ = vuzpq_f32(in1,in2); out1=tmp__.val[0]; out2=tmp__.val[1]; }
-#  define VTRANSPOSE4(x0,x1,x2,x3) {                                    \
-    float32x4x2_t t0_ = vzipq_f32(x0, x2);                              \
-    float32x4x2_t t1_ = vzipq_f32(x1, x3);                              \
-    float32x4x2_t u0_ = vzipq_f32(t0_.val[0], t1_.val[0]);              \
-    float32x4x2_t u1_ = vzipq_f32(t0_.val[1], t1_.val[1]);              \
-    x0 = u0_.val[0]; x1 = u0_.val[1]; x2 = u1_.val[0]; x3 = u1_.val[1]; \
-  }
-// marginally faster version
-//#  define VTRANSPOSE4(x0,x1,x2,x3) { asm("vtrn.32 %q0, %q1;\n vtrn.32 %q2,%q3\n vswp %f0,%e2\n vswp %f1,%e3" : "+w"(x0), "+w"(x1), "+w"(x2), "+w"(x3)::); }
-#  define VSWAPHL(a,b) vcombine_f32(vget_low_f32(b), vget_high_f32(a))
-#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0x3) == 0)
-#else
-#  if !defined(PFFFT_SIMD_DISABLE)
-#    warning "building with simd disabled !\n";
-#    define PFFFT_SIMD_DISABLE // fallback to scalar code
-#  endif
+#if !defined(PFFFT_SIMD_DISABLE) && !defined(PFFFT_NO_DISPATCH) && defined(COMPILER_GCC) && !defined(__clang__) \
+  && __GNUC__ >= 5 && (defined(__x86_64__) || defined(__i386__))
+#  define PFFFT_RUNTIME_DISPATCH
 #endif
 
-// fallback mode for situations where SSE/Altivec are not available, use scalar mode instead
-#ifdef PFFFT_SIMD_DISABLE
-typedef float v4sf;
-#  define SIMD_SZ 1
-#  define VZERO() 0.f
-#  define VMUL(a,b) ((a)*(b))
-#  define VADD(a,b) ((a)+(b))
-#  define VMADD(a,b,c) ((a)*(b)+(c))
-#  define VSUB(a,b) ((a)-(b))
-#  define LD_PS1(p) (p)
-#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0x3) == 0)
-#endif
-
-// shortcuts for complex multiplcations
-#define VCPLXMUL(ar,ai,br,bi) { v4sf tmp; tmp=VMUL(ar,bi); ar=VMUL(ar,br); ar=VSUB(ar,VMUL(ai,bi)); ai=VMUL(ai,br); ai=VADD(ai,tmp); }
-#define VCPLXMULCONJ(ar,ai,br,bi) { v4sf tmp; tmp=VMUL(ar,bi); ar=VMUL(ar,br); ar=VADD(ar,VMUL(ai,bi)); ai=VMUL(ai,br); ai=VSUB(ai,tmp); }
-#ifndef SVMUL
-// multiply a scalar with a vector
-#define SVMUL(f,v) VMUL(LD_PS1(f),v)
-#endif
-
-#if !defined(PFFFT_SIMD_DISABLE)
-typedef union v4sf_union {
-  v4sf  v;
-  float f[4];
-} v4sf_union;
-
-#include <string.h>
+struct PFFFT_Setup {
+  int     N;
+  int     Ncvec; // nb of complex simd vectors (N/SIMD_SZ if PFFFT_COMPLEX, N/(2*SIMD_SZ) if PFFFT_REAL)
+  int ifac[15];
+  pffft_transform_t transform;
+  float *data; // allocated room for twiddle coefs
+  int data_size; // nb of floats of 'data' (kernel setups only)
+  int shared_data; // 'data' and 'lane_twiddle' point into a blob of pffft_import_setup, they are not freed
+  float *e;    // points into 'data' , N/4*3 elements
+  float *twiddle; // points into 'data', N/4 elements
+  const struct pffft_simd_impl *simd; // the simd flavour this setup was built for
+  struct PFFFT_Setup *chirp_fft; // chirp-z setups only: the complex transform of size M >= 2N-1
+  float *chirp;     // chirp-z setups only: the N complex values exp(-i*pi*n^2/N), points into 'data'
+  float *chirp_dft; // chirp-z setups only: the M complex (unordered) dft coefficients of the conjugated chirp
+  const struct pffft_simd_impl *lane_simd; // the simd flavour of the transposed batches
+  float *lane_twiddle; // twiddles of the transposed batches (N floats, 2*N for complex), null when N is not supported
+  int lane_ifac[15];
+  struct PFFFT_Setup *rows_fft, *cols_fft; // four-step setups only: the complex transforms of size N1 and N2
+  float *step_twiddle; // four-step setups only: the N1*N2 twiddles between the two steps, points into 'data'
+  float *real_twiddle; // four-step real setups only: the twiddles of the split step, points into 'data'
+  int nthreads;
+  pffft_parallel_for_t parallel_for;
+  void *pool;
+  int cache_slot; // 1 + index of the slot of the setups shared by pffft_get_setup, 0 otherwise
+  int user_memory; // the setup and its tables are in the buffer of pffft_init_setup, nothing is freed
+};
 
-#define assertv4(v,f0,f1,f2,f3) assert(v.f[0] == (f0) && v.f[1] == (f1) && v.f[2] == (f2) && v.f[3] == (f3))
+/* same thing for the double precision transforms */
+struct PFFFTD_Setup {
+  int     N;
+  int     Ncvec;
+  int ifac[15];
+  pffft_transform_t transform;
+  double *data;
+  int data_size;
+  double *e;
+  double *twiddle;
+  const struct pffftd_simd_impl *simd;
+};
 
-/* detect bugs with the vector support macros */
-void validate_pffft_simd() {
-  float f[16] = { 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15 };
-  v4sf_union a0, a1, a2, a3, t, u; 
-  memcpy(a0.f, f, 4*sizeof(float));
-  memcpy(a1.f, f+4, 4*sizeof(float));
-  memcpy(a2.f, f+8, 4*sizeof(float));
-  memcpy(a3.f, f+12, 4*sizeof(float));
-
-  t = a0; u = a1; t.v = VZERO();
-  printf("VZERO=[%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3]); assertv4(t, 0, 0, 0, 0);
-  t.v = VADD(a1.v, a2.v);
-  printf("VADD(4:7,8:11)=[%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3]); assertv4(t, 12, 14, 16, 18);
-  t.v = VMUL(a1.v, a2.v);
-  printf("VMUL(4:7,8:11)=[%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3]); assertv4(t, 32, 45, 60, 77);
-  t.v = VMADD(a1.v, a2.v,a0.v);
-  printf("VMADD(4:7,8:11,0:3)=[%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3]); assertv4(t, 32, 46, 62, 80);
-
-  INTERLEAVE2(a1.v,a2.v,t.v,u.v);
-  printf("INTERLEAVE2(4:7,8:11)=[%2g %2g %2g %2g] [%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3], u.f[0], u.f[1], u.f[2], u.f[3]);
-  assertv4(t, 4, 8, 5, 9); assertv4(u, 6, 10, 7, 11);
-  UNINTERLEAVE2(a1.v,a2.v,t.v,u.v);
-  printf("UNINTERLEAVE2(4:7,8:11)=[%2g %2g %2g %2g] [%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3], u.f[0], u.f[1], u.f[2], u.f[3]);
-  assertv4(t, 4, 6, 8, 10); assertv4(u, 5, 7, 9, 11);
-
-  t.v=LD_PS1(f[15]);
-  printf("LD_PS1(15)=[%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3]);
-  assertv4(t, 15, 15, 15, 15);
-  t.v = VSWAPHL(a1.v, a2.v);
-  printf("VSWAPHL(4:7,8:11)=[%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3]);
-  assertv4(t, 8, 9, 6, 7);
-  VTRANSPOSE4(a0.v, a1.v, a2.v, a3.v);
-  printf("VTRANSPOSE4(0:3,4:7,8:11,12:15)=[%2g %2g %2g %2g] [%2g %2g %2g %2g] [%2g %2g %2g %2g] [%2g %2g %2g %2g]\n", 
-         a0.f[0], a0.f[1], a0.f[2], a0.f[3], a1.f[0], a1.f[1], a1.f[2], a1.f[3], 
-         a2.f[0], a2.f[1], a2.f[2], a2.f[3], a3.f[0], a3.f[1], a3.f[2], a3.f[3]); 
-  assertv4(a0, 0, 4, 8, 12); assertv4(a1, 1, 5, 9, 13); assertv4(a2, 2, 6, 10, 14); assertv4(a3, 3, 7, 11, 15);
-}
-#endif //!PFFFT_SIMD_DISABLE
+/* value of the 'ordered' argument of the transforms below for
+   pffft_transform_halfspectrum (1 being pffft_transform_ordered): the
+   canonical order, with F(N/2) moved to the end for the real transforms */
+#define PFFFT_HALF_SPECTRUM 2
+
+/* the functions compiled for one simd flavour, see pffft_impl.h */
+typedef struct pffft_simd_impl {
+  pffft_simd_t simd;
+  const char *name;
+  int simd_size;
+  PFFFT_Setup *(*new_setup)(int N, pffft_transform_t transform);
+  int (*init_setup)(PFFFT_Setup *setup, float *data, int N, pffft_transform_t transform);
+  void (*transform)(PFFFT_Setup *setup, const float *input, float *output, float *work, pffft_direction_t direction, int ordered);
+  void (*zreorder)(PFFFT_Setup *setup, const float *input, float *output, pffft_direction_t direction);
+  void (*zconvolve_accumulate)(PFFFT_Setup *setup, const float *dft_a, const float *dft_b, float *dft_ab, float scaling);
+  int (*lane_setup)(int N, pffft_transform_t transform, float *twiddle, int *ifac);
+  void (*transform_lanes)(int N, pffft_transform_t transform, const float *twiddle, const int *ifac,
+                          int howmany, const float *input, int in_stride, float *output, int out_stride, pffft_direction_t direction);
+  void (*measure)(PFFFT_Setup *setup);
+  void (*validate)(void);
+  void (*zconvolve_accumulate_many)(PFFFT_Setup *setup, int K, const float *const *dft_a, const float *const *dft_b, float *dft_ab, float scaling);
+  void (*fir)(const float *h, int ntaps, const float *x, float *y, int n);
+  void (*window)(const float *x, const float *w, float *y, int n, int accumulate);
+  void (*power_spectrum)(PFFFT_Setup *setup, const float *spectrum, float *power);
+} pffft_simd_impl;
+
+typedef struct pffftd_simd_impl {
+  pffft_simd_t simd;
+  const char *name;
+  int simd_size;
+  PFFFTD_Setup *(*new_setup)(int N, pffft_transform_t transform);
+  int (*init_setup)(PFFFTD_Setup *setup, double *data, int N, pffft_transform_t transform);
+  void (*transform)(PFFFTD_Setup *setup, const double *input, double *output, double *work, pffft_direction_t direction, int ordered);
+  void (*zreorder)(PFFFTD_Setup *setup, const double *input, double *output, pffft_direction_t direction);
+  void (*zconvolve_accumulate)(PFFFTD_Setup *setup, const double *dft_a, const double *dft_b, double *dft_ab, double scaling);
+  int (*lane_setup)(int N, pffft_transform_t transform, double *twiddle, int *ifac);
+  void (*transform_lanes)(int N, pffft_transform_t transform, const double *twiddle, const int *ifac,
+                          int howmany, const double *input, int in_stride, double *output, int out_stride, pffft_direction_t direction);
+  void (*measure)(PFFFTD_Setup *setup);
+  void (*validate)(void);
+  void (*zconvolve_accumulate_many)(PFFFTD_Setup *setup, int K, const double *const *dft_a, const double *const *dft_b, double *dft_ab, double scaling);
+} pffftd_simd_impl;
 
 /* SSE and co like 16-bytes aligned pointers */
 #define MALLOC_V4SF_ALIGNMENT 64 // with a 64-byte alignment, we are even aligned on L2 cache lines...
@@ -270,1620 +214,1895 @@ void pffft_aligned_free(void *p) {
   if (p) free(*((void **) p - 1));
 }
 
-int pffft_simd_size() { return SIMD_SZ; }
+void pffft_destroy_setup(PFFFT_Setup *s) {
+  if (s->user_memory) return;
+  if (s->chirp_fft) pffft_destroy_setup(s->chirp_fft);
+  if (s->rows_fft) pffft_destroy_setup(s->rows_fft);
+  if (s->cols_fft) pffft_destroy_setup(s->cols_fft);
+  if (!s->shared_data) {
+    pffft_aligned_free(s->lane_twiddle);
+    pffft_aligned_free(s->data);
+  }
+  free(s);
+}
+
+void pffftd_destroy_setup(PFFFTD_Setup *s) {
+  pffft_aligned_free(s->data);
+  free(s);
+}
+
+/* wall clock time in seconds, for the timings of PFFFT_MEASURE */
+static double pffft_wall_clock(void) {
+#if defined(TIME_UTC)
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + 1e-9*(double)ts.tv_nsec;
+#else
+  return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+#define PFFFT_ALIGN64(n) (((n) + 63) & ~(size_t)63)
 
 /*
-  passf2 and passb2 has been merged here, fsign = -1 for passf2, +1 for passb2
+  scratch areas of the transforms called with a NULL 'work' pointer: they
+  are taken from the stack up to PFFFT_MAX_STACK_SCRATCH bytes (never in
+  PFFFT_SCRATCH_THREAD mode), and from the scratch arena of the thread
+  otherwise. The arena is a list of blocks used as a stack (the areas are
+  released in the reverse order), which are only allocated when it grows,
+  and freed when the thread exits (with pthreads) or by
+  pffft_scratch_release. Without thread local storage, the areas are
+  allocated and freed for each transform.
 */
-static NEVER_INLINE(void) passf2_ps(int ido, int l1, const v4sf *cc, v4sf *ch, const float *wa1, float fsign) {
-  int k, i;
-  int l1ido = l1*ido;
-  if (ido <= 2) {
-    for (k=0; k < l1ido; k += ido, ch += ido, cc+= 2*ido) {
-      ch[0]         = VADD(cc[0], cc[ido+0]);
-      ch[l1ido]     = VSUB(cc[0], cc[ido+0]);
-      ch[1]         = VADD(cc[1], cc[ido+1]);
-      ch[l1ido + 1] = VSUB(cc[1], cc[ido+1]);
-    }
+#define PFFFT_MAX_STACK_SCRATCH 65536
+
+#if defined(COMPILER_MSVC)
+#  define PFFFT_THREAD_LOCAL __declspec(thread)
+#elif defined(COMPILER_GCC)
+#  define PFFFT_THREAD_LOCAL __thread
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#  define PFFFT_THREAD_LOCAL _Thread_local
+#endif
+
+static pffft_scratch_t pffft_scratch_policy = PFFFT_SCRATCH_AUTO;
+
+void pffft_scratch_mode(pffft_scratch_t mode) {
+  pffft_scratch_policy = mode;
+}
+
+static int pffft_scratch_on_stack(size_t nb_bytes) {
+  return (pffft_scratch_policy == PFFFT_SCRATCH_AUTO && nb_bytes <= PFFFT_MAX_STACK_SCRATCH);
+}
+
+#ifdef PFFFT_THREAD_LOCAL
+
+typedef struct pffft_scratch_block {
+  struct pffft_scratch_block *next;
+  size_t size, used; // in bytes, of the area that follows the (64-byte) header
+} pffft_scratch_block;
+
+#define PFFFT_SCRATCH_HEADER PFFFT_ALIGN64(sizeof(pffft_scratch_block))
+#define PFFFT_SCRATCH_DATA(b) ((char*)(b) + PFFFT_SCRATCH_HEADER)
+
+static PFFFT_THREAD_LOCAL pffft_scratch_block *pffft_scratch_arena = 0;
+
+static void pffft_scratch_free_blocks(void *arena) {
+  pffft_scratch_block *b = (pffft_scratch_block*)arena, *next;
+  for (; b; b = next) { next = b->next; pffft_aligned_free(b); }
+}
+
+#ifdef PFFFT_HAVE_PTHREADS
+/* frees the arena of the threads that exit */
+static pthread_key_t pffft_scratch_key;
+static pthread_once_t pffft_scratch_key_once = PTHREAD_ONCE_INIT;
+static void pffft_scratch_make_key(void) { pthread_key_create(&pffft_scratch_key, pffft_scratch_free_blocks); }
+#endif
+
+/* appends a block of 'size' bytes to the arena of the thread */
+static pffft_scratch_block *pffft_scratch_add_block(pffft_scratch_block *last, size_t size) {
+  pffft_scratch_block *b = (pffft_scratch_block*)pffft_aligned_malloc(PFFFT_SCRATCH_HEADER + size);
+  if (!b) return 0;
+  b->next = 0; b->size = size; b->used = 0;
+  if (last) {
+    last->next = b;
   } else {
-    for (k=0; k < l1ido; k += ido, ch += ido, cc += 2*ido) {
-      for (i=0; i<ido-1; i+=2) {
-        v4sf tr2 = VSUB(cc[i+0], cc[i+ido+0]);
-        v4sf ti2 = VSUB(cc[i+1], cc[i+ido+1]);
-        v4sf wr = LD_PS1(wa1[i]), wi = VMUL(LD_PS1(fsign), LD_PS1(wa1[i+1]));
-        ch[i]   = VADD(cc[i+0], cc[i+ido+0]);
-        ch[i+1] = VADD(cc[i+1], cc[i+ido+1]);
-        VCPLXMUL(tr2, ti2, wr, wi);
-        ch[i+l1ido]   = tr2;
-        ch[i+l1ido+1] = ti2;
-      }
-    }
+    pffft_scratch_arena = b;
+#ifdef PFFFT_HAVE_PTHREADS
+    pthread_once(&pffft_scratch_key_once, pffft_scratch_make_key);
+    pthread_setspecific(pffft_scratch_key, b);
+#endif
   }
+  return b;
 }
 
-/*
-  passf3 and passb3 has been merged here, fsign = -1 for passf3, +1 for passb3
-*/
-static NEVER_INLINE(void) passf3_ps(int ido, int l1, const v4sf *cc, v4sf *ch,
-                                    const float *wa1, const float *wa2, float fsign) {
-  static const float taur = -0.5f;
-  float taui = 0.866025403784439f*fsign;
-  int i, k;
-  v4sf tr2, ti2, cr2, ci2, cr3, ci3, dr2, di2, dr3, di3;
-  int l1ido = l1*ido;
-  float wr1, wi1, wr2, wi2;
-  assert(ido > 2);
-  for (k=0; k< l1ido; k += ido, cc+= 3*ido, ch +=ido) {
-    for (i=0; i<ido-1; i+=2) {
-      tr2 = VADD(cc[i+ido], cc[i+2*ido]);
-      cr2 = VADD(cc[i], SVMUL(taur,tr2));
-      ch[i]    = VADD(cc[i], tr2);
-      ti2 = VADD(cc[i+ido+1], cc[i+2*ido+1]);
-      ci2 = VADD(cc[i    +1], SVMUL(taur,ti2));
-      ch[i+1]  = VADD(cc[i+1], ti2);
-      cr3 = SVMUL(taui, VSUB(cc[i+ido], cc[i+2*ido]));
-      ci3 = SVMUL(taui, VSUB(cc[i+ido+1], cc[i+2*ido+1]));
-      dr2 = VSUB(cr2, ci3);
-      dr3 = VADD(cr2, ci3);
-      di2 = VADD(ci2, cr3);
-      di3 = VSUB(ci2, cr3);
-      wr1=wa1[i], wi1=fsign*wa1[i+1], wr2=wa2[i], wi2=fsign*wa2[i+1]; 
-      VCPLXMUL(dr2, di2, LD_PS1(wr1), LD_PS1(wi1));
-      ch[i+l1ido] = dr2; 
-      ch[i+l1ido + 1] = di2;
-      VCPLXMUL(dr3, di3, LD_PS1(wr2), LD_PS1(wi2));
-      ch[i+2*l1ido] = dr3;
-      ch[i+2*l1ido+1] = di3;
+static void *pffft_scratch_alloc(size_t nb_bytes) {
+  pffft_scratch_block *b, *top = 0, *last = 0;
+  size_t total = 0;
+  nb_bytes = PFFFT_ALIGN64(nb_bytes);
+  /* the areas in use are at the start of the list, take the first free one that is large enough */
+  for (b = pffft_scratch_arena; b; b = b->next) { if (b->used) top = b; }
+  for (b = (top ? top : pffft_scratch_arena); b; last = b, b = b->next) {
+    if (b->used + nb_bytes <= b->size) {
+      b->used += nb_bytes;
+      return PFFFT_SCRATCH_DATA(b) + b->used - nb_bytes;
     }
   }
-} /* passf3 */
-
-static NEVER_INLINE(void) passf4_ps(int ido, int l1, const v4sf *cc, v4sf *ch,
-                                    const float *wa1, const float *wa2, const float *wa3, float fsign) {
-  /* isign == -1 for forward transform and +1 for backward transform */
-
-  int i, k;
-  v4sf ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
-  int l1ido = l1*ido;
-  if (ido == 2) {
-    for (k=0; k < l1ido; k += ido, ch += ido, cc += 4*ido) {
-      tr1 = VSUB(cc[0], cc[2*ido + 0]);
-      tr2 = VADD(cc[0], cc[2*ido + 0]);
-      ti1 = VSUB(cc[1], cc[2*ido + 1]);
-      ti2 = VADD(cc[1], cc[2*ido + 1]);
-      ti4 = VMUL(VSUB(cc[1*ido + 0], cc[3*ido + 0]), LD_PS1(fsign));
-      tr4 = VMUL(VSUB(cc[3*ido + 1], cc[1*ido + 1]), LD_PS1(fsign));
-      tr3 = VADD(cc[ido + 0], cc[3*ido + 0]);
-      ti3 = VADD(cc[ido + 1], cc[3*ido + 1]);
-
-      ch[0*l1ido + 0] = VADD(tr2, tr3);
-      ch[0*l1ido + 1] = VADD(ti2, ti3);
-      ch[1*l1ido + 0] = VADD(tr1, tr4);
-      ch[1*l1ido + 1] = VADD(ti1, ti4);
-      ch[2*l1ido + 0] = VSUB(tr2, tr3);
-      ch[2*l1ido + 1] = VSUB(ti2, ti3);        
-      ch[3*l1ido + 0] = VSUB(tr1, tr4);
-      ch[3*l1ido + 1] = VSUB(ti1, ti4);
+  for (b = pffft_scratch_arena; b; last = b, b = b->next) total += b->size;
+  b = pffft_scratch_add_block(last, (nb_bytes > total ? nb_bytes : total));
+  if (!b) return 0;
+  b->used = nb_bytes;
+  return PFFFT_SCRATCH_DATA(b);
+}
+
+static void pffft_scratch_free(void *p) {
+  pffft_scratch_block *b;
+  for (b = pffft_scratch_arena; b; b = b->next) {
+    if ((char*)p >= PFFFT_SCRATCH_DATA(b) && (char*)p < PFFFT_SCRATCH_DATA(b) + b->size) {
+      b->used = (size_t)((char*)p - PFFFT_SCRATCH_DATA(b));
+      return;
     }
-  } else {
-    for (k=0; k < l1ido; k += ido, ch+=ido, cc += 4*ido) {
-      for (i=0; i<ido-1; i+=2) {
-        float wr1, wi1, wr2, wi2, wr3, wi3;
-        tr1 = VSUB(cc[i + 0], cc[i + 2*ido + 0]);
-        tr2 = VADD(cc[i + 0], cc[i + 2*ido + 0]);
-        ti1 = VSUB(cc[i + 1], cc[i + 2*ido + 1]);
-        ti2 = VADD(cc[i + 1], cc[i + 2*ido + 1]);
-        tr4 = VMUL(VSUB(cc[i + 3*ido + 1], cc[i + 1*ido + 1]), LD_PS1(fsign));
-        ti4 = VMUL(VSUB(cc[i + 1*ido + 0], cc[i + 3*ido + 0]), LD_PS1(fsign));
-        tr3 = VADD(cc[i + ido + 0], cc[i + 3*ido + 0]);
-        ti3 = VADD(cc[i + ido + 1], cc[i + 3*ido + 1]);
-
-        ch[i] = VADD(tr2, tr3);
-        cr3    = VSUB(tr2, tr3);
-        ch[i + 1] = VADD(ti2, ti3);
-        ci3 = VSUB(ti2, ti3);
-
-        cr2 = VADD(tr1, tr4);
-        cr4 = VSUB(tr1, tr4);
-        ci2 = VADD(ti1, ti4);
-        ci4 = VSUB(ti1, ti4);
-        wr1=wa1[i], wi1=fsign*wa1[i+1];
-        VCPLXMUL(cr2, ci2, LD_PS1(wr1), LD_PS1(wi1));
-        wr2=wa2[i], wi2=fsign*wa2[i+1]; 
-        ch[i + l1ido] = cr2;
-        ch[i + l1ido + 1] = ci2;
-
-        VCPLXMUL(cr3, ci3, LD_PS1(wr2), LD_PS1(wi2));
-        wr3=wa3[i], wi3=fsign*wa3[i+1]; 
-        ch[i + 2*l1ido] = cr3;
-        ch[i + 2*l1ido + 1] = ci3;
-
-        VCPLXMUL(cr4, ci4, LD_PS1(wr3), LD_PS1(wi3));
-        ch[i + 3*l1ido] = cr4;
-        ch[i + 3*l1ido + 1] = ci4;
-      }
+  }
+}
+
+int pffft_scratch_reserve(size_t nb_bytes) {
+  pffft_scratch_block *b;
+  size_t total = 0;
+  for (b = pffft_scratch_arena; b; b = b->next) {
+    if (b->used) return 0; // some areas are in use
+    total += b->size;
+  }
+  /* a single block, so that the arena does not get fragmented */
+  if (pffft_scratch_arena && (pffft_scratch_arena->next || total < nb_bytes)) pffft_scratch_release();
+  if (!pffft_scratch_arena && nb_bytes > 0) {
+    return pffft_scratch_add_block(0, PFFFT_ALIGN64(nb_bytes > total ? nb_bytes : total)) != 0;
+  }
+  return 1;
+}
+
+void pffft_scratch_release(void) {
+  pffft_scratch_free_blocks(pffft_scratch_arena);
+  pffft_scratch_arena = 0;
+#ifdef PFFFT_HAVE_PTHREADS
+  pthread_once(&pffft_scratch_key_once, pffft_scratch_make_key);
+  pthread_setspecific(pffft_scratch_key, 0);
+#endif
+}
+
+#undef PFFFT_SCRATCH_HEADER
+#undef PFFFT_SCRATCH_DATA
+
+#else // !PFFFT_THREAD_LOCAL
+
+static void *pffft_scratch_alloc(size_t nb_bytes) { return pffft_aligned_malloc(nb_bytes); }
+static void pffft_scratch_free(void *p) { pffft_aligned_free(p); }
+int pffft_scratch_reserve(size_t nb_bytes) { (void)nb_bytes; return 0; }
+void pffft_scratch_release(void) {}
+
+#endif // PFFFT_THREAD_LOCAL
+
+#ifdef PFFFT_RUNTIME_DISPATCH
+#  define PFFFT_SIMD_DISABLE
+#  define PFFFT_ISA_SUFFIX _scalar
+#  include "pffft_impl.h"
+#  undef PFFFT_ISA_SUFFIX
+#  undef PFFFT_SIMD_DISABLE
+
+#  if !defined(__AVX__) // otherwise the whole file is built for avx anyway
+#    pragma GCC push_options
+#    pragma GCC target("sse")
+#    define PFFFT_ISA_SUFFIX _sse
+#    include "pffft_impl.h"
+#    undef PFFFT_ISA_SUFFIX
+#    pragma GCC pop_options
+#  endif
+
+#  if !defined(__FMA__) && !defined(__AVX512F__)
+#    pragma GCC push_options
+#    pragma GCC target("avx")
+#    define PFFFT_ISA_SUFFIX _avx
+#    include "pffft_impl.h"
+#    undef PFFFT_ISA_SUFFIX
+#    pragma GCC pop_options
+#  endif
+
+#  if !defined(__AVX512F__)
+#    pragma GCC push_options
+#    pragma GCC target("avx,fma")
+#    define PFFFT_ISA_SUFFIX _fma
+#    include "pffft_impl.h"
+#    undef PFFFT_ISA_SUFFIX
+#    pragma GCC pop_options
+#  endif
+
+#  pragma GCC push_options
+#  pragma GCC target("avx512f")
+#  define PFFFT_ISA_SUFFIX _avx512
+#  include "pffft_impl.h"
+#  undef PFFFT_ISA_SUFFIX
+#  pragma GCC pop_options
+
+/* double precision versions: SSE2 (2 doubles by vector), AVX and AVX+FMA3 (4 doubles) */
+#  define PFFFT_DOUBLE
+#  define PFFFT_SIMD_DISABLE
+#  define PFFFT_ISA_SUFFIX _d_scalar
+#  include "pffft_impl.h"
+#  undef PFFFT_ISA_SUFFIX
+#  undef PFFFT_SIMD_DISABLE
+
+#  if !defined(__AVX__) && defined(__SSE2__) // always true on x86_64, pffft_simd_supported only checks for SSE1
+#    define PFFFT_ISA_SUFFIX _d_sse
+#    include "pffft_impl.h"
+#    undef PFFFT_ISA_SUFFIX
+#  endif
+
+#  if !defined(__FMA__)
+#    pragma GCC push_options
+#    pragma GCC target("avx")
+#    define PFFFT_ISA_SUFFIX _d_avx
+#    include "pffft_impl.h"
+#    undef PFFFT_ISA_SUFFIX
+#    pragma GCC pop_options
+#  endif
+
+#  pragma GCC push_options
+#  pragma GCC target("avx,fma")
+#  define PFFFT_ISA_SUFFIX _d_fma
+#  include "pffft_impl.h"
+#  undef PFFFT_ISA_SUFFIX
+#  pragma GCC pop_options
+#  undef PFFFT_DOUBLE
+
+/* the best ones first */
+static const pffft_simd_impl *pffft_simd_impls[] = {
+  &pffft_simd_table_avx512,
+#  if !defined(__AVX512F__)
+  &pffft_simd_table_fma,
+#  endif
+#  if !defined(__FMA__) && !defined(__AVX512F__)
+  &pffft_simd_table_avx,
+#  endif
+#  if !defined(__AVX__)
+  &pffft_simd_table_sse,
+#  endif
+  &pffft_simd_table_scalar,
+  0
+};
+
+static const pffftd_simd_impl *pffftd_simd_impls[] = {
+  &pffft_simd_table_d_fma,
+#  if !defined(__FMA__)
+  &pffft_simd_table_d_avx,
+#  endif
+#  if !defined(__AVX__) && defined(__SSE2__)
+  &pffft_simd_table_d_sse,
+#  endif
+  &pffft_simd_table_d_scalar,
+  0
+};
+
+static int pffft_simd_supported(pffft_simd_t simd) {
+  __builtin_cpu_init();
+  switch (simd) {
+    case PFFFT_SIMD_SSE: return __builtin_cpu_supports("sse");
+    case PFFFT_SIMD_AVX: return __builtin_cpu_supports("avx");
+    case PFFFT_SIMD_FMA: return __builtin_cpu_supports("avx") && __builtin_cpu_supports("fma");
+    case PFFFT_SIMD_AVX512: return __builtin_cpu_supports("avx512f");
+    default: return 1;
+  }
+}
+
+#else // !PFFFT_RUNTIME_DISPATCH
+
+#  define PFFFT_ISA_SUFFIX _native
+#  include "pffft_impl.h"
+#  undef PFFFT_ISA_SUFFIX
+
+#  define PFFFT_DOUBLE
+#  define PFFFT_ISA_SUFFIX _d_native
+#  include "pffft_impl.h"
+#  undef PFFFT_ISA_SUFFIX
+#  undef PFFFT_DOUBLE
+
+static const pffft_simd_impl *pffft_simd_impls[] = { &pffft_simd_table_native, 0 };
+static const pffftd_simd_impl *pffftd_simd_impls[] = { &pffft_simd_table_d_native, 0 };
+
+static int pffft_simd_supported(pffft_simd_t simd) { (void)simd; return 1; }
+
+#endif // !PFFFT_RUNTIME_DISPATCH
+
+#undef pffft_new_setup
+#undef pffft_init_setup
+#undef pffft_zreorder
+#undef pffft_zconvolve_accumulate
+#undef pffft_zconvolve_accumulate_many
+#undef pffft_power_spectrum
+#undef validate_pffft_simd
+
+static const pffft_simd_impl *pffft_simd_selected = 0; // set by pffft_simd_select, null for the default flavour
+static const pffft_simd_impl *pffft_simd_default = 0; // the best supported one (or PFFFT_SIMD), set once
+static int pffft_simd_env_forced = 0; // the default flavour comes from the PFFFT_SIMD environment variable
+
+/* called once, the setups may be created by several threads at the same time */
+static void pffft_simd_init_default(void) {
+  const char *env = getenv("PFFFT_SIMD");
+  const pffft_simd_impl *best = 0;
+  int k;
+  for (k=0; pffft_simd_impls[k]; ++k) {
+    const pffft_simd_impl *impl = pffft_simd_impls[k];
+    if (!pffft_simd_supported(impl->simd)) continue;
+    if (!best) best = impl;
+    if (env && strcmp(env, impl->name) == 0) { best = impl; pffft_simd_env_forced = 1; break; }
+  }
+  pffft_simd_default = best;
+}
+
+#ifdef PFFFT_HAVE_PTHREADS
+static pthread_once_t pffft_simd_default_once = PTHREAD_ONCE_INIT;
+#endif
+
+static const pffft_simd_impl *pffft_simd_active() {
+  if (pffft_simd_selected) return pffft_simd_selected;
+#ifdef PFFFT_HAVE_PTHREADS
+  pthread_once(&pffft_simd_default_once, pffft_simd_init_default);
+#else
+  if (!pffft_simd_default) pffft_simd_init_default();
+#endif
+  return pffft_simd_default;
+}
+
+/* whether the flavour was chosen by pffft_simd_select or PFFFT_SIMD, the
+   setups then do not fall back to the other ones (after pffft_simd_active) */
+static int pffft_simd_forced() {
+  return pffft_simd_selected || pffft_simd_env_forced;
+}
+
+int pffft_simd_select(pffft_simd_t simd) {
+  int k;
+  if (simd == PFFFT_SIMD_AUTO) {
+    pffft_simd_selected = 0;
+    return 1;
+  }
+  for (k=0; pffft_simd_impls[k]; ++k) {
+    if (pffft_simd_impls[k]->simd == simd && pffft_simd_supported(simd)) {
+      pffft_simd_selected = pffft_simd_impls[k];
+      return 1;
     }
   }
-} /* passf4 */
+  return 0;
+}
+
+/* the double precision flavour follows the single precision one: the same
+   instruction set when it exists for doubles, the best narrower one
+   otherwise (i.e. "fma" for doubles when "avx512" is used for floats).
+   This is not cached, so that there is no shared state to initialize. */
+static const pffftd_simd_impl *pffftd_simd_active() {
+  pffft_simd_t simd = pffft_simd_active()->simd;
+  int k;
+  for (k=0; pffftd_simd_impls[k+1]; ++k) {
+    const pffftd_simd_impl *impl = pffftd_simd_impls[k];
+    if (pffft_simd_supported(impl->simd) && impl->simd <= simd) break;
+  }
+  return pffftd_simd_impls[k];
+}
+
+const char *pffft_simd_arch() { return pffft_simd_active()->name; }
+
+int pffft_simd_size() { return pffft_simd_active()->simd_size; }
 
 /*
-  passf5 and passb5 has been merged here, fsign = -1 for passf5, +1 for passb5
+  Chirp-z (Bluestein) transforms, used for the sizes that none of the simd
+  flavours supports: with w[n] = exp(-i*pi*n^2/N), the dft of size N
+
+    X[k] = w[k] * sum_n (x[n]*w[n]) * conj(w[k-n])
+
+  is a circular convolution, which is computed with pffft_transform and
+  pffft_zconvolve_accumulate on a supported size M >= 2N-1. The backward
+  transforms use conj(F(conj(x))), and the real transforms go through a
+  complex one. The frequency components of these setups are always stored
+  in the canonical order (pffft_zreorder just copies them).
 */
-static NEVER_INLINE(void) passf5_ps(int ido, int l1, const v4sf *cc, v4sf *ch,
-                                    const float *wa1, const float *wa2, 
-                                    const float *wa3, const float *wa4, float fsign) {  
-  static const float tr11 = .309016994374947f;
-  const float ti11 = .951056516295154f*fsign;
-  static const float tr12 = -.809016994374947f;
-  const float ti12 = .587785252292473f*fsign;
-
-  /* Local variables */
-  int i, k;
-  v4sf ci2, ci3, ci4, ci5, di3, di4, di5, di2, cr2, cr3, cr5, cr4, ti2, ti3,
-    ti4, ti5, dr3, dr4, dr5, dr2, tr2, tr3, tr4, tr5;
-
-  float wr1, wi1, wr2, wi2, wr3, wi3, wr4, wi4;
-
-#define cc_ref(a_1,a_2) cc[(a_2-1)*ido + a_1 + 1]
-#define ch_ref(a_1,a_3) ch[(a_3-1)*l1*ido + a_1 + 1]
-
-  assert(ido > 2);
-  for (k = 0; k < l1; ++k, cc += 5*ido, ch += ido) {
-    for (i = 0; i < ido-1; i += 2) {
-      ti5 = VSUB(cc_ref(i  , 2), cc_ref(i  , 5));
-      ti2 = VADD(cc_ref(i  , 2), cc_ref(i  , 5));
-      ti4 = VSUB(cc_ref(i  , 3), cc_ref(i  , 4));
-      ti3 = VADD(cc_ref(i  , 3), cc_ref(i  , 4));
-      tr5 = VSUB(cc_ref(i-1, 2), cc_ref(i-1, 5));
-      tr2 = VADD(cc_ref(i-1, 2), cc_ref(i-1, 5));
-      tr4 = VSUB(cc_ref(i-1, 3), cc_ref(i-1, 4));
-      tr3 = VADD(cc_ref(i-1, 3), cc_ref(i-1, 4));
-      ch_ref(i-1, 1) = VADD(cc_ref(i-1, 1), VADD(tr2, tr3));
-      ch_ref(i  , 1) = VADD(cc_ref(i  , 1), VADD(ti2, ti3));
-      cr2 = VADD(cc_ref(i-1, 1), VADD(SVMUL(tr11, tr2),SVMUL(tr12, tr3)));
-      ci2 = VADD(cc_ref(i  , 1), VADD(SVMUL(tr11, ti2),SVMUL(tr12, ti3)));
-      cr3 = VADD(cc_ref(i-1, 1), VADD(SVMUL(tr12, tr2),SVMUL(tr11, tr3)));
-      ci3 = VADD(cc_ref(i  , 1), VADD(SVMUL(tr12, ti2),SVMUL(tr11, ti3)));
-      cr5 = VADD(SVMUL(ti11, tr5), SVMUL(ti12, tr4));
-      ci5 = VADD(SVMUL(ti11, ti5), SVMUL(ti12, ti4));
-      cr4 = VSUB(SVMUL(ti12, tr5), SVMUL(ti11, tr4));
-      ci4 = VSUB(SVMUL(ti12, ti5), SVMUL(ti11, ti4));
-      dr3 = VSUB(cr3, ci4);
-      dr4 = VADD(cr3, ci4);
-      di3 = VADD(ci3, cr4);
-      di4 = VSUB(ci3, cr4);
-      dr5 = VADD(cr2, ci5);
-      dr2 = VSUB(cr2, ci5);
-      di5 = VSUB(ci2, cr5);
-      di2 = VADD(ci2, cr5);
-      wr1=wa1[i], wi1=fsign*wa1[i+1], wr2=wa2[i], wi2=fsign*wa2[i+1]; 
-      wr3=wa3[i], wi3=fsign*wa3[i+1], wr4=wa4[i], wi4=fsign*wa4[i+1]; 
-      VCPLXMUL(dr2, di2, LD_PS1(wr1), LD_PS1(wi1));
-      ch_ref(i - 1, 2) = dr2;
-      ch_ref(i, 2)     = di2;
-      VCPLXMUL(dr3, di3, LD_PS1(wr2), LD_PS1(wi2));
-      ch_ref(i - 1, 3) = dr3;
-      ch_ref(i, 3)     = di3;
-      VCPLXMUL(dr4, di4, LD_PS1(wr3), LD_PS1(wi3));
-      ch_ref(i - 1, 4) = dr4;
-      ch_ref(i, 4)     = di4;
-      VCPLXMUL(dr5, di5, LD_PS1(wr4), LD_PS1(wi4));
-      ch_ref(i - 1, 5) = dr5;
-      ch_ref(i, 5)     = di5;
-    }
+
+/* smallest M >= 2N-1 of the form 16*2^a*3^b*5^c, which every flavour supports for complex transforms */
+static int pffft_chirpz_size(int N) {
+  int m;
+  for (m = (2*N - 1 + 15)/16; ; ++m) {
+    int r = m;
+    while (r % 2 == 0) r /= 2;
+    while (r % 3 == 0) r /= 3;
+    while (r % 5 == 0) r /= 5;
+    if (r == 1) return 16*m;
   }
-#undef ch_ref
-#undef cc_ref
-}
-
-static NEVER_INLINE(void) radf2_ps(int ido, int l1, const v4sf * RESTRICT cc, v4sf * RESTRICT ch, const float *wa1) {
-  static const float minus_one = -1.f;
-  int i, k, l1ido = l1*ido;
-  for (k=0; k < l1ido; k += ido) {
-    v4sf a = cc[k], b = cc[k + l1ido];
-    ch[2*k] = VADD(a, b);
-    ch[2*(k+ido)-1] = VSUB(a, b);
-  }
-  if (ido < 2) return;
-  if (ido != 2) {
-    for (k=0; k < l1ido; k += ido) {
-      for (i=2; i<ido; i+=2) {
-        v4sf tr2 = cc[i - 1 + k + l1ido], ti2 = cc[i + k + l1ido];
-        v4sf br = cc[i - 1 + k], bi = cc[i + k];
-        VCPLXMULCONJ(tr2, ti2, LD_PS1(wa1[i - 2]), LD_PS1(wa1[i - 1])); 
-        ch[i + 2*k] = VADD(bi, ti2);
-        ch[2*(k+ido) - i] = VSUB(ti2, bi);
-        ch[i - 1 + 2*k] = VADD(br, tr2);
-        ch[2*(k+ido) - i -1] = VSUB(br, tr2);
-      }
-    }
-    if (ido % 2 == 1) return;
-  }
-  for (k=0; k < l1ido; k += ido) {
-    ch[2*k + ido] = SVMUL(minus_one, cc[ido-1 + k + l1ido]);
-    ch[2*k + ido-1] = cc[k + ido-1];
-  }
-} /* radf2 */
-
-
-static NEVER_INLINE(void) radb2_ps(int ido, int l1, const v4sf *cc, v4sf *ch, const float *wa1) {
-  static const float minus_two=-2;
-  int i, k, l1ido = l1*ido;
-  v4sf a,b,c,d, tr2, ti2;
-  for (k=0; k < l1ido; k += ido) {
-    a = cc[2*k]; b = cc[2*(k+ido) - 1];
-    ch[k] = VADD(a, b);
-    ch[k + l1ido] =VSUB(a, b);
-  }
-  if (ido < 2) return;
-  if (ido != 2) {
-    for (k = 0; k < l1ido; k += ido) {
-      for (i = 2; i < ido; i += 2) {
-        a = cc[i-1 + 2*k]; b = cc[2*(k + ido) - i - 1];
-        c = cc[i+0 + 2*k]; d = cc[2*(k + ido) - i + 0];
-        ch[i-1 + k] = VADD(a, b);
-        tr2 = VSUB(a, b);
-        ch[i+0 + k] = VSUB(c, d);
-        ti2 = VADD(c, d);
-        VCPLXMUL(tr2, ti2, LD_PS1(wa1[i - 2]), LD_PS1(wa1[i - 1]));
-        ch[i-1 + k + l1ido] = tr2;
-        ch[i+0 + k + l1ido] = ti2;
-      }
+}
+
+/* (re,im) of the component k of a real transform of size N, for k <= N/2:
+   F(0) then F(N/2) (for even sizes) then the (re,im) pairs, like in the
+   canonical pffft order. For odd sizes, this is the order of fftpack:
+   F(0) followed by the (re,im) pairs. */
+static ALWAYS_INLINE(int) pffft_chirpz_real_index(int N, int k) {
+  return (N & 1) ? 2*k-1 : 2*k;
+}
+
+static void pffft_chirpz_transform(PFFFT_Setup *s, const float *input, float *output, float *work, pffft_direction_t direction, int ordered) {
+  int N = s->N, M = s->chirp_fft->N, k;
+  const float *w = s->chirp;
+  float sign = (direction == PFFFT_FORWARD ? 1.f : -1.f); // the backward transforms are conjugated forward ones
+  float *scratch, *a, *b, *c;
+  int half = (ordered == PFFFT_HALF_SPECTRUM); // X(k) in output[2k], output[2k+1] for k <= N/2
+  int on_stack = pffft_scratch_on_stack(6*M*sizeof(float));
+  VLA_ARRAY_ON_STACK(float, stack_scratch, (on_stack ? 6*M : 0) + 16);
+  (void)work;
+
+  if (on_stack) scratch = (float*)(((uintptr_t)stack_scratch + 63) & ~(uintptr_t)63);
+  else scratch = (float*)pffft_scratch_alloc(6*M*sizeof(float));
+  a = scratch; b = scratch + 2*M; c = scratch + 4*M;
+
+  /* a[n] = x[n] * w[n] */
+  if (s->transform == PFFFT_COMPLEX) {
+    for (k=0; k < N; ++k) {
+      float xr = input[2*k], xi = sign*input[2*k+1];
+      a[2*k]   = xr*w[2*k] - xi*w[2*k+1];
+      a[2*k+1] = xr*w[2*k+1] + xi*w[2*k];
     }
-    if (ido % 2 == 1) return;
-  }
-  for (k = 0; k < l1ido; k += ido) {
-    a = cc[2*k + ido-1]; b = cc[2*k + ido];
-    ch[k + ido-1] = VADD(a,a);
-    ch[k + ido-1 + l1ido] = SVMUL(minus_two, b);
-  }
-} /* radb2 */
-
-static void radf3_ps(int ido, int l1, const v4sf * RESTRICT cc, v4sf * RESTRICT ch,
-                     const float *wa1, const float *wa2) {
-  static const float taur = -0.5f;
-  static const float taui = 0.866025403784439f;
-  int i, k, ic;
-  v4sf ci2, di2, di3, cr2, dr2, dr3, ti2, ti3, tr2, tr3, wr1, wi1, wr2, wi2;
-  for (k=0; k<l1; k++) {
-    cr2 = VADD(cc[(k + l1)*ido], cc[(k + 2*l1)*ido]);
-    ch[3*k*ido] = VADD(cc[k*ido], cr2);
-    ch[(3*k+2)*ido] = SVMUL(taui, VSUB(cc[(k + l1*2)*ido], cc[(k + l1)*ido]));
-    ch[ido-1 + (3*k + 1)*ido] = VADD(cc[k*ido], SVMUL(taur, cr2));
-  }
-  if (ido == 1) return;
-  for (k=0; k<l1; k++) {
-    for (i=2; i<ido; i+=2) {
-      ic = ido - i;
-      wr1 = LD_PS1(wa1[i - 2]); wi1 = LD_PS1(wa1[i - 1]);
-      dr2 = cc[i - 1 + (k + l1)*ido]; di2 = cc[i + (k + l1)*ido];
-      VCPLXMULCONJ(dr2, di2, wr1, wi1);
-
-      wr2 = LD_PS1(wa2[i - 2]); wi2 = LD_PS1(wa2[i - 1]);
-      dr3 = cc[i - 1 + (k + l1*2)*ido]; di3 = cc[i + (k + l1*2)*ido];
-      VCPLXMULCONJ(dr3, di3, wr2, wi2);
-        
-      cr2 = VADD(dr2, dr3);
-      ci2 = VADD(di2, di3);
-      ch[i - 1 + 3*k*ido] = VADD(cc[i - 1 + k*ido], cr2);
-      ch[i + 3*k*ido] = VADD(cc[i + k*ido], ci2);
-      tr2 = VADD(cc[i - 1 + k*ido], SVMUL(taur, cr2));
-      ti2 = VADD(cc[i + k*ido], SVMUL(taur, ci2));
-      tr3 = SVMUL(taui, VSUB(di2, di3));
-      ti3 = SVMUL(taui, VSUB(dr3, dr2));
-      ch[i - 1 + (3*k + 2)*ido] = VADD(tr2, tr3);
-      ch[ic - 1 + (3*k + 1)*ido] = VSUB(tr2, tr3);
-      ch[i + (3*k + 2)*ido] = VADD(ti2, ti3);
-      ch[ic + (3*k + 1)*ido] = VSUB(ti3, ti2);
+  } else if (direction == PFFFT_FORWARD) {
+    for (k=0; k < N; ++k) {
+      a[2*k]   = input[k]*w[2*k];
+      a[2*k+1] = input[k]*w[2*k+1];
     }
-  }
-} /* radf3 */
-
-
-static void radb3_ps(int ido, int l1, const v4sf *RESTRICT cc, v4sf *RESTRICT ch,
-                     const float *wa1, const float *wa2)
-{
-  static const float taur = -0.5f;
-  static const float taui = 0.866025403784439f;
-  static const float taui_2 = 0.866025403784439f*2;
-  int i, k, ic;
-  v4sf ci2, ci3, di2, di3, cr2, cr3, dr2, dr3, ti2, tr2;
-  for (k=0; k<l1; k++) {
-    tr2 = cc[ido-1 + (3*k + 1)*ido]; tr2 = VADD(tr2,tr2);
-    cr2 = VMADD(LD_PS1(taur), tr2, cc[3*k*ido]);
-    ch[k*ido] = VADD(cc[3*k*ido], tr2);
-    ci3 = SVMUL(taui_2, cc[(3*k + 2)*ido]);
-    ch[(k + l1)*ido] = VSUB(cr2, ci3);
-    ch[(k + 2*l1)*ido] = VADD(cr2, ci3);
-  }
-  if (ido == 1) return;
-  for (k=0; k<l1; k++) {
-    for (i=2; i<ido; i+=2) {
-      ic = ido - i;
-      tr2 = VADD(cc[i - 1 + (3*k + 2)*ido], cc[ic - 1 + (3*k + 1)*ido]);
-      cr2 = VMADD(LD_PS1(taur), tr2, cc[i - 1 + 3*k*ido]);
-      ch[i - 1 + k*ido] = VADD(cc[i - 1 + 3*k*ido], tr2);
-      ti2 = VSUB(cc[i + (3*k + 2)*ido], cc[ic + (3*k + 1)*ido]);
-      ci2 = VMADD(LD_PS1(taur), ti2, cc[i + 3*k*ido]);
-      ch[i + k*ido] = VADD(cc[i + 3*k*ido], ti2);
-      cr3 = SVMUL(taui, VSUB(cc[i - 1 + (3*k + 2)*ido], cc[ic - 1 + (3*k + 1)*ido]));
-      ci3 = SVMUL(taui, VADD(cc[i + (3*k + 2)*ido], cc[ic + (3*k + 1)*ido]));
-      dr2 = VSUB(cr2, ci3);
-      dr3 = VADD(cr2, ci3);
-      di2 = VADD(ci2, cr3);
-      di3 = VSUB(ci2, cr3);
-      VCPLXMUL(dr2, di2, LD_PS1(wa1[i-2]), LD_PS1(wa1[i-1]));
-      ch[i - 1 + (k + l1)*ido] = dr2;
-      ch[i + (k + l1)*ido] = di2;
-      VCPLXMUL(dr3, di3, LD_PS1(wa2[i-2]), LD_PS1(wa2[i-1]));
-      ch[i - 1 + (k + 2*l1)*ido] = dr3;
-      ch[i + (k + 2*l1)*ido] = di3;
+  } else { // rebuild the conjugated hermitian spectrum
+    for (k=0; k < N; ++k) {
+      int j = (k <= N/2 ? k : N-k);
+      float xr, xi;
+      if (half) { xr = input[2*j]; xi = (j == 0 || 2*j == N) ? 0 : input[2*j+1]; }
+      else if (j == 0) { xr = input[0]; xi = 0; }
+      else if (2*j == N) { xr = input[1]; xi = 0; }
+      else { xr = input[pffft_chirpz_real_index(N, j)]; xi = input[pffft_chirpz_real_index(N, j)+1]; }
+      if (k <= N/2) xi = -xi;
+      a[2*k]   = xr*w[2*k] - xi*w[2*k+1];
+      a[2*k+1] = xr*w[2*k+1] + xi*w[2*k];
     }
   }
-} /* radb3 */
-
-static NEVER_INLINE(void) radf4_ps(int ido, int l1, const v4sf *RESTRICT cc, v4sf * RESTRICT ch,
-                                   const float * RESTRICT wa1, const float * RESTRICT wa2, const float * RESTRICT wa3)
-{
-  static const float minus_hsqt2 = (float)-0.7071067811865475;
-  int i, k, l1ido = l1*ido;
-  {
-    const v4sf *RESTRICT cc_ = cc, * RESTRICT cc_end = cc + l1ido; 
-    v4sf * RESTRICT ch_ = ch;
-    while (cc < cc_end) {
-      // this loop represents between 25% and 40% of total radf4_ps cost !
-      v4sf a0 = cc[0], a1 = cc[l1ido];
-      v4sf a2 = cc[2*l1ido], a3 = cc[3*l1ido];
-      v4sf tr1 = VADD(a1, a3);
-      v4sf tr2 = VADD(a0, a2);
-      ch[2*ido-1] = VSUB(a0, a2);
-      ch[2*ido  ] = VSUB(a3, a1);
-      ch[0      ] = VADD(tr1, tr2);
-      ch[4*ido-1] = VSUB(tr2, tr1);
-      cc += ido; ch += 4*ido;
+  memset(a + 2*N, 0, 2*(M-N)*sizeof(float));
+
+  /* circular convolution with conj(w) */
+  pffft_transform(s->chirp_fft, a, b, c, PFFFT_FORWARD);
+  memset(a, 0, 2*M*sizeof(float));
+  pffft_zconvolve_accumulate(s->chirp_fft, b, s->chirp_dft, a, 1.f/M);
+  pffft_transform(s->chirp_fft, a, a, c, PFFFT_BACKWARD);
+
+  /* X[k] = a[k] * w[k] */
+  if (s->transform == PFFFT_COMPLEX) {
+    for (k=0; k < N; ++k) {
+      float yr = a[2*k]*w[2*k] - a[2*k+1]*w[2*k+1];
+      float yi = a[2*k]*w[2*k+1] + a[2*k+1]*w[2*k];
+      output[2*k] = yr; output[2*k+1] = sign*yi;
     }
-    cc = cc_; ch = ch_;
-  }
-  if (ido < 2) return;
-  if (ido != 2) {
-    for (k = 0; k < l1ido; k += ido) {
-      const v4sf * RESTRICT pc = (v4sf*)(cc + 1 + k);
-      for (i=2; i<ido; i += 2, pc += 2) {
-        int ic = ido - i;
-        v4sf wr, wi, cr2, ci2, cr3, ci3, cr4, ci4;
-        v4sf tr1, ti1, tr2, ti2, tr3, ti3, tr4, ti4;
-
-        cr2 = pc[1*l1ido+0];
-        ci2 = pc[1*l1ido+1];
-        wr=LD_PS1(wa1[i - 2]);
-        wi=LD_PS1(wa1[i - 1]);
-        VCPLXMULCONJ(cr2,ci2,wr,wi);
-
-        cr3 = pc[2*l1ido+0];
-        ci3 = pc[2*l1ido+1];
-        wr = LD_PS1(wa2[i-2]); 
-        wi = LD_PS1(wa2[i-1]);
-        VCPLXMULCONJ(cr3, ci3, wr, wi);
-
-        cr4 = pc[3*l1ido];
-        ci4 = pc[3*l1ido+1];
-        wr = LD_PS1(wa3[i-2]); 
-        wi = LD_PS1(wa3[i-1]);
-        VCPLXMULCONJ(cr4, ci4, wr, wi);
-
-        /* at this point, on SSE, five of "cr2 cr3 cr4 ci2 ci3 ci4" should be loaded in registers */
-
-        tr1 = VADD(cr2,cr4);
-        tr4 = VSUB(cr4,cr2); 
-        tr2 = VADD(pc[0],cr3);
-        tr3 = VSUB(pc[0],cr3);
-        ch[i - 1 + 4*k] = VADD(tr1,tr2);
-        ch[ic - 1 + 4*k + 3*ido] = VSUB(tr2,tr1); // at this point tr1 and tr2 can be disposed
-        ti1 = VADD(ci2,ci4);
-        ti4 = VSUB(ci2,ci4);
-        ch[i - 1 + 4*k + 2*ido] = VADD(ti4,tr3);
-        ch[ic - 1 + 4*k + 1*ido] = VSUB(tr3,ti4); // dispose tr3, ti4
-        ti2 = VADD(pc[1],ci3);
-        ti3 = VSUB(pc[1],ci3);
-        ch[i + 4*k] = VADD(ti1, ti2);
-        ch[ic + 4*k + 3*ido] = VSUB(ti1, ti2);
-        ch[i + 4*k + 2*ido] = VADD(tr4, ti3);
-        ch[ic + 4*k + 1*ido] = VSUB(tr4, ti3);
-      }
+  } else if (direction == PFFFT_FORWARD) {
+    for (k=0; k <= N/2; ++k) {
+      float yr = a[2*k]*w[2*k] - a[2*k+1]*w[2*k+1];
+      float yi = a[2*k]*w[2*k+1] + a[2*k+1]*w[2*k];
+      if (half) { output[2*k] = yr; output[2*k+1] = (k == 0 || 2*k == N) ? 0 : yi; }
+      else if (k == 0) output[0] = yr;
+      else if (2*k == N) output[1] = yr;
+      else { output[pffft_chirpz_real_index(N, k)] = yr; output[pffft_chirpz_real_index(N, k)+1] = yi; }
     }
-    if (ido % 2 == 1) return;
-  }
-  for (k=0; k<l1ido; k += ido) {
-    v4sf a = cc[ido-1 + k + l1ido], b = cc[ido-1 + k + 3*l1ido];
-    v4sf c = cc[ido-1 + k], d = cc[ido-1 + k + 2*l1ido];
-    v4sf ti1 = SVMUL(minus_hsqt2, VADD(a, b));
-    v4sf tr1 = SVMUL(minus_hsqt2, VSUB(b, a));
-    ch[ido-1 + 4*k] = VADD(tr1, c);
-    ch[ido-1 + 4*k + 2*ido] = VSUB(c, tr1);
-    ch[4*k + 1*ido] = VSUB(ti1, d); 
-    ch[4*k + 3*ido] = VADD(ti1, d); 
-  }
-} /* radf4 */
-
-
-static NEVER_INLINE(void) radb4_ps(int ido, int l1, const v4sf * RESTRICT cc, v4sf * RESTRICT ch,
-                                   const float * RESTRICT wa1, const float * RESTRICT wa2, const float *RESTRICT wa3)
-{
-  static const float minus_sqrt2 = (float)-1.414213562373095;
-  static const float two = 2.f;
-  int i, k, l1ido = l1*ido;
-  v4sf ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
-  {
-    const v4sf *RESTRICT cc_ = cc, * RESTRICT ch_end = ch + l1ido; 
-    v4sf *ch_ = ch;
-    while (ch < ch_end) {
-      v4sf a = cc[0], b = cc[4*ido-1];
-      v4sf c = cc[2*ido], d = cc[2*ido-1];
-      tr3 = SVMUL(two,d);
-      tr2 = VADD(a,b);
-      tr1 = VSUB(a,b);
-      tr4 = SVMUL(two,c);
-      ch[0*l1ido] = VADD(tr2, tr3);
-      ch[2*l1ido] = VSUB(tr2, tr3);
-      ch[1*l1ido] = VSUB(tr1, tr4);
-      ch[3*l1ido] = VADD(tr1, tr4);
-      
-      cc += 4*ido; ch += ido;
-    }
-    cc = cc_; ch = ch_;
-  }
-  if (ido < 2) return;
-  if (ido != 2) {
-    for (k = 0; k < l1ido; k += ido) {
-      const v4sf * RESTRICT pc = (v4sf*)(cc - 1 + 4*k);
-      v4sf * RESTRICT ph = (v4sf*)(ch + k + 1);
-      for (i = 2; i < ido; i += 2) {
-
-        tr1 = VSUB(pc[i], pc[4*ido - i]);
-        tr2 = VADD(pc[i], pc[4*ido - i]);
-        ti4 = VSUB(pc[2*ido + i], pc[2*ido - i]);
-        tr3 = VADD(pc[2*ido + i], pc[2*ido - i]);
-        ph[0] = VADD(tr2, tr3);
-        cr3 = VSUB(tr2, tr3);
-
-        ti3 = VSUB(pc[2*ido + i + 1], pc[2*ido - i + 1]);
-        tr4 = VADD(pc[2*ido + i + 1], pc[2*ido - i + 1]);
-        cr2 = VSUB(tr1, tr4);
-        cr4 = VADD(tr1, tr4);
-
-        ti1 = VADD(pc[i + 1], pc[4*ido - i + 1]);
-        ti2 = VSUB(pc[i + 1], pc[4*ido - i + 1]);
-
-        ph[1] = VADD(ti2, ti3); ph += l1ido;
-        ci3 = VSUB(ti2, ti3);
-        ci2 = VADD(ti1, ti4);
-        ci4 = VSUB(ti1, ti4);
-        VCPLXMUL(cr2, ci2, LD_PS1(wa1[i-2]), LD_PS1(wa1[i-1]));
-        ph[0] = cr2;
-        ph[1] = ci2; ph += l1ido;
-        VCPLXMUL(cr3, ci3, LD_PS1(wa2[i-2]), LD_PS1(wa2[i-1]));
-        ph[0] = cr3;
-        ph[1] = ci3; ph += l1ido;
-        VCPLXMUL(cr4, ci4, LD_PS1(wa3[i-2]), LD_PS1(wa3[i-1]));
-        ph[0] = cr4;
-        ph[1] = ci4; ph = ph - 3*l1ido + 2;
-      }
+  } else {
+    for (k=0; k < N; ++k) {
+      output[k] = a[2*k]*w[2*k] - a[2*k+1]*w[2*k+1];
     }
-    if (ido % 2 == 1) return;
-  }
-  for (k=0; k < l1ido; k+=ido) {
-    int i0 = 4*k + ido;
-    v4sf c = cc[i0-1], d = cc[i0 + 2*ido-1];
-    v4sf a = cc[i0+0], b = cc[i0 + 2*ido+0];
-    tr1 = VSUB(c,d);
-    tr2 = VADD(c,d);
-    ti1 = VADD(b,a);
-    ti2 = VSUB(b,a);
-    ch[ido-1 + k + 0*l1ido] = VADD(tr2,tr2);
-    ch[ido-1 + k + 1*l1ido] = SVMUL(minus_sqrt2, VSUB(ti1, tr1));
-    ch[ido-1 + k + 2*l1ido] = VADD(ti2, ti2);
-    ch[ido-1 + k + 3*l1ido] = SVMUL(minus_sqrt2, VADD(ti1, tr1));
-  }
-} /* radb4 */
-
-static void radf5_ps(int ido, int l1, const v4sf * RESTRICT cc, v4sf * RESTRICT ch, 
-                     const float *wa1, const float *wa2, const float *wa3, const float *wa4)
-{
-  static const float tr11 = .309016994374947f;
-  static const float ti11 = .951056516295154f;
-  static const float tr12 = -.809016994374947f;
-  static const float ti12 = .587785252292473f;
-
-  /* System generated locals */
-  int cc_offset, ch_offset;
-
-  /* Local variables */
-  int i, k, ic;
-  v4sf ci2, di2, ci4, ci5, di3, di4, di5, ci3, cr2, cr3, dr2, dr3, dr4, dr5,
-    cr5, cr4, ti2, ti3, ti5, ti4, tr2, tr3, tr4, tr5;
-  int idp2;
-
-
-#define cc_ref(a_1,a_2,a_3) cc[((a_3)*l1 + (a_2))*ido + a_1]
-#define ch_ref(a_1,a_2,a_3) ch[((a_3)*5 + (a_2))*ido + a_1]
-
-  /* Parameter adjustments */
-  ch_offset = 1 + ido * 6;
-  ch -= ch_offset;
-  cc_offset = 1 + ido * (1 + l1);
-  cc -= cc_offset;
-
-  /* Function Body */
-  for (k = 1; k <= l1; ++k) {
-    cr2 = VADD(cc_ref(1, k, 5), cc_ref(1, k, 2));
-    ci5 = VSUB(cc_ref(1, k, 5), cc_ref(1, k, 2));
-    cr3 = VADD(cc_ref(1, k, 4), cc_ref(1, k, 3));
-    ci4 = VSUB(cc_ref(1, k, 4), cc_ref(1, k, 3));
-    ch_ref(1, 1, k) = VADD(cc_ref(1, k, 1), VADD(cr2, cr3));
-    ch_ref(ido, 2, k) = VADD(cc_ref(1, k, 1), VADD(SVMUL(tr11, cr2), SVMUL(tr12, cr3)));
-    ch_ref(1, 3, k) = VADD(SVMUL(ti11, ci5), SVMUL(ti12, ci4));
-    ch_ref(ido, 4, k) = VADD(cc_ref(1, k, 1), VADD(SVMUL(tr12, cr2), SVMUL(tr11, cr3)));
-    ch_ref(1, 5, k) = VSUB(SVMUL(ti12, ci5), SVMUL(ti11, ci4));
-    //printf("pffft: radf5, k=%d ch_ref=%f, ci4=%f\n", k, ch_ref(1, 5, k), ci4);
-  }
-  if (ido == 1) {
+  }
+
+  if (!on_stack) pffft_scratch_free(scratch);
+}
+
+static void pffft_chirpz_zreorder(PFFFT_Setup *s, const float *input, float *output, pffft_direction_t direction) {
+  (void)direction;
+  if (input != output) memcpy(output, input, (s->transform == PFFFT_REAL ? 1 : 2)*s->N*sizeof(float));
+}
+
+static void pffft_chirpz_zconvolve_accumulate(PFFFT_Setup *s, const float *a, const float *b, float *ab, float scaling) {
+  int N = s->N, k = 0, end = 2*N;
+  if (s->transform == PFFFT_REAL) {
+    /* the real components, followed by the (re,im) pairs */
+    ab[0] += a[0]*b[0]*scaling;
+    if (N & 1) k = 1;
+    else { ab[1] += a[1]*b[1]*scaling; k = 2; }
+    end = N;
+  }
+  for (; k < end; k += 2) {
+    float ar = a[k], ai = a[k+1], br = b[k], bi = b[k+1];
+    ab[k]   += (ar*br - ai*bi)*scaling;
+    ab[k+1] += (ar*bi + ai*br)*scaling;
+  }
+}
+
+/* the spectra of the chirp-z (and four-step) transforms are always in the canonical order */
+static void pffft_chirpz_power_spectrum(PFFFT_Setup *s, const float *x, float *power) {
+  int N = s->N, k;
+  if (s->transform == PFFFT_COMPLEX) {
+    for (k=0; k < N; ++k) power[k] = x[2*k]*x[2*k] + x[2*k+1]*x[2*k+1];
     return;
   }
-  idp2 = ido + 2;
-  for (k = 1; k <= l1; ++k) {
-    for (i = 3; i <= ido; i += 2) {
-      ic = idp2 - i;
-      dr2 = LD_PS1(wa1[i-3]); di2 = LD_PS1(wa1[i-2]);
-      dr3 = LD_PS1(wa2[i-3]); di3 = LD_PS1(wa2[i-2]);
-      dr4 = LD_PS1(wa3[i-3]); di4 = LD_PS1(wa3[i-2]);
-      dr5 = LD_PS1(wa4[i-3]); di5 = LD_PS1(wa4[i-2]);
-      VCPLXMULCONJ(dr2, di2, cc_ref(i-1, k, 2), cc_ref(i, k, 2));
-      VCPLXMULCONJ(dr3, di3, cc_ref(i-1, k, 3), cc_ref(i, k, 3));
-      VCPLXMULCONJ(dr4, di4, cc_ref(i-1, k, 4), cc_ref(i, k, 4));
-      VCPLXMULCONJ(dr5, di5, cc_ref(i-1, k, 5), cc_ref(i, k, 5));
-      cr2 = VADD(dr2, dr5);
-      ci5 = VSUB(dr5, dr2);
-      cr5 = VSUB(di2, di5);
-      ci2 = VADD(di2, di5);
-      cr3 = VADD(dr3, dr4);
-      ci4 = VSUB(dr4, dr3);
-      cr4 = VSUB(di3, di4);
-      ci3 = VADD(di3, di4);
-      ch_ref(i - 1, 1, k) = VADD(cc_ref(i - 1, k, 1), VADD(cr2, cr3));
-      ch_ref(i, 1, k) = VSUB(cc_ref(i, k, 1), VADD(ci2, ci3));//
-      tr2 = VADD(cc_ref(i - 1, k, 1), VADD(SVMUL(tr11, cr2), SVMUL(tr12, cr3)));
-      ti2 = VSUB(cc_ref(i, k, 1), VADD(SVMUL(tr11, ci2), SVMUL(tr12, ci3)));//
-      tr3 = VADD(cc_ref(i - 1, k, 1), VADD(SVMUL(tr12, cr2), SVMUL(tr11, cr3)));
-      ti3 = VSUB(cc_ref(i, k, 1), VADD(SVMUL(tr12, ci2), SVMUL(tr11, ci3)));//
-      tr5 = VADD(SVMUL(ti11, cr5), SVMUL(ti12, cr4));
-      ti5 = VADD(SVMUL(ti11, ci5), SVMUL(ti12, ci4));
-      tr4 = VSUB(SVMUL(ti12, cr5), SVMUL(ti11, cr4));
-      ti4 = VSUB(SVMUL(ti12, ci5), SVMUL(ti11, ci4));
-      ch_ref(i - 1, 3, k) = VSUB(tr2, tr5);
-      ch_ref(ic - 1, 2, k) = VADD(tr2, tr5);
-      ch_ref(i, 3, k) = VADD(ti2, ti5);
-      ch_ref(ic, 2, k) = VSUB(ti5, ti2);
-      ch_ref(i - 1, 5, k) = VSUB(tr3, tr4);
-      ch_ref(ic - 1, 4, k) = VADD(tr3, tr4);
-      ch_ref(i, 5, k) = VADD(ti3, ti4);
-      ch_ref(ic, 4, k) = VSUB(ti4, ti3);
+  power[0] = x[0]*x[0];
+  if (N % 2 == 0) { // X(N/2) in x[1], then X(k) in x[2k], x[2k+1]
+    power[N/2] = x[1]*x[1];
+    for (k=1; k < N/2; ++k) power[k] = x[2*k]*x[2*k] + x[2*k+1]*x[2*k+1];
+  } else { // X(k) in x[2k-1], x[2k]
+    for (k=1; k <= N/2; ++k) power[k] = x[2*k-1]*x[2*k-1] + x[2*k]*x[2*k];
+  }
+}
+
+static const pffft_simd_impl pffft_chirpz_impl = {
+  PFFFT_SIMD_AUTO, "chirp-z", 1,
+  0, 0, pffft_chirpz_transform, pffft_chirpz_zreorder, pffft_chirpz_zconvolve_accumulate, 0, 0, 0, 0, 0, 0, 0,
+  pffft_chirpz_power_spectrum
+};
+
+static PFFFT_Setup *pffft_new_kernel_setup(int N, pffft_transform_t transform);
+
+/* initializes the (zeroed) chirp-z setup 's' of size N, 'fft' being its
+   complex transform of size M, with its tables in the 2*M + 2*N floats of
+   'data', and 2*M floats of scratch in 'work' */
+static void pffft_init_chirpz_setup(PFFFT_Setup *s, PFFFT_Setup *fft, float *data, float *work,
+                                    int N, pffft_transform_t transform) {
+  int M = fft->N, n;
+  s->N = N;
+  s->transform = transform;
+  s->simd = &pffft_chirpz_impl;
+  s->chirp_fft = fft;
+  s->data = data;
+  s->chirp_dft = s->data;
+  s->chirp = s->data + 2*M;
+
+  memset(s->chirp_dft, 0, 2*M*sizeof(float));
+  for (n=0; n < N; ++n) {
+    /* n^2 is reduced modulo 2N before the conversion to keep the angles accurate */
+    double A = M_PI * (double)(((long long)n*n) % (2*N)) / N;
+    s->chirp[2*n]   = (float)cos(A);
+    s->chirp[2*n+1] = (float)-sin(A);
+    s->chirp_dft[2*n]   = (float)cos(A);
+    s->chirp_dft[2*n+1] = (float)sin(A);
+    if (n) {
+      s->chirp_dft[2*(M-n)]   = (float)cos(A);
+      s->chirp_dft[2*(M-n)+1] = (float)sin(A);
     }
   }
-#undef cc_ref
-#undef ch_ref
-} /* radf5 */
-
-static void radb5_ps(int ido, int l1, const v4sf *RESTRICT cc, v4sf *RESTRICT ch, 
-                  const float *wa1, const float *wa2, const float *wa3, const float *wa4)
-{
-  static const float tr11 = .309016994374947f;
-  static const float ti11 = .951056516295154f;
-  static const float tr12 = -.809016994374947f;
-  static const float ti12 = .587785252292473f;
-
-  int cc_offset, ch_offset;
-
-  /* Local variables */
-  int i, k, ic;
-  v4sf ci2, ci3, ci4, ci5, di3, di4, di5, di2, cr2, cr3, cr5, cr4, ti2, ti3,
-    ti4, ti5, dr3, dr4, dr5, dr2, tr2, tr3, tr4, tr5;
-  int idp2;
-
-#define cc_ref(a_1,a_2,a_3) cc[((a_3)*5 + (a_2))*ido + a_1]
-#define ch_ref(a_1,a_2,a_3) ch[((a_3)*l1 + (a_2))*ido + a_1]
-
-  /* Parameter adjustments */
-  ch_offset = 1 + ido * (1 + l1);
-  ch -= ch_offset;
-  cc_offset = 1 + ido * 6;
-  cc -= cc_offset;
-
-  /* Function Body */
-  for (k = 1; k <= l1; ++k) {
-    ti5 = VADD(cc_ref(1, 3, k), cc_ref(1, 3, k));
-    ti4 = VADD(cc_ref(1, 5, k), cc_ref(1, 5, k));
-    tr2 = VADD(cc_ref(ido, 2, k), cc_ref(ido, 2, k));
-    tr3 = VADD(cc_ref(ido, 4, k), cc_ref(ido, 4, k));
-    ch_ref(1, k, 1) = VADD(cc_ref(1, 1, k), VADD(tr2, tr3));
-    cr2 = VADD(cc_ref(1, 1, k), VADD(SVMUL(tr11, tr2), SVMUL(tr12, tr3)));
-    cr3 = VADD(cc_ref(1, 1, k), VADD(SVMUL(tr12, tr2), SVMUL(tr11, tr3)));
-    ci5 = VADD(SVMUL(ti11, ti5), SVMUL(ti12, ti4));
-    ci4 = VSUB(SVMUL(ti12, ti5), SVMUL(ti11, ti4));
-    ch_ref(1, k, 2) = VSUB(cr2, ci5);
-    ch_ref(1, k, 3) = VSUB(cr3, ci4);
-    ch_ref(1, k, 4) = VADD(cr3, ci4);
-    ch_ref(1, k, 5) = VADD(cr2, ci5);
-  }
-  if (ido == 1) {
-    return;
+  pffft_transform(fft, s->chirp_dft, s->chirp_dft, work, PFFFT_FORWARD);
+}
+
+static PFFFT_Setup *pffft_new_chirpz_setup(int N, pffft_transform_t transform) {
+  int M = pffft_chirpz_size(N);
+  PFFFT_Setup *fft = pffft_new_kernel_setup(M, PFFFT_COMPLEX), *s;
+  float *work;
+  if (!fft) return 0;
+  s = (PFFFT_Setup*)calloc(1, sizeof(PFFFT_Setup));
+  work = (float*)pffft_aligned_malloc(2*M*sizeof(float));
+  pffft_init_chirpz_setup(s, fft, (float*)pffft_aligned_malloc((2*M + 2*N)*sizeof(float)), work, N, transform);
+  pffft_aligned_free(work);
+  return s;
+}
+
+/* whether the flavour is fast for the transforms of size N (which it
+   supports): the finalize / preprocess steps of the flavours wider than 4
+   work on SIMD_SZ x SIMD_SZ blocks, and they lose to the narrower
+   flavours below one full block (N < 2*SIMD_SZ*SIMD_SZ for real
+   transforms) or when the last block is partial */
+static int pffft_simd_fits(const pffft_simd_impl *impl, int N, pffft_transform_t transform) {
+  int Ncvec = (transform == PFFFT_REAL ? N/2 : N)/impl->simd_size;
+  return impl->simd_size <= 4 || Ncvec % impl->simd_size == 0;
+}
+
+/* the simd flavour of the transforms of size N (null when none of them
+   supports N, so that the chirp-z transform is needed), and the number of
+   floats of its tables */
+static const pffft_simd_impl *pffft_kernel_impl(int N, pffft_transform_t transform, int *data_size) {
+  const pffft_simd_impl *active = pffft_simd_active(), *impl;
+  int k, pass;
+  if (pffft_simd_forced()) {
+    *data_size = active->init_setup(0, 0, N, transform);
+    return (*data_size ? active : 0);
   }
-  idp2 = ido + 2;
-  for (k = 1; k <= l1; ++k) {
-    for (i = 3; i <= ido; i += 2) {
-      ic = idp2 - i;
-      ti5 = VADD(cc_ref(i  , 3, k), cc_ref(ic  , 2, k));
-      ti2 = VSUB(cc_ref(i  , 3, k), cc_ref(ic  , 2, k));
-      ti4 = VADD(cc_ref(i  , 5, k), cc_ref(ic  , 4, k));
-      ti3 = VSUB(cc_ref(i  , 5, k), cc_ref(ic  , 4, k));
-      tr5 = VSUB(cc_ref(i-1, 3, k), cc_ref(ic-1, 2, k));
-      tr2 = VADD(cc_ref(i-1, 3, k), cc_ref(ic-1, 2, k));
-      tr4 = VSUB(cc_ref(i-1, 5, k), cc_ref(ic-1, 4, k));
-      tr3 = VADD(cc_ref(i-1, 5, k), cc_ref(ic-1, 4, k));
-      ch_ref(i - 1, k, 1) = VADD(cc_ref(i-1, 1, k), VADD(tr2, tr3));
-      ch_ref(i, k, 1) = VADD(cc_ref(i, 1, k), VADD(ti2, ti3));
-      cr2 = VADD(cc_ref(i-1, 1, k), VADD(SVMUL(tr11, tr2), SVMUL(tr12, tr3)));
-      ci2 = VADD(cc_ref(i  , 1, k), VADD(SVMUL(tr11, ti2), SVMUL(tr12, ti3)));
-      cr3 = VADD(cc_ref(i-1, 1, k), VADD(SVMUL(tr12, tr2), SVMUL(tr11, tr3)));
-      ci3 = VADD(cc_ref(i  , 1, k), VADD(SVMUL(tr12, ti2), SVMUL(tr11, ti3)));
-      cr5 = VADD(SVMUL(ti11, tr5), SVMUL(ti12, tr4));
-      ci5 = VADD(SVMUL(ti11, ti5), SVMUL(ti12, ti4));
-      cr4 = VSUB(SVMUL(ti12, tr5), SVMUL(ti11, tr4));
-      ci4 = VSUB(SVMUL(ti12, ti5), SVMUL(ti11, ti4));
-      dr3 = VSUB(cr3, ci4);
-      dr4 = VADD(cr3, ci4);
-      di3 = VADD(ci3, cr4);
-      di4 = VSUB(ci3, cr4);
-      dr5 = VADD(cr2, ci5);
-      dr2 = VSUB(cr2, ci5);
-      di5 = VSUB(ci2, cr5);
-      di2 = VADD(ci2, cr5);
-      VCPLXMUL(dr2, di2, LD_PS1(wa1[i-3]), LD_PS1(wa1[i-2]));
-      VCPLXMUL(dr3, di3, LD_PS1(wa2[i-3]), LD_PS1(wa2[i-2]));
-      VCPLXMUL(dr4, di4, LD_PS1(wa3[i-3]), LD_PS1(wa3[i-2]));
-      VCPLXMUL(dr5, di5, LD_PS1(wa4[i-3]), LD_PS1(wa4[i-2]));
-
-      ch_ref(i-1, k, 2) = dr2; ch_ref(i, k, 2) = di2;
-      ch_ref(i-1, k, 3) = dr3; ch_ref(i, k, 3) = di3;
-      ch_ref(i-1, k, 4) = dr4; ch_ref(i, k, 4) = di4;
-      ch_ref(i-1, k, 5) = dr5; ch_ref(i, k, 5) = di5;
+  /* otherwise, the widest flavour (not wider than the active one) that
+     fits N, then the widest one that supports it (i.e. sizes that are not
+     a multiple of 32 for real transforms with SSE) */
+  for (pass=0; pass < 2; ++pass) {
+    for (k=0; pffft_simd_impls[k]; ++k) {
+      impl = pffft_simd_impls[k];
+      if (impl->simd_size > active->simd_size || !pffft_simd_supported(impl->simd)) continue;
+      if (pass == 0 && !pffft_simd_fits(impl, N, transform)) continue;
+      *data_size = impl->init_setup(0, 0, N, transform);
+      if (*data_size) return impl;
     }
   }
-#undef cc_ref
-#undef ch_ref
-} /* radb5 */
-
-static NEVER_INLINE(v4sf *) rfftf1_ps(int n, const v4sf *input_readonly, v4sf *work1, v4sf *work2, 
-                                      const float *wa, const int *ifac) {  
-  v4sf *in  = (v4sf*)input_readonly;
-  v4sf *out = (in == work2 ? work1 : work2);
-  int nf = ifac[1], k1;
-  int l2 = n;
-  int iw = n-1;
-  assert(in != out && work1 != work2);
-  for (k1 = 1; k1 <= nf; ++k1) {
-    int kh = nf - k1;
-    int ip = ifac[kh + 2];
-    int l1 = l2 / ip;
-    int ido = n / l2;
-    iw -= (ip - 1)*ido;
-    switch (ip) {
-      case 5: {
-        int ix2 = iw + ido;
-        int ix3 = ix2 + ido;
-        int ix4 = ix3 + ido;
-        radf5_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], &wa[ix4]);
-      } break;
-      case 4: {
-        int ix2 = iw + ido;
-        int ix3 = ix2 + ido;
-        radf4_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3]);
-      } break;
-      case 3: {
-        int ix2 = iw + ido;
-        radf3_ps(ido, l1, in, out, &wa[iw], &wa[ix2]);
-      } break;
-      case 2:
-        radf2_ps(ido, l1, in, out, &wa[iw]);
-        break;
-      default:
-        assert(0);
-        break;
+  return 0;
+}
+
+/* the setup of the transforms, without the tables of the transposed batches */
+static PFFFT_Setup *pffft_new_kernel_setup(int N, pffft_transform_t transform) {
+  int data_size;
+  const pffft_simd_impl *impl = pffft_kernel_impl(N, transform, &data_size);
+  PFFFT_Setup *s = 0;
+  if (impl) {
+    s = impl->new_setup(N, transform);
+    s->simd = impl;
+  } else if (N > 0) {
+    /* none of the flavours supports N, use the chirp-z transform */
+    s = pffft_new_chirpz_setup(N, transform);
+  }
+  return s;
+}
+
+/* the tables of the transposed batches, in the N floats (2*N for complex
+   transforms) of 'lane_twiddle', returns 0 when N is not supported */
+static int pffft_init_lanes(PFFFT_Setup *s, float *lane_twiddle) {
+  /* the transposed batches use the widest flavour, whatever N */
+  s->lane_simd = pffft_simd_active();
+  s->lane_twiddle = lane_twiddle;
+  if (!s->lane_simd->lane_setup(s->N, s->transform, s->lane_twiddle, s->lane_ifac)) {
+    s->lane_twiddle = 0;
+  }
+  return (s->lane_twiddle != 0);
+}
+
+/* the setups of pffft_new_setup carry the tables of the transposed
+   batches from the start, so that the transforms never modify a setup
+   (which may be shared by several threads, see pffft_get_setup) */
+PFFFT_Setup *pffft_new_setup(int N, pffft_transform_t transform) {
+  PFFFT_Setup *s = pffft_new_kernel_setup(N, transform);
+  if (s) {
+    float *lane_twiddle = (float*)pffft_aligned_malloc((transform == PFFFT_REAL ? N : 2*N)*sizeof(float));
+    if (!lane_twiddle || !pffft_init_lanes(s, lane_twiddle)) pffft_aligned_free(lane_twiddle);
+  }
+  return s;
+}
+
+/*
+  the setups of pffft_init_setup are stored in a single block: the struct,
+  the struct of the inner complex transform (chirp-z setups only), the
+  tables, the ones of the inner transform, the tables of the transposed
+  batches, and the scratch area used to compute the tables of the chirp-z
+  setups. Each part is 64-byte aligned, and the offsets are relative to
+  the 64-byte aligned start of the buffer.
+*/
+typedef struct {
+  const pffft_simd_impl *impl; // flavour of the kernel setup, or of the inner transform of the chirp-z setups
+  int M; // size of the inner transform of the chirp-z setups, 0 for the other ones
+  int data_size, fft_data_size; // in floats
+  size_t fft, data, fft_data, lane_twiddle, work, size; // in bytes
+} pffft_setup_layout;
+
+static int pffft_get_setup_layout(int N, pffft_transform_t transform, pffft_setup_layout *l) {
+  size_t pos = PFFFT_ALIGN64(sizeof(PFFFT_Setup));
+  memset(l, 0, sizeof(*l));
+  if (N <= 0) return 0;
+  l->impl = pffft_kernel_impl(N, transform, &l->data_size);
+  if (!l->impl) {
+    l->M = pffft_chirpz_size(N);
+    l->impl = pffft_kernel_impl(l->M, PFFFT_COMPLEX, &l->fft_data_size);
+    if (!l->impl) return 0;
+    l->data_size = 2*l->M + 2*N;
+    l->fft = pos; pos += PFFFT_ALIGN64(sizeof(PFFFT_Setup));
+  }
+  l->data = pos; pos += PFFFT_ALIGN64(l->data_size*sizeof(float));
+  if (l->M) { l->fft_data = pos; pos += PFFFT_ALIGN64(l->fft_data_size*sizeof(float)); }
+  l->lane_twiddle = pos; pos += PFFFT_ALIGN64((transform == PFFFT_REAL ? N : 2*N)*sizeof(float));
+  if (l->M) { l->work = pos; pos += PFFFT_ALIGN64(2*l->M*sizeof(float)); }
+  l->size = pos;
+  return 1;
+}
+
+size_t pffft_setup_size(int N, pffft_transform_t transform) {
+  pffft_setup_layout l;
+  if (!pffft_get_setup_layout(N, transform, &l)) return 0;
+  return l.size + 63; // the buffer does not have to be aligned
+}
+
+PFFFT_Setup *pffft_init_setup(void *buffer, int N, pffft_transform_t transform) {
+  char *base = (char*)(((uintptr_t)buffer + 63) & ~(uintptr_t)63);
+  PFFFT_Setup *s = (PFFFT_Setup*)base;
+  pffft_setup_layout l;
+  if (!buffer || !pffft_get_setup_layout(N, transform, &l)) return 0;
+  memset(s, 0, sizeof(PFFFT_Setup));
+  if (l.M) {
+    PFFFT_Setup *fft = (PFFFT_Setup*)(base + l.fft);
+    memset(fft, 0, sizeof(PFFFT_Setup));
+    l.impl->init_setup(fft, (float*)(base + l.fft_data), l.M, PFFFT_COMPLEX);
+    fft->simd = l.impl;
+    fft->user_memory = 1;
+    pffft_init_chirpz_setup(s, fft, (float*)(base + l.data), (float*)(base + l.work), N, transform);
+  } else {
+    l.impl->init_setup(s, (float*)(base + l.data), N, transform);
+    s->simd = l.impl;
+  }
+  s->user_memory = 1;
+  pffft_init_lanes(s, (float*)(base + l.lane_twiddle));
+  return s;
+}
+
+PFFFT_Setup *pffft_new_setup_plan(int N, pffft_transform_t transform, pffft_plan_t plan) {
+  PFFFT_Setup *s = pffft_new_setup(N, transform), *fft = s;
+  if (s && plan == PFFFT_MEASURE) {
+    /* for the chirp-z transforms, it is their inner fft that is measured */
+    if (s->chirp_fft) fft = s->chirp_fft;
+    if (fft->simd->measure) fft->simd->measure(fft);
+  }
+  return s;
+}
+
+void pffft_transform(PFFFT_Setup *setup, const float *input, float *output, float *work, pffft_direction_t direction) {
+  setup->simd->transform(setup, input, output, work, direction, 0);
+}
+
+void pffft_transform_ordered(PFFFT_Setup *setup, const float *input, float *output, float *work, pffft_direction_t direction) {
+  setup->simd->transform(setup, input, output, work, direction, 1);
+}
+
+void pffft_zreorder(PFFFT_Setup *setup, const float *input, float *output, pffft_direction_t direction) {
+  setup->simd->zreorder(setup, input, output, direction);
+}
+
+void pffft_transform_halfspectrum(PFFFT_Setup *setup, const float *input, float *output, float *work, pffft_direction_t direction) {
+  setup->simd->transform(setup, input, output, work, direction, PFFFT_HALF_SPECTRUM);
+}
+
+void pffft_transform_batch(PFFFT_Setup *setup, int howmany, const float *input, int in_stride,
+                           float *output, int out_stride, float *work, pffft_direction_t direction, pffft_batch_t layout) {
+  int N = setup->N, b, k;
+  if (layout != PFFFT_BATCH_TRANSPOSED) {
+    for (b=0; b < howmany; ++b) {
+      setup->simd->transform(setup, input + (size_t)b*in_stride, output + (size_t)b*out_stride, work,
+                             direction, layout == PFFFT_BATCH_ORDERED);
     }
-    l2 = l1;
-    if (out == work2) {
-      out = work1; in = work2;
-    } else {
-      out = work2; in = work1;
+  } else if (setup->lane_twiddle) {
+    setup->lane_simd->transform_lanes(N, setup->transform, setup->lane_twiddle, setup->lane_ifac,
+                                      howmany, input, in_stride, output, out_stride, direction);
+  } else {
+    /* lengths with large prime factors: gather each signal, and use the
+       chirp-z transform ('work' is not used, as documented for this layout) */
+    int cplx = (setup->transform == PFFFT_COMPLEX), n = (cplx ? 2*N : N);
+    float *buf = (float*)pffft_scratch_alloc(n*sizeof(float));
+    if (!buf) return; // out of memory, the output is left as is
+    for (b=0; b < howmany; ++b) {
+      for (k=0; k < N; ++k) {
+        if (cplx) {
+          buf[2*k] = input[(size_t)k*in_stride + 2*b]; buf[2*k+1] = input[(size_t)k*in_stride + 2*b+1];
+        } else {
+          buf[k] = input[(size_t)k*in_stride + b];
+        }
+      }
+      setup->simd->transform(setup, buf, buf, 0, direction, 1);
+      for (k=0; k < N; ++k) {
+        if (cplx) {
+          output[(size_t)k*out_stride + 2*b] = buf[2*k]; output[(size_t)k*out_stride + 2*b+1] = buf[2*k+1];
+        } else {
+          output[(size_t)k*out_stride + b] = buf[k];
+        }
+      }
     }
+    pffft_scratch_free(buf);
   }
-  return in; /* this is in fact the output .. */
-} /* rfftf1 */
-
-static NEVER_INLINE(v4sf *) rfftb1_ps(int n, const v4sf *input_readonly, v4sf *work1, v4sf *work2, 
-                                      const float *wa, const int *ifac) {  
-  v4sf *in  = (v4sf*)input_readonly;
-  v4sf *out = (in == work2 ? work1 : work2);
-  int nf = ifac[1], k1;
-  int l1 = 1;
-  int iw = 0;
-  assert(in != out);
-  for (k1=1; k1<=nf; k1++) {
-    int ip = ifac[k1 + 1];
-    int l2 = ip*l1;
-    int ido = n / l2;
-    switch (ip) {
-      case 5: {
-        int ix2 = iw + ido;
-        int ix3 = ix2 + ido;
-        int ix4 = ix3 + ido;
-        radb5_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], &wa[ix4]);
-      } break;
-      case 4: {
-        int ix2 = iw + ido;
-        int ix3 = ix2 + ido;
-        radb4_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3]);
-      } break;
-      case 3: {
-        int ix2 = iw + ido;
-        radb3_ps(ido, l1, in, out, &wa[iw], &wa[ix2]);
-      } break;
-      case 2:
-        radb2_ps(ido, l1, in, out, &wa[iw]);
-        break;
-      default:
-        assert(0);
-        break;
-    }
-    l1 = l2;
-    iw += (ip - 1)*ido;
+}
 
-    if (out == work2) {
-      out = work1; in = work2;
-    } else {
-      out = work2; in = work1;
-    }
+void pffft_zconvolve_accumulate(PFFFT_Setup *setup, const float *dft_a, const float *dft_b, float *dft_ab, float scaling) {
+  setup->simd->zconvolve_accumulate(setup, dft_a, dft_b, dft_ab, scaling);
+}
+
+void pffft_power_spectrum(PFFFT_Setup *setup, const float *input, float *power, float *work) {
+  int from_arena = (work == 0);
+  if (from_arena) work = (float*)pffft_scratch_alloc((setup->transform == PFFFT_REAL ? 1 : 2)*(size_t)setup->N*sizeof(float));
+  setup->simd->transform(setup, input, work, 0, PFFFT_FORWARD, 0);
+  setup->simd->power_spectrum(setup, work, power);
+  if (from_arena) pffft_scratch_free(work);
+}
+
+void pffft_zconvolve_accumulate_many(PFFFT_Setup *setup, int K, const float *const *dft_a, const float *const *dft_b,
+                                     float *dft_ab, float scaling) {
+  int k;
+  if (setup->simd->zconvolve_accumulate_many) {
+    setup->simd->zconvolve_accumulate_many(setup, K, dft_a, dft_b, dft_ab, scaling);
+  } else { // chirp-z and four-step setups
+    for (k=0; k < K; ++k) setup->simd->zconvolve_accumulate(setup, dft_a[k], dft_b[k], dft_ab, scaling);
   }
-  return in; /* this is in fact the output .. */
-}
-
-static int decompose(int n, int *ifac, const int *ntryh) {
-  int nl = n, nf = 0, i, j = 0;
-  for (j=0; ntryh[j]; ++j) {
-    int ntry = ntryh[j];
-    while (nl != 1) {
-      int nq = nl / ntry;
-      int nr = nl - ntry * nq;
-      if (nr == 0) {
-        ifac[2+nf++] = ntry;
-        nl = nq;
-        if (ntry == 2 && nf != 1) {
-          for (i = 2; i <= nf; ++i) {
-            int ib = nf - i + 2;
-            ifac[ib + 1] = ifac[ib];
-          }
-          ifac[2] = 2;
-        }
-      } else break;
+}
+
+/*
+  Four-step transforms, for the large sizes that do not fit in the caches:
+  the complex transform of size M = N1*N2 (M = N/2 for real transforms) is
+  computed with
+
+    - N1 transforms of size N2 on the columns of the input, seen as a
+      N2 x N1 matrix (x[n1 + N1*n2]). They are gathered by blocks of
+      PFFFT_FOURSTEP_BLOCK columns, and the results are multiplied by the
+      twiddles exp(-2*i*pi*n1*k2/M) while being scattered to 'work'.
+    - N2 transforms of size N1 on the rows of 'work', which are written
+      transposed to the output, by blocks of rows.
+
+  Each step is split in 'nthreads' tasks given to the parallel_for of the
+  setup. The real transforms are complex ones on the (even, odd) pairs of
+  samples, followed (or preceded, for the backward ones) by the usual split
+  step. As for the chirp-z transforms, the frequency components are always
+  stored in the canonical order.
+*/
+
+/* nb of columns / rows gathered together: the transforms of size N1 and N2 have to be multiples of
+   PFFFT_FOURSTEP_BLOCK, the larger PFFFT_FOURSTEP_WIDE_BLOCK being used when they allow it */
+#define PFFFT_FOURSTEP_BLOCK 16
+#define PFFFT_FOURSTEP_WIDE_BLOCK 64
+#define PFFFT_FOURSTEP_BLOCK_SIZE(n) ((n) % PFFFT_FOURSTEP_WIDE_BLOCK == 0 ? PFFFT_FOURSTEP_WIDE_BLOCK : PFFFT_FOURSTEP_BLOCK)
+/* padding (in floats) of the rows of the blocks, which avoids the cache conflicts of power of two strides */
+#define PFFFT_FOURSTEP_PAD 16
+
+typedef struct pffft_fourstep_job {
+  PFFFT_Setup *s;
+  const float *input;
+  float *output, *work;
+  pffft_direction_t direction;
+  int half; // pffft_transform_halfspectrum: F(M) at the end of the spectrum
+} pffft_fourstep_job;
+
+#ifdef PFFFT_HAVE_PTHREADS
+/* the threads of the default parallel_for: they are started on the first
+   transform that needs them, and then wait for the next loop (their
+   scratch arenas being kept from one transform to the next) until the
+   process exits. There are at most ncpus-1 of them. A loop is shared by
+   the workers and the calling thread, each one taking the next task
+   until there is none left */
+static struct {
+  pthread_mutex_t busy; // held by the thread whose loop runs in the pool
+  pthread_mutex_t mutex;
+  pthread_cond_t wake, done;
+  int nworkers, max_workers, generation; // max_workers: the number of online cpus - 1, -1 until it is known
+  void (*task)(void *arg, int index);
+  void *arg;
+  int count, next, pending;
+} pffft_pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                 0, -1, 0, 0, 0, 0, 0, 0 };
+
+/* runs the tasks of the current loop, with pffft_pool.mutex held (it is released while a task runs) */
+static void pffft_pool_run_tasks(void) {
+  while (pffft_pool.next < pffft_pool.count) {
+    int index = pffft_pool.next++;
+    pthread_mutex_unlock(&pffft_pool.mutex);
+    pffft_pool.task(pffft_pool.arg, index);
+    pthread_mutex_lock(&pffft_pool.mutex);
+    if (--pffft_pool.pending == 0) pthread_cond_signal(&pffft_pool.done);
+  }
+}
+
+static void *pffft_pool_worker(void *p) {
+  int generation;
+  pthread_mutex_lock(&pffft_pool.mutex);
+  for (;;) {
+    pffft_pool_run_tasks(); // a new worker joins the loop that started it
+    generation = pffft_pool.generation;
+    while (pffft_pool.generation == generation) pthread_cond_wait(&pffft_pool.wake, &pffft_pool.mutex);
+  }
+  (void)p;
+  return 0;
+}
+#endif
+
+/* the default parallel_for: the tasks run in a pool of threads kept by
+   pffft (count-1 of them, but no more than the number of cpus minus one,
+   the calling thread taking its share of the tasks), or all of them in
+   the calling thread when there is only one, or when the pool is busy
+   with the loop of another thread */
+static void pffft_default_parallel_for(void *pool, int count, void (*task)(void *arg, int index), void *arg) {
+  int k = 0;
+#ifdef PFFFT_HAVE_PTHREADS
+  if (count > 1 && pthread_mutex_trylock(&pffft_pool.busy) == 0) {
+    pthread_mutex_lock(&pffft_pool.mutex);
+    if (pffft_pool.max_workers < 0) {
+      long ncpus = 1;
+#if defined(_SC_NPROCESSORS_ONLN)
+      ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+      pffft_pool.max_workers = (ncpus > 1 ? (int)ncpus - 1 : 0);
+    }
+    while (pffft_pool.nworkers < count-1 && pffft_pool.nworkers < pffft_pool.max_workers) {
+      pthread_t thread;
+      if (pthread_create(&thread, 0, pffft_pool_worker, 0) != 0) break; // out of threads, run with the ones there are
+      pthread_detach(thread);
+      ++pffft_pool.nworkers;
     }
+    pffft_pool.task = task; pffft_pool.arg = arg;
+    pffft_pool.count = pffft_pool.pending = count; pffft_pool.next = 0;
+    ++pffft_pool.generation;
+    pthread_cond_broadcast(&pffft_pool.wake);
+    pffft_pool_run_tasks();
+    while (pffft_pool.pending) pthread_cond_wait(&pffft_pool.done, &pffft_pool.mutex);
+    pthread_mutex_unlock(&pffft_pool.mutex);
+    pthread_mutex_unlock(&pffft_pool.busy);
+    return;
   }
-  ifac[0] = n;
-  ifac[1] = nf;  
-  return nf;
-}
-
-
-
-static void rffti1_ps(int n, float *wa, int *ifac)
-{
-  static const int ntryh[] = { 4,2,3,5,0 };
-  int k1, j, ii;
-
-  int nf = decompose(n,ifac,ntryh);
-  float argh = (2*(float)M_PI) / n;
-  int is = 0;
-  int nfm1 = nf - 1;
-  int l1 = 1;
-  for (k1 = 1; k1 <= nfm1; k1++) {
-    int ip = ifac[k1 + 1];
-    int ld = 0;
-    int l2 = l1*ip;
-    int ido = n / l2;
-    int ipm = ip - 1;
-    for (j = 1; j <= ipm; ++j) {
-      float argld;
-      int i = is, fi=0;
-      ld += l1;
-      argld = ld*argh;
-      for (ii = 3; ii <= ido; ii += 2) {
-        i += 2;
-        fi += 1;
-        wa[i - 2] = cosf(fi*argld);
-        wa[i - 1] = sinf(fi*argld);
+#endif
+  for (k=0; k < count; ++k) task(arg, k);
+  (void)pool;
+}
+
+/* [*begin, *end) is the part of the task 'index' when 'count' items are split in 'ntasks' */
+static void pffft_task_range(int count, int ntasks, int index, int *begin, int *end) {
+  *begin = (int)((long long)count*index/ntasks);
+  *end = (int)((long long)count*(index+1)/ntasks);
+}
+
+static void pffft_fourstep_columns(void *arg, int index) {
+  pffft_fourstep_job *job = (pffft_fourstep_job*)arg;
+  PFFFT_Setup *s = job->s;
+  int N1 = s->rows_fft->N, N2 = s->cols_fft->N, B = PFFFT_FOURSTEP_BLOCK_SIZE(N1), ld = 2*N2 + PFFFT_FOURSTEP_PAD;
+  float sign = (job->direction == PFFFT_FORWARD ? 1.f : -1.f);
+  float *buf, *tmp;
+  int begin, end, c, b, k;
+
+  pffft_task_range(N1/B, s->nthreads, index, &begin, &end);
+  if (begin == end) return;
+  buf = (float*)pffft_scratch_alloc((B*ld + 2*N2)*sizeof(float));
+  tmp = buf + B*ld;
+  for (c = begin*B; c < end*B; c += B) {
+    for (k=0; k < N2; ++k) {
+      const float *in = job->input + 2*((size_t)k*N1 + c);
+      for (b=0; b < B; ++b) {
+        buf[b*ld + 2*k] = in[2*b]; buf[b*ld + 2*k+1] = in[2*b+1];
       }
-      is += ido;
     }
-    l1 = l2;
-  }
-} /* rffti1 */
-
-void cffti1_ps(int n, float *wa, int *ifac)
-{
-  static const int ntryh[] = { 5,3,4,2,0 };
-  int k1, j, ii;
-
-  int nf = decompose(n,ifac,ntryh);
-  float argh = (2*(float)M_PI) / n;
-  int i = 1;
-  int l1 = 1;
-  for (k1=1; k1<=nf; k1++) {
-    int ip = ifac[k1+1];
-    int ld = 0;
-    int l2 = l1*ip;
-    int ido = n / l2;
-    int idot = ido + ido + 2;
-    int ipm = ip - 1;
-    for (j=1; j<=ipm; j++) {
-      float argld;
-      int i1 = i, fi = 0;
-      wa[i-1] = 1;
-      wa[i] = 0;
-      ld += l1;
-      argld = ld*argh;
-      for (ii = 4; ii <= idot; ii += 2) {
-        i += 2;
-        fi += 1;
-        wa[i-1] = cosf(fi*argld);
-        wa[i] = sinf(fi*argld);
-      }
-      if (ip > 5) {
-        wa[i1-1] = wa[i-1];
-        wa[i1] = wa[i];
+    for (b=0; b < B; ++b) {
+      pffft_transform_ordered(s->cols_fft, buf + b*ld, buf + b*ld, tmp, job->direction);
+    }
+    for (k=0; k < N2; ++k) {
+      const float *w = s->step_twiddle + 2*((size_t)k*N1 + c);
+      float *out = job->work + 2*((size_t)k*N1 + c);
+      for (b=0; b < B; ++b) {
+        float xr = buf[b*ld + 2*k], xi = buf[b*ld + 2*k+1], wr = w[2*b], wi = sign*w[2*b+1];
+        out[2*b] = xr*wr - xi*wi; out[2*b+1] = xr*wi + xi*wr;
       }
     }
-    l1 = l2;
-  }
-} /* cffti1 */
-
-
-v4sf *cfftf1_ps(int n, const v4sf *input_readonly, v4sf *work1, v4sf *work2, const float *wa, const int *ifac, int isign) {
-  v4sf *in  = (v4sf*)input_readonly;
-  v4sf *out = (in == work2 ? work1 : work2); 
-  int nf = ifac[1], k1;
-  int l1 = 1;
-  int iw = 0;
-  assert(in != out && work1 != work2);
-  for (k1=2; k1<=nf+1; k1++) {
-    int ip = ifac[k1];
-    int l2 = ip*l1;
-    int ido = n / l2;
-    int idot = ido + ido;
-    switch (ip) {
-      case 5: {
-        int ix2 = iw + idot;
-        int ix3 = ix2 + idot;
-        int ix4 = ix3 + idot;
-        passf5_ps(idot, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], &wa[ix4], isign);
-      } break;
-      case 4: {
-        int ix2 = iw + idot;
-        int ix3 = ix2 + idot;
-        passf4_ps(idot, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], isign);
-      } break;
-      case 2: {
-        passf2_ps(idot, l1, in, out, &wa[iw], isign);
-      } break;
-      case 3: {
-        int ix2 = iw + idot;
-        passf3_ps(idot, l1, in, out, &wa[iw], &wa[ix2], isign);
-      } break;
-      default:
-        assert(0);
+  }
+  pffft_scratch_free(buf);
+}
+
+static void pffft_fourstep_rows(void *arg, int index) {
+  pffft_fourstep_job *job = (pffft_fourstep_job*)arg;
+  PFFFT_Setup *s = job->s;
+  int N1 = s->rows_fft->N, N2 = s->cols_fft->N, B = PFFFT_FOURSTEP_BLOCK_SIZE(N2), ld = 2*N1 + PFFFT_FOURSTEP_PAD;
+  float *buf, *tmp;
+  int begin, end, r, b, k;
+
+  pffft_task_range(N2/B, s->nthreads, index, &begin, &end);
+  if (begin == end) return;
+  buf = (float*)pffft_scratch_alloc((B*ld + 2*N1)*sizeof(float));
+  tmp = buf + B*ld;
+  for (r = begin*B; r < end*B; r += B) {
+    for (b=0; b < B; ++b) {
+      pffft_transform_ordered(s->rows_fft, job->work + 2*(size_t)(r+b)*N1, buf + b*ld, tmp, job->direction);
     }
-    l1 = l2;
-    iw += (ip - 1)*idot;
-    if (out == work2) {
-      out = work1; in = work2;
-    } else {
-      out = work2; in = work1;
+    for (k=0; k < N1; ++k) {
+      float *out = job->output + 2*((size_t)k*N2 + r);
+      for (b=0; b < B; ++b) {
+        out[2*b] = buf[b*ld + 2*k]; out[2*b+1] = buf[b*ld + 2*k+1];
+      }
     }
   }
+  pffft_scratch_free(buf);
+}
 
-  return in; /* this is in fact the output .. */
+/* the split step of the real transforms, on the (k, M-k) pairs of the complex spectrum of size M */
+static void pffft_fourstep_split(void *arg, int index) {
+  pffft_fourstep_job *job = (pffft_fourstep_job*)arg;
+  PFFFT_Setup *s = job->s;
+  int M = s->N/2, begin, end, k;
+  float *z = job->output;
+  const float *w = s->real_twiddle;
+
+  pffft_task_range(M/2, s->nthreads, index, &begin, &end);
+  for (k = begin+1; k <= end; ++k) {
+    float ar = job->input[2*k], ai = job->input[2*k+1], br = job->input[2*(M-k)], bi = -job->input[2*(M-k)+1];
+    float wr = w[2*k], wi = w[2*k+1];
+    if (job->direction == PFFFT_FORWARD) {
+      /* X[k] = E + w^k*O, X[M-k] = conj(E - w^k*O), with E = (A + B)/2, O = -i*(A - B)/2 */
+      float er = 0.5f*(ar + br), ei = 0.5f*(ai + bi), or_ = 0.5f*(ai - bi), oi = -0.5f*(ar - br);
+      float tr = wr*or_ - wi*oi, ti = wr*oi + wi*or_;
+      z[2*k] = er + tr; z[2*k+1] = ei + ti;
+      z[2*(M-k)] = er - tr; z[2*(M-k)+1] = -(ei - ti);
+    } else {
+      /* Z[k] = E + i*conj(w^k)*D, Z[M-k] = conj(E - i*conj(w^k)*D), with E = A + B, D = A - B */
+      float er = ar + br, ei = ai + bi, dr = ar - br, di = ai - bi;
+      float tr = -(wr*di - wi*dr), ti = wr*dr + wi*di; // i*conj(w)*D
+      z[2*k] = er + tr; z[2*k+1] = ei + ti;
+      z[2*(M-k)] = er - tr; z[2*(M-k)+1] = -(ei - ti);
+    }
+  }
+  if (index == 0) {
+    /* F(0) and F(M) from Z(0), and the other way round (the formula is the same) */
+    float x0 = job->input[0], x1 = job->input[(job->half && job->direction == PFFFT_BACKWARD) ? 2*M : 1];
+    z[0] = x0 + x1; z[1] = x0 - x1;
+    if (job->half && job->direction == PFFFT_FORWARD) { z[2*M] = z[1]; z[1] = z[2*M+1] = 0; }
+  }
 }
 
+static void pffft_fourstep_transform(PFFFT_Setup *s, const float *input, float *output, float *work, pffft_direction_t direction, int ordered) {
+  int M = (s->transform == PFFFT_REAL ? s->N/2 : s->N);
+  pffft_fourstep_job job;
+  float *scratch = (work ? work : (float*)pffft_scratch_alloc(2*M*sizeof(float)));
+
+  job.s = s; job.work = scratch; job.output = output; job.direction = direction;
+  job.half = (ordered == PFFFT_HALF_SPECTRUM);
+  if (s->transform == PFFFT_REAL && direction == PFFFT_BACKWARD) {
+    job.input = input;
+    s->parallel_for(s->pool, s->nthreads, pffft_fourstep_split, &job);
+    input = output;
+  }
+  job.input = input;
+  s->parallel_for(s->pool, s->nthreads, pffft_fourstep_columns, &job);
+  s->parallel_for(s->pool, s->nthreads, pffft_fourstep_rows, &job);
+  if (s->transform == PFFFT_REAL && direction == PFFFT_FORWARD) {
+    job.input = output;
+    s->parallel_for(s->pool, s->nthreads, pffft_fourstep_split, &job);
+  }
+  if (!work) pffft_scratch_free(scratch);
+}
 
-struct PFFFT_Setup {
-  int     N;
-  int     Ncvec; // nb of complex simd vectors (N/4 if PFFFT_COMPLEX, N/8 if PFFFT_REAL)
-  int ifac[15];
-  pffft_transform_t transform;
-  v4sf *data; // allocated room for twiddle coefs
-  float *e;    // points into 'data' , N/4*3 elements
-  float *twiddle; // points into 'data', N/4 elements
+static const pffft_simd_impl pffft_fourstep_impl = {
+  PFFFT_SIMD_AUTO, "four-step", 1,
+  0, 0, pffft_fourstep_transform, pffft_chirpz_zreorder, pffft_chirpz_zconvolve_accumulate, 0, 0, 0, 0, 0, 0, 0,
+  pffft_chirpz_power_spectrum
 };
 
-PFFFT_Setup *pffft_new_setup(int N, pffft_transform_t transform) {
-  PFFFT_Setup *s = (PFFFT_Setup*)malloc(sizeof(PFFFT_Setup));
-  int k, m;
-  /* unfortunately, the fft size must be a multiple of 16 for complex FFTs 
-     and 32 for real FFTs -- a lot of stuff would need to be rewritten to
-     handle other cases (or maybe just switch to a scalar fft, I don't know..) */
-  if (transform == PFFFT_REAL) { assert((N%(2*SIMD_SZ*SIMD_SZ))==0 && N>0); }
-  if (transform == PFFFT_COMPLEX) { assert((N%(SIMD_SZ*SIMD_SZ))==0 && N>0); }
-  //assert((N % 32) == 0);
-  s->N = N;
-  s->transform = transform;  
-  /* nb of complex simd vectors */
-  s->Ncvec = (transform == PFFFT_REAL ? N/2 : N)/SIMD_SZ;
-  s->data = (v4sf*)pffft_aligned_malloc(2*s->Ncvec * sizeof(v4sf));
-  s->e = (float*)s->data;
-  s->twiddle = (float*)(s->data + (2*s->Ncvec*(SIMD_SZ-1))/SIMD_SZ);  
+/* whether the prime factors of n are handled by the simd kernels */
+static int pffft_fourstep_smooth(int n) {
+  static const int primes[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 0 };
+  int k;
+  for (k=0; primes[k]; ++k) {
+    while (n % primes[k] == 0) n /= primes[k];
+  }
+  return n == 1;
+}
 
+static PFFFT_Setup *pffft_new_fourstep_setup(int N, pffft_transform_t transform, int nthreads,
+                                             pffft_parallel_for_t parallel_for, void *pool) {
+  int M = (transform == PFFFT_REAL ? N/2 : N), B = PFFFT_FOURSTEP_BLOCK, N1, N2 = 0, best = 0, n1, k2;
+  PFFFT_Setup *s;
+  if (N <= 0 || (transform == PFFFT_REAL && N % 2)) return 0;
+
+  /* N1 and N2 as close as possible to sqrt(M) */
+  for (N1 = B; N1 <= M/B; N1 += B) {
+    if (M % N1 || (M/N1) % B || !pffft_fourstep_smooth(N1) || !pffft_fourstep_smooth(M/N1)) continue;
+    if (!best || fabs(log((double)N1*N1/M)) < fabs(log((double)best*best/M))) best = N1;
+  }
+  if (!best) return 0;
+  N1 = best; N2 = M/N1;
+
+  s = (PFFFT_Setup*)calloc(1, sizeof(PFFFT_Setup));
+  s->N = N;
+  s->transform = transform;
+  s->simd = &pffft_fourstep_impl;
+  s->rows_fft = pffft_new_kernel_setup(N1, PFFFT_COMPLEX);
+  s->cols_fft = pffft_new_kernel_setup(N2, PFFFT_COMPLEX);
+  s->nthreads = nthreads;
+  s->parallel_for = (parallel_for ? parallel_for : pffft_default_parallel_for);
+  s->pool = pool;
+  s->data = (float*)pffft_aligned_malloc((2*M + (transform == PFFFT_REAL ? M+2 : 0))*sizeof(float));
+  s->step_twiddle = s->data;
+  for (k2=0; k2 < N2; ++k2) {
+    for (n1=0; n1 < N1; ++n1) {
+      double A = -2*M_PI*(double)(((long long)n1*k2) % M)/M;
+      s->step_twiddle[2*((size_t)k2*N1 + n1)]   = (float)cos(A);
+      s->step_twiddle[2*((size_t)k2*N1 + n1)+1] = (float)sin(A);
+    }
+  }
   if (transform == PFFFT_REAL) {
-    for (k=0; k < s->Ncvec; ++k) {
-      int i = k/SIMD_SZ;
-      int j = k%SIMD_SZ;
-      for (m=0; m < SIMD_SZ-1; ++m) {
-        float A = -2*(float)M_PI*(m+1)*k / N;
-        s->e[(2*(i*3 + m) + 0) * SIMD_SZ + j] = cosf(A);
-        s->e[(2*(i*3 + m) + 1) * SIMD_SZ + j] = sinf(A);
-      }
+    s->real_twiddle = s->data + 2*M;
+    for (k2=0; k2 <= M/2; ++k2) {
+      double A = -M_PI*k2/M;
+      s->real_twiddle[2*k2]   = (float)cos(A);
+      s->real_twiddle[2*k2+1] = (float)sin(A);
     }
-    rffti1_ps(N/SIMD_SZ, s->twiddle, s->ifac);
+  }
+  return s;
+}
+
+PFFFT_Setup *pffft_new_setup_threaded(int N, pffft_transform_t transform, int nthreads,
+                                      pffft_parallel_for_t parallel_for, void *pool) {
+  PFFFT_Setup *s;
+  /* the four-step transforms are only worth it with several cores, which the caller has to ask for */
+  if (nthreads <= 0) return pffft_new_setup(N, transform);
+  s = pffft_new_fourstep_setup(N, transform, nthreads, parallel_for, pool);
+  return (s ? s : pffft_new_setup(N, transform));
+}
+
+size_t pffft_work_size(PFFFT_Setup *setup) {
+  /* the chirp-z transforms do not use 'work' */
+  if (setup->chirp_fft) return 0;
+  return (setup->transform == PFFFT_REAL ? (size_t)setup->N : 2*(size_t)setup->N)*sizeof(float);
+}
+
+size_t pffft_scratch_size(PFFFT_Setup *setup, pffft_batch_t layout) {
+  size_t n = (setup->transform == PFFFT_REAL ? (size_t)setup->N : 2*(size_t)setup->N)*sizeof(float);
+  size_t size, batch;
+  if (setup->chirp_fft) {
+    size = PFFFT_ALIGN64(6*(size_t)setup->chirp_fft->N*sizeof(float));
+  } else if (setup->rows_fft) {
+    /* the scratch area, and the buffer of the tasks that run in the calling thread */
+    size_t N1 = setup->rows_fft->N, N2 = setup->cols_fft->N;
+    size_t cols = (PFFFT_FOURSTEP_BLOCK_SIZE(N1)*(2*N2 + PFFFT_FOURSTEP_PAD) + 2*N2)*sizeof(float);
+    size_t rows = (PFFFT_FOURSTEP_BLOCK_SIZE(N2)*(2*N1 + PFFFT_FOURSTEP_PAD) + 2*N1)*sizeof(float);
+    size = PFFFT_ALIGN64(n) + PFFFT_ALIGN64(cols > rows ? cols : rows);
+  } else {
+    size = PFFFT_ALIGN64(n);
+  }
+  if (layout != PFFFT_BATCH_TRANSPOSED) {
+    return size;
+  } else if (setup->lane_twiddle) {
+    batch = PFFFT_ALIGN64(2*n*setup->lane_simd->simd_size);
   } else {
-    for (k=0; k < s->Ncvec; ++k) {
-      int i = k/SIMD_SZ;
-      int j = k%SIMD_SZ;
-      for (m=0; m < SIMD_SZ-1; ++m) {
-        float A = -2*(float)M_PI*(m+1)*k / N;
-        s->e[(2*(i*3 + m) + 0)*SIMD_SZ + j] = cosf(A);
-        s->e[(2*(i*3 + m) + 1)*SIMD_SZ + j] = sinf(A);
+    batch = PFFFT_ALIGN64(n) + size;
+  }
+  return (size > batch ? size : batch);
+}
+
+/*
+  Setup cache: pffft_get_setup shares one setup between all the users of
+  the same (N, transform, simd flavour). The setups live in a fixed table
+  of slots, which are looked up without lock:
+
+    - 'key' is 0 for the empty slots, -1 for the removed ones, and
+      ((N*2 + transform)*16 + simd)+1 otherwise,
+    - 'refcount' is the number of users, or -1 when the slot is removed
+      (or being filled).
+
+  A reader increments the refcount of the slot holding its key (unless it
+  is -1), and checks the key again since the slot may have been reused in
+  the meantime. Insertions and removals are serialized by a mutex, and
+  only remove the slots whose refcount goes from 0 to -1, so a setup is
+  never destroyed while in use. Linear probing stops on the empty slots,
+  and the insertions reuse the removed ones.
+*/
+#if defined(PFFFT_HAVE_PTHREADS) && defined(COMPILER_GCC)
+#  define PFFFT_SETUP_CACHE
+#endif
+
+#define PFFFT_CACHE_SLOTS 256
+
+#ifdef PFFFT_SETUP_CACHE
+typedef struct pffft_cache_slot {
+  long long key;
+  int refcount;
+  long last_use; // value of the hit counter on the last hit, for the eviction of the oldest ones
+  PFFFT_Setup *setup;
+} pffft_cache_slot;
+
+static pffft_cache_slot pffft_cache[PFFFT_CACHE_SLOTS];
+static pthread_mutex_t pffft_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static long pffft_cache_hits = 0, pffft_cache_misses = 0;
+static int pffft_cache_limit = 64; // max nb of setups kept in the cache, the ones in use are never evicted
+static int pffft_cache_count = 0;  // nb of setups in the cache, only modified with the mutex held
+
+/* a forced flavour gives other setups than the same default one (see pffft_kernel_impl) */
+static long long pffft_cache_key(int N, pffft_transform_t transform) {
+  return (((long long)N*2 + transform)*16 + pffft_simd_active()->simd + 1)*2 + pffft_simd_forced();
+}
+
+static unsigned pffft_cache_hash(long long key) {
+  return (unsigned)(((unsigned long long)key * 0x9E3779B97F4A7C15ull) >> 40) % PFFFT_CACHE_SLOTS;
+}
+
+/* the setup of 'key' with its refcount incremented, or null */
+static PFFFT_Setup *pffft_cache_lookup(long long key) {
+  unsigned h = pffft_cache_hash(key), k;
+  for (k=0; k < PFFFT_CACHE_SLOTS; ++k) {
+    pffft_cache_slot *slot = &pffft_cache[(h + k) % PFFFT_CACHE_SLOTS];
+    long long slot_key = __atomic_load_n(&slot->key, __ATOMIC_ACQUIRE);
+    if (slot_key == 0) break;
+    if (slot_key == key) {
+      int r = __atomic_load_n(&slot->refcount, __ATOMIC_RELAXED);
+      while (r >= 0 && !__atomic_compare_exchange_n(&slot->refcount, &r, r+1, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {}
+      if (r < 0) break; // being removed or filled, go through the mutex
+      if (__atomic_load_n(&slot->key, __ATOMIC_ACQUIRE) == key) {
+        long tick = __atomic_add_fetch(&pffft_cache_hits, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&slot->last_use, tick, __ATOMIC_RELAXED);
+        return slot->setup;
       }
+      __atomic_sub_fetch(&slot->refcount, 1, __ATOMIC_RELEASE); // the slot was reused meanwhile
+      break;
     }
-    cffti1_ps(N/SIMD_SZ, s->twiddle, s->ifac);
   }
+  return 0;
+}
 
-  /* check that N is decomposable with allowed prime factors */
-  for (k=0, m=1; k < s->ifac[1]; ++k) { m *= s->ifac[2+k]; }
-  if (m != N/SIMD_SZ) {
-    pffft_destroy_setup(s); s = 0;
+/* remove the unused setups, the oldest first, until there are at most 'limit' of them (mutex held) */
+static void pffft_cache_evict(int limit) {
+  while (pffft_cache_count > limit) {
+    pffft_cache_slot *oldest = 0;
+    int k, zero = 0;
+    for (k=0; k < PFFFT_CACHE_SLOTS; ++k) {
+      pffft_cache_slot *slot = &pffft_cache[k];
+      if (slot->key > 0 && __atomic_load_n(&slot->refcount, __ATOMIC_RELAXED) == 0
+          && (!oldest || __atomic_load_n(&slot->last_use, __ATOMIC_RELAXED) < __atomic_load_n(&oldest->last_use, __ATOMIC_RELAXED))) {
+        oldest = slot;
+      }
+    }
+    if (!oldest) break; // all in use
+    if (!__atomic_compare_exchange_n(&oldest->refcount, &zero, -1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) continue;
+    __atomic_store_n(&oldest->key, -1, __ATOMIC_RELEASE);
+    oldest->setup->cache_slot = 0;
+    pffft_destroy_setup(oldest->setup);
+    oldest->setup = 0;
+    __atomic_sub_fetch(&pffft_cache_count, 1, __ATOMIC_RELAXED);
   }
+}
 
+PFFFT_Setup *pffft_get_setup(int N, pffft_transform_t transform) {
+  long long key = pffft_cache_key(N, transform);
+  PFFFT_Setup *s = pffft_cache_lookup(key);
+  pffft_cache_slot *free_slot = 0;
+  unsigned h, k;
+  if (s) return s;
+
+  pthread_mutex_lock(&pffft_cache_mutex);
+  s = pffft_cache_lookup(key); // another thread may have created it
+  if (!s) {
+    __atomic_add_fetch(&pffft_cache_misses, 1, __ATOMIC_RELAXED);
+    s = pffft_new_setup(N, transform);
+    pffft_cache_evict(pffft_cache_limit - 1);
+    h = pffft_cache_hash(key);
+    for (k=0; s && k < PFFFT_CACHE_SLOTS && !free_slot; ++k) {
+      pffft_cache_slot *slot = &pffft_cache[(h + k) % PFFFT_CACHE_SLOTS];
+      if (slot->key <= 0) free_slot = slot;
+    }
+    if (free_slot) { // otherwise the cache is full, s is not shared
+      __atomic_store_n(&free_slot->refcount, -1, __ATOMIC_RELAXED);
+      free_slot->setup = s;
+      __atomic_store_n(&free_slot->last_use, __atomic_load_n(&pffft_cache_hits, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+      s->cache_slot = (int)(free_slot - pffft_cache) + 1;
+      __atomic_store_n(&free_slot->key, key, __ATOMIC_RELEASE);
+      __atomic_store_n(&free_slot->refcount, 1, __ATOMIC_RELEASE);
+      __atomic_add_fetch(&pffft_cache_count, 1, __ATOMIC_RELAXED);
+    }
+  }
+  pthread_mutex_unlock(&pffft_cache_mutex);
   return s;
 }
 
+void pffft_release_setup(PFFFT_Setup *s) {
+  if (!s) return;
+  if (!s->cache_slot) {
+    pffft_destroy_setup(s);
+  } else if (__atomic_sub_fetch(&pffft_cache[s->cache_slot - 1].refcount, 1, __ATOMIC_RELEASE) == 0
+             && __atomic_load_n(&pffft_cache_count, __ATOMIC_RELAXED) > __atomic_load_n(&pffft_cache_limit, __ATOMIC_RELAXED)) {
+    pthread_mutex_lock(&pffft_cache_mutex);
+    pffft_cache_evict(pffft_cache_limit);
+    pthread_mutex_unlock(&pffft_cache_mutex);
+  }
+}
 
-void pffft_destroy_setup(PFFFT_Setup *s) {
-  pffft_aligned_free(s->data);
-  free(s);
+void pffft_setup_cache_limit(int max_setups) {
+  pthread_mutex_lock(&pffft_cache_mutex);
+  __atomic_store_n(&pffft_cache_limit, (max_setups < 0 ? 0 : max_setups), __ATOMIC_RELAXED);
+  pffft_cache_evict(pffft_cache_limit);
+  pthread_mutex_unlock(&pffft_cache_mutex);
+}
+
+void pffft_setup_cache_stats(long *hits, long *misses, int *count) {
+  if (hits) *hits = __atomic_load_n(&pffft_cache_hits, __ATOMIC_RELAXED);
+  if (misses) *misses = __atomic_load_n(&pffft_cache_misses, __ATOMIC_RELAXED);
+  if (count) *count = __atomic_load_n(&pffft_cache_count, __ATOMIC_RELAXED);
+}
+
+#else // !PFFFT_SETUP_CACHE: no sharing, every pffft_get_setup is a miss
+
+static long pffft_cache_misses = 0;
+
+PFFFT_Setup *pffft_get_setup(int N, pffft_transform_t transform) {
+  ++pffft_cache_misses;
+  return pffft_new_setup(N, transform);
+}
+
+void pffft_release_setup(PFFFT_Setup *s) {
+  if (s) pffft_destroy_setup(s);
 }
 
-#if !defined(PFFFT_SIMD_DISABLE)
+void pffft_setup_cache_limit(int max_setups) { (void)max_setups; }
 
-/* [0 0 1 2 3 4 5 6 7 8] -> [0 8 7 6 5 4 3 2 1] */
-static void reversed_copy(int N, const v4sf *in, int in_stride, v4sf *out) {
-  v4sf g0, g1;
+void pffft_setup_cache_stats(long *hits, long *misses, int *count) {
+  if (hits) *hits = 0;
+  if (misses) *misses = pffft_cache_misses;
+  if (count) *count = 0;
+}
+
+#endif // !PFFFT_SETUP_CACHE
+
+/*
+  Setup blobs: a header, followed by the twiddles of the setup and by the
+  ones of the transposed batches, each part starting on a 64-byte
+  boundary. The blobs are in the native byte order, and only valid for
+  the simd flavour recorded in the header.
+*/
+#define PFFFT_BLOB_VERSION 2
+#define PFFFT_BLOB_ALIGN(n) (((n) + 63) & ~(size_t)63)
+
+typedef struct pffft_blob_header {
+  char magic[8];   // "PFFFTSU"
+  int version;     // PFFFT_BLOB_VERSION
+  int byte_order;  // 0x01020304 in the native byte order
+  int float_size;  // sizeof(float)
+  int simd, simd_size; // simd flavour of the tables
+  int lane_simd;   // simd flavour of the transposed batches
+  int N, transform, Ncvec;
+  int ifac[15], lane_ifac[15];
+  int data_size;   // nb of floats of the tables
+  int twiddle_offset; // position of 'twiddle' in the tables
+  int lane_size;   // nb of floats of the twiddles of the transposed batches (0 if there are none)
+  unsigned long long blob_size;
+} pffft_blob_header;
+
+static const pffft_simd_impl *pffft_find_simd_impl(int simd) {
   int k;
-  INTERLEAVE2(in[0], in[1], g0, g1); in += in_stride;
-  
-  *--out = VSWAPHL(g0, g1); // [g0l, g0h], [g1l g1h] -> [g1l, g0h]
-  for (k=1; k < N; ++k) {
-    v4sf h0, h1;
-    INTERLEAVE2(in[0], in[1], h0, h1); in += in_stride;
-    *--out = VSWAPHL(g1, h0);
-    *--out = VSWAPHL(h0, h1);
-    g1 = h1;
+  for (k=0; pffft_simd_impls[k]; ++k) {
+    if ((int)pffft_simd_impls[k]->simd == simd && pffft_simd_supported(pffft_simd_impls[k]->simd)) return pffft_simd_impls[k];
   }
-  *--out = VSWAPHL(g1, g0);
+  return 0;
 }
 
-static void unreversed_copy(int N, const v4sf *in, v4sf *out, int out_stride) {
-  v4sf g0, g1, h0, h1;
-  int k;
-  g0 = g1 = in[0]; ++in;
-  for (k=1; k < N; ++k) {
-    h0 = *in++; h1 = *in++;
-    g1 = VSWAPHL(g1, h0);
-    h0 = VSWAPHL(h0, h1);
-    UNINTERLEAVE2(h0, g1, out[0], out[1]); out += out_stride;
-    g1 = h1;
-  }
-  h0 = *in++; h1 = g0;
-  g1 = VSWAPHL(g1, h0);
-  h0 = VSWAPHL(h0, h1);
-  UNINTERLEAVE2(h0, g1, out[0], out[1]);
-}
-
-void pffft_zreorder(PFFFT_Setup *setup, const float *in, float *out, pffft_direction_t direction) {
-  int k, N = setup->N, Ncvec = setup->Ncvec;
-  const v4sf *vin = (const v4sf*)in;
-  v4sf *vout = (v4sf*)out;
-  assert(in != out);
-  if (setup->transform == PFFFT_REAL) {
-    int k, dk = N/32;
-    if (direction == PFFFT_FORWARD) {
-      for (k=0; k < dk; ++k) {
-        INTERLEAVE2(vin[k*8 + 0], vin[k*8 + 1], vout[2*(0*dk + k) + 0], vout[2*(0*dk + k) + 1]);
-        INTERLEAVE2(vin[k*8 + 4], vin[k*8 + 5], vout[2*(2*dk + k) + 0], vout[2*(2*dk + k) + 1]);
-      }
-      reversed_copy(dk, vin+2, 8, (v4sf*)(out + N/2));
-      reversed_copy(dk, vin+6, 8, (v4sf*)(out + N));
-    } else {
-      for (k=0; k < dk; ++k) {
-        UNINTERLEAVE2(vin[2*(0*dk + k) + 0], vin[2*(0*dk + k) + 1], vout[k*8 + 0], vout[k*8 + 1]);
-        UNINTERLEAVE2(vin[2*(2*dk + k) + 0], vin[2*(2*dk + k) + 1], vout[k*8 + 4], vout[k*8 + 5]);
-      }
-      unreversed_copy(dk, (v4sf*)(in + N/4), (v4sf*)(out + N - 6*SIMD_SZ), -8);
-      unreversed_copy(dk, (v4sf*)(in + 3*N/4), (v4sf*)(out + N - 2*SIMD_SZ), -8);
-    }
-  } else {
-    if (direction == PFFFT_FORWARD) {
-      for (k=0; k < Ncvec; ++k) { 
-        int kk = (k/4) + (k%4)*(Ncvec/4);
-        INTERLEAVE2(vin[k*2], vin[k*2+1], vout[kk*2], vout[kk*2+1]);
-      }
-    } else {
-      for (k=0; k < Ncvec; ++k) { 
-        int kk = (k/4) + (k%4)*(Ncvec/4);
-        UNINTERLEAVE2(vin[kk*2], vin[kk*2+1], vout[k*2], vout[k*2+1]);
-      }
-    }
+size_t pffft_export_setup(PFFFT_Setup *s, void *blob, size_t size) {
+  pffft_blob_header h;
+  size_t data_pos = PFFFT_BLOB_ALIGN(sizeof(h)), lane_pos, blob_size;
+  if (!s->simd->new_setup) return 0; // chirp-z and four-step setups are not exported
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, "PFFFTSU", 8);
+  h.version = PFFFT_BLOB_VERSION;
+  h.byte_order = 0x01020304;
+  h.float_size = sizeof(float);
+  h.simd = s->simd->simd;
+  h.simd_size = s->simd->simd_size;
+  h.lane_simd = s->lane_simd->simd;
+  h.N = s->N;
+  h.transform = s->transform;
+  h.Ncvec = s->Ncvec;
+  memcpy(h.ifac, s->ifac, sizeof(h.ifac));
+  memcpy(h.lane_ifac, s->lane_ifac, sizeof(h.lane_ifac));
+  h.data_size = s->data_size;
+  h.twiddle_offset = (int)(s->twiddle - s->data);
+  h.lane_size = (s->lane_twiddle ? (s->transform == PFFFT_REAL ? s->N : 2*s->N) : 0);
+  lane_pos = data_pos + PFFFT_BLOB_ALIGN(h.data_size*sizeof(float));
+  blob_size = lane_pos + PFFFT_BLOB_ALIGN(h.lane_size*sizeof(float));
+  h.blob_size = blob_size;
+  if (blob && size >= blob_size) {
+    memset(blob, 0, blob_size);
+    memcpy(blob, &h, sizeof(h));
+    memcpy((char*)blob + data_pos, s->data, h.data_size*sizeof(float));
+    if (h.lane_size) memcpy((char*)blob + lane_pos, s->lane_twiddle, h.lane_size*sizeof(float));
   }
+  return blob_size;
 }
 
-void pffft_cplx_finalize(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e) {
-  int k, dk = Ncvec/SIMD_SZ; // number of 4x4 matrix blocks
-  v4sf r0, i0, r1, i1, r2, i2, r3, i3;
-  v4sf sr0, dr0, sr1, dr1, si0, di0, si1, di1;
-  assert(in != out);
-  for (k=0; k < dk; ++k) {    
-    r0 = in[8*k+0]; i0 = in[8*k+1];
-    r1 = in[8*k+2]; i1 = in[8*k+3];
-    r2 = in[8*k+4]; i2 = in[8*k+5];
-    r3 = in[8*k+6]; i3 = in[8*k+7];
-    VTRANSPOSE4(r0,r1,r2,r3);
-    VTRANSPOSE4(i0,i1,i2,i3);
-    VCPLXMUL(r1,i1,e[k*6+0],e[k*6+1]);
-    VCPLXMUL(r2,i2,e[k*6+2],e[k*6+3]);
-    VCPLXMUL(r3,i3,e[k*6+4],e[k*6+5]);
-
-    sr0 = VADD(r0,r2); dr0 = VSUB(r0, r2);
-    sr1 = VADD(r1,r3); dr1 = VSUB(r1, r3);
-    si0 = VADD(i0,i2); di0 = VSUB(i0, i2);
-    si1 = VADD(i1,i3); di1 = VSUB(i1, i3);
-
-    /*
-      transformation for each column is:
-      
-      [1   1   1   1   0   0   0   0]   [r0]
-      [1   0  -1   0   0  -1   0   1]   [r1]
-      [1  -1   1  -1   0   0   0   0]   [r2]
-      [1   0  -1   0   0   1   0  -1]   [r3]
-      [0   0   0   0   1   1   1   1] * [i0]
-      [0   1   0  -1   1   0  -1   0]   [i1]
-      [0   0   0   0   1  -1   1  -1]   [i2]
-      [0  -1   0   1   1   0  -1   0]   [i3]    
-    */
-    
-    r0 = VADD(sr0, sr1); i0 = VADD(si0, si1);
-    r1 = VADD(dr0, di1); i1 = VSUB(di0, dr1);
-    r2 = VSUB(sr0, sr1); i2 = VSUB(si0, si1);
-    r3 = VSUB(dr0, di1); i3 = VADD(di0, dr1);
-  
-    *out++ = r0; *out++ = i0; *out++ = r1; *out++ = i1;
-    *out++ = r2; *out++ = i2; *out++ = r3; *out++ = i3;
-  }
-}
-
-void pffft_cplx_preprocess(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e) {
-  int k, dk = Ncvec/SIMD_SZ; // number of 4x4 matrix blocks
-  v4sf r0, i0, r1, i1, r2, i2, r3, i3;
-  v4sf sr0, dr0, sr1, dr1, si0, di0, si1, di1;
-  assert(in != out);
-  for (k=0; k < dk; ++k) {    
-    r0 = in[8*k+0]; i0 = in[8*k+1];
-    r1 = in[8*k+2]; i1 = in[8*k+3];
-    r2 = in[8*k+4]; i2 = in[8*k+5];
-    r3 = in[8*k+6]; i3 = in[8*k+7];
-
-    sr0 = VADD(r0,r2); dr0 = VSUB(r0, r2);
-    sr1 = VADD(r1,r3); dr1 = VSUB(r1, r3);
-    si0 = VADD(i0,i2); di0 = VSUB(i0, i2);
-    si1 = VADD(i1,i3); di1 = VSUB(i1, i3);
-
-    r0 = VADD(sr0, sr1); i0 = VADD(si0, si1);
-    r1 = VSUB(dr0, di1); i1 = VADD(di0, dr1);
-    r2 = VSUB(sr0, sr1); i2 = VSUB(si0, si1);
-    r3 = VADD(dr0, di1); i3 = VSUB(di0, dr1);
-
-    VCPLXMULCONJ(r1,i1,e[k*6+0],e[k*6+1]);
-    VCPLXMULCONJ(r2,i2,e[k*6+2],e[k*6+3]);
-    VCPLXMULCONJ(r3,i3,e[k*6+4],e[k*6+5]);
-
-    VTRANSPOSE4(r0,r1,r2,r3);
-    VTRANSPOSE4(i0,i1,i2,i3);
-
-    *out++ = r0; *out++ = i0; *out++ = r1; *out++ = i1;
-    *out++ = r2; *out++ = i2; *out++ = r3; *out++ = i3;
-  }
-}
-
-
-static ALWAYS_INLINE(void) pffft_real_finalize_4x4(const v4sf *in0, const v4sf *in1, const v4sf *in,
-                            const v4sf *e, v4sf *out) {
-  v4sf r0, i0, r1, i1, r2, i2, r3, i3;
-  v4sf sr0, dr0, sr1, dr1, si0, di0, si1, di1;
-  r0 = *in0; i0 = *in1;
-  r1 = *in++; i1 = *in++; r2 = *in++; i2 = *in++; r3 = *in++; i3 = *in++;
-  VTRANSPOSE4(r0,r1,r2,r3);
-  VTRANSPOSE4(i0,i1,i2,i3);
- 
-  /*
-    transformation for each column is:
-
-    [1   1   1   1   0   0   0   0]   [r0]
-    [1   0  -1   0   0  -1   0   1]   [r1]
-    [1   0  -1   0   0   1   0  -1]   [r2]
-    [1  -1   1  -1   0   0   0   0]   [r3]
-    [0   0   0   0   1   1   1   1] * [i0]
-    [0  -1   0   1  -1   0   1   0]   [i1]
-    [0  -1   0   1   1   0  -1   0]   [i2]
-    [0   0   0   0  -1   1  -1   1]   [i3]    
-  */
-  
-  //cerr << "matrix initial, before e , REAL:\n 1: " << r0 << "\n 1: " << r1 << "\n 1: " << r2 << "\n 1: " << r3 << "\n";
-  //cerr << "matrix initial, before e, IMAG :\n 1: " << i0 << "\n 1: " << i1 << "\n 1: " << i2 << "\n 1: " << i3 << "\n";
-
-  VCPLXMUL(r1,i1,e[0],e[1]);
-  VCPLXMUL(r2,i2,e[2],e[3]);
-  VCPLXMUL(r3,i3,e[4],e[5]);
-
-  //cerr << "matrix initial, real part:\n 1: " << r0 << "\n 1: " << r1 << "\n 1: " << r2 << "\n 1: " << r3 << "\n";
-  //cerr << "matrix initial, imag part:\n 1: " << i0 << "\n 1: " << i1 << "\n 1: " << i2 << "\n 1: " << i3 << "\n";
-
-  sr0 = VADD(r0,r2); dr0 = VSUB(r0,r2); 
-  sr1 = VADD(r1,r3); dr1 = VSUB(r3,r1);
-  si0 = VADD(i0,i2); di0 = VSUB(i0,i2); 
-  si1 = VADD(i1,i3); di1 = VSUB(i3,i1);
-
-  r0 = VADD(sr0, sr1);
-  r3 = VSUB(sr0, sr1);
-  i0 = VADD(si0, si1);
-  i3 = VSUB(si1, si0);
-  r1 = VADD(dr0, di1);
-  r2 = VSUB(dr0, di1);
-  i1 = VSUB(dr1, di0);
-  i2 = VADD(dr1, di0);
-
-  *out++ = r0;
-  *out++ = i0;
-  *out++ = r1;
-  *out++ = i1;
-  *out++ = r2;
-  *out++ = i2;
-  *out++ = r3;
-  *out++ = i3;
-
-}
-
-static NEVER_INLINE(void) pffft_real_finalize(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e) {
-  int k, dk = Ncvec/SIMD_SZ; // number of 4x4 matrix blocks
-  /* fftpack order is f0r f1r f1i f2r f2i ... f(n-1)r f(n-1)i f(n)r */
-
-  v4sf_union cr, ci, *uout = (v4sf_union*)out;
-  v4sf save = in[7], zero=VZERO();
-  float xr0, xi0, xr1, xi1, xr2, xi2, xr3, xi3;
-  static const float s = (float)M_SQRT2/2;
-
-  cr.v = in[0]; ci.v = in[Ncvec*2-1];
-  assert(in != out);
-  pffft_real_finalize_4x4(&zero, &zero, in+1, e, out);
-
-  /*
-    [cr0 cr1 cr2 cr3 ci0 ci1 ci2 ci3]
-
-    [Xr(1)]  ] [1   1   1   1   0   0   0   0]
-    [Xr(N/4) ] [0   0   0   0   1   s   0  -s]
-    [Xr(N/2) ] [1   0  -1   0   0   0   0   0]
-    [Xr(3N/4)] [0   0   0   0   1  -s   0   s]
-    [Xi(1)   ] [1  -1   1  -1   0   0   0   0]
-    [Xi(N/4) ] [0   0   0   0   0  -s  -1  -s]
-    [Xi(N/2) ] [0  -1   0   1   0   0   0   0]
-    [Xi(3N/4)] [0   0   0   0   0  -s   1  -s]
-  */
-
-  xr0=(cr.f[0]+cr.f[2]) + (cr.f[1]+cr.f[3]); uout[0].f[0] = xr0;
-  xi0=(cr.f[0]+cr.f[2]) - (cr.f[1]+cr.f[3]); uout[1].f[0] = xi0;
-  xr2=(cr.f[0]-cr.f[2]);                     uout[4].f[0] = xr2;
-  xi2=(cr.f[3]-cr.f[1]);                     uout[5].f[0] = xi2;
-  xr1= ci.f[0] + s*(ci.f[1]-ci.f[3]);        uout[2].f[0] = xr1;
-  xi1=-ci.f[2] - s*(ci.f[1]+ci.f[3]);        uout[3].f[0] = xi1;
-  xr3= ci.f[0] - s*(ci.f[1]-ci.f[3]);        uout[6].f[0] = xr3;
-  xi3= ci.f[2] - s*(ci.f[1]+ci.f[3]);        uout[7].f[0] = xi3; 
-
-  for (k=1; k < dk; ++k) {
-    v4sf save_next = in[8*k+7];
-    pffft_real_finalize_4x4(&save, &in[8*k+0], in + 8*k+1,
-                           e + k*6, out + k*8);
-    save = save_next;
-  }
-
-}
-
-static ALWAYS_INLINE(void) pffft_real_preprocess_4x4(const v4sf *in, 
-                                             const v4sf *e, v4sf *out, int first) {
-  v4sf r0=in[0], i0=in[1], r1=in[2], i1=in[3], r2=in[4], i2=in[5], r3=in[6], i3=in[7];
-  /*
-    transformation for each column is:
-
-    [1   1   1   1   0   0   0   0]   [r0]
-    [1   0   0  -1   0  -1  -1   0]   [r1]
-    [1  -1  -1   1   0   0   0   0]   [r2]
-    [1   0   0  -1   0   1   1   0]   [r3]
-    [0   0   0   0   1  -1   1  -1] * [i0]
-    [0  -1   1   0   1   0   0   1]   [i1]
-    [0   0   0   0   1   1  -1  -1]   [i2]
-    [0   1  -1   0   1   0   0   1]   [i3]    
-  */
-
-  v4sf sr0 = VADD(r0,r3), dr0 = VSUB(r0,r3); 
-  v4sf sr1 = VADD(r1,r2), dr1 = VSUB(r1,r2);
-  v4sf si0 = VADD(i0,i3), di0 = VSUB(i0,i3); 
-  v4sf si1 = VADD(i1,i2), di1 = VSUB(i1,i2);
-
-  r0 = VADD(sr0, sr1);
-  r2 = VSUB(sr0, sr1);
-  r1 = VSUB(dr0, si1);
-  r3 = VADD(dr0, si1);
-  i0 = VSUB(di0, di1);
-  i2 = VADD(di0, di1);
-  i1 = VSUB(si0, dr1);
-  i3 = VADD(si0, dr1);
-
-  VCPLXMULCONJ(r1,i1,e[0],e[1]);
-  VCPLXMULCONJ(r2,i2,e[2],e[3]);
-  VCPLXMULCONJ(r3,i3,e[4],e[5]);
-
-  VTRANSPOSE4(r0,r1,r2,r3);
-  VTRANSPOSE4(i0,i1,i2,i3);
-
-  if (!first) {
-    *out++ = r0;
-    *out++ = i0;
-  }
-  *out++ = r1;
-  *out++ = i1;
-  *out++ = r2;
-  *out++ = i2;
-  *out++ = r3;
-  *out++ = i3;
-}
-
-static NEVER_INLINE(void) pffft_real_preprocess(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e) {
-  int k, dk = Ncvec/SIMD_SZ; // number of 4x4 matrix blocks
-  /* fftpack order is f0r f1r f1i f2r f2i ... f(n-1)r f(n-1)i f(n)r */
-
-  v4sf_union Xr, Xi, *uout = (v4sf_union*)out;
-  float cr0, ci0, cr1, ci1, cr2, ci2, cr3, ci3;
-  static const float s = (float)M_SQRT2;
-  assert(in != out);
-  for (k=0; k < 4; ++k) {
-    Xr.f[k] = ((float*)in)[8*k];
-    Xi.f[k] = ((float*)in)[8*k+4];
-  }
-
-  pffft_real_preprocess_4x4(in, e, out+1, 1); // will write only 6 values
-
-  /*
-    [Xr0 Xr1 Xr2 Xr3 Xi0 Xi1 Xi2 Xi3]
-
-    [cr0] [1   0   2   0   1   0   0   0]
-    [cr1] [1   0   0   0  -1   0  -2   0]
-    [cr2] [1   0  -2   0   1   0   0   0]
-    [cr3] [1   0   0   0  -1   0   2   0]
-    [ci0] [0   2   0   2   0   0   0   0]
-    [ci1] [0   s   0  -s   0  -s   0  -s]
-    [ci2] [0   0   0   0   0  -2   0   2]
-    [ci3] [0  -s   0   s   0  -s   0  -s]
-  */
-  for (k=1; k < dk; ++k) {    
-    pffft_real_preprocess_4x4(in+8*k, e + k*6, out-1+k*8, 0);
-  }
-
-  cr0=(Xr.f[0]+Xi.f[0]) + 2*Xr.f[2]; uout[0].f[0] = cr0;
-  cr1=(Xr.f[0]-Xi.f[0]) - 2*Xi.f[2]; uout[0].f[1] = cr1;
-  cr2=(Xr.f[0]+Xi.f[0]) - 2*Xr.f[2]; uout[0].f[2] = cr2;
-  cr3=(Xr.f[0]-Xi.f[0]) + 2*Xi.f[2]; uout[0].f[3] = cr3;
-  ci0= 2*(Xr.f[1]+Xr.f[3]);                       uout[2*Ncvec-1].f[0] = ci0;
-  ci1= s*(Xr.f[1]-Xr.f[3]) - s*(Xi.f[1]+Xi.f[3]); uout[2*Ncvec-1].f[1] = ci1;
-  ci2= 2*(Xi.f[3]-Xi.f[1]);                       uout[2*Ncvec-1].f[2] = ci2;
-  ci3=-s*(Xr.f[1]-Xr.f[3]) - s*(Xi.f[1]+Xi.f[3]); uout[2*Ncvec-1].f[3] = ci3;
-}
-
-
-void pffft_transform_internal(PFFFT_Setup *setup, const float *finput, float *foutput, v4sf *scratch,
-                             pffft_direction_t direction, int ordered) {
-  int k, Ncvec   = setup->Ncvec;
-  int nf_odd = (setup->ifac[1] & 1);
-
-  // temporary buffer is allocated on the stack if the scratch pointer is NULL
-  int stack_allocate = (scratch == 0 ? Ncvec*2 : 1);
-  VLA_ARRAY_ON_STACK(v4sf, scratch_on_stack, stack_allocate);
-
-  const v4sf *vinput = (const v4sf*)finput;
-  v4sf *voutput      = (v4sf*)foutput;
-  v4sf *buff[2]      = { voutput, scratch ? scratch : scratch_on_stack };
-  int ib = (nf_odd ^ ordered ? 1 : 0);
-
-  assert(VALIGNED(finput) && VALIGNED(foutput));
-
-  //assert(finput != foutput);
-  if (direction == PFFFT_FORWARD) {
-    ib = !ib;
-    if (setup->transform == PFFFT_REAL) { 
-      ib = (rfftf1_ps(Ncvec*2, vinput, buff[ib], buff[!ib],
-                      setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);      
-      pffft_real_finalize(Ncvec, buff[ib], buff[!ib], (v4sf*)setup->e);
-    } else {
-      v4sf *tmp = buff[ib];
-      for (k=0; k < Ncvec; ++k) {
-        UNINTERLEAVE2(vinput[k*2], vinput[k*2+1], tmp[k*2], tmp[k*2+1]);
-      }
-      ib = (cfftf1_ps(Ncvec, buff[ib], buff[!ib], buff[ib], 
-                      setup->twiddle, &setup->ifac[0], -1) == buff[0] ? 0 : 1);
-      pffft_cplx_finalize(Ncvec, buff[ib], buff[!ib], (v4sf*)setup->e);
+/* whether 'ifac' factorizes the same length as 'ref' (the default
+   factorization) with its radices, the setups planned with PFFFT_MEASURE
+   reordering them and trading 4 for 2*2 */
+static int pffft_blob_ifac_valid(const int *ifac, const int *ref) {
+  int k, j, m = 1;
+  if (ifac[0] != ref[0] || ifac[1] < 0 || ifac[1] > 13 || (ifac[1] > 0) != (ref[1] > 0)) return 0;
+  for (k=0; k < ifac[1]; ++k) {
+    int f = ifac[2+k];
+    for (j=0; j < ref[1]; ++j) {
+      int r = ref[2+j];
+      if (r == f || ((f == 2 || f == 4) && (r == 2 || r == 4))) break;
     }
-    if (ordered) {
-      pffft_zreorder(setup, (float*)buff[!ib], (float*)buff[ib], PFFFT_FORWARD);       
-    } else ib = !ib;
+    if (j == ref[1]) return 0;
+    m *= f;
+  }
+  return m == ref[0];
+}
+
+/* whether the header describes the setup that its flavours make for its
+   N and transform (see pffft_init_setup for the position of 'twiddle') */
+static int pffft_blob_header_valid(const pffft_blob_header *h, const pffft_simd_impl *impl, const pffft_simd_impl *lane_impl) {
+  PFFFT_Setup ref;
+  int lane_ifac[15], S = impl->simd_size, lane_size;
+  if (h->N <= 0 || (h->transform != PFFFT_REAL && h->transform != PFFFT_COMPLEX)) return 0;
+  memset(&ref, 0, sizeof(ref));
+  memset(lane_ifac, 0, sizeof(lane_ifac));
+  if (impl->init_setup(&ref, 0, h->N, (pffft_transform_t)h->transform) != h->data_size || ref.Ncvec != h->Ncvec
+      || !pffft_blob_ifac_valid(h->ifac, ref.ifac)
+      || h->twiddle_offset != h->data_size - (2*h->Ncvec + S - 1)/S*S) return 0;
+  lane_size = (lane_impl->lane_setup(h->N, (pffft_transform_t)h->transform, 0, lane_ifac)
+               ? (h->transform == PFFFT_REAL ? h->N : 2*h->N) : 0);
+  return h->lane_size == lane_size && (!lane_size || pffft_blob_ifac_valid(h->lane_ifac, lane_ifac));
+}
+
+PFFFT_Setup *pffft_import_setup(const void *blob, size_t size, int share, size_t *blob_size) {
+  pffft_blob_header h;
+  size_t data_pos = PFFFT_BLOB_ALIGN(sizeof(h)), lane_pos;
+  const pffft_simd_impl *impl, *lane_impl;
+  PFFFT_Setup *s;
+
+  if (size < sizeof(h)) return 0;
+  memcpy(&h, blob, sizeof(h));
+  if (memcmp(h.magic, "PFFFTSU", 8) || h.version != PFFFT_BLOB_VERSION || h.byte_order != 0x01020304
+      || h.float_size != (int)sizeof(float) || h.blob_size > size || h.data_size <= 0
+      || h.twiddle_offset < 0 || h.twiddle_offset >= h.data_size || h.lane_size < 0) return 0;
+  lane_pos = data_pos + PFFFT_BLOB_ALIGN(h.data_size*sizeof(float));
+  if (lane_pos + PFFFT_BLOB_ALIGN(h.lane_size*sizeof(float)) != h.blob_size) return 0;
+  impl = pffft_find_simd_impl(h.simd);
+  lane_impl = pffft_find_simd_impl(h.lane_simd);
+  if (!impl || !lane_impl || impl->simd_size != h.simd_size) return 0; // not usable on this cpu
+  if (!impl->new_setup || !pffft_blob_header_valid(&h, impl, lane_impl)) return 0;
+
+  s = (PFFFT_Setup*)calloc(1, sizeof(PFFFT_Setup));
+  if (!s) return 0;
+  s->N = h.N;
+  s->Ncvec = h.Ncvec;
+  s->transform = (pffft_transform_t)h.transform;
+  memcpy(s->ifac, h.ifac, sizeof(h.ifac));
+  memcpy(s->lane_ifac, h.lane_ifac, sizeof(h.lane_ifac));
+  s->simd = impl;
+  s->lane_simd = lane_impl;
+  s->data_size = h.data_size;
+  /* the tables are used in place when the blob is suitably aligned (a mmap-ed file, for example) */
+  s->shared_data = (share && ((uintptr_t)blob & 63) == 0);
+  if (s->shared_data) {
+    s->data = (float*)((const char*)blob + data_pos);
+    s->lane_twiddle = (h.lane_size ? (float*)((const char*)blob + lane_pos) : 0);
   } else {
-    if (vinput == buff[ib]) { 
-      ib = !ib; // may happen when finput == foutput
-    }
-    if (ordered) {
-      pffft_zreorder(setup, (float*)vinput, (float*)buff[ib], PFFFT_BACKWARD); 
-      vinput = buff[ib]; ib = !ib;
-    }
-    if (setup->transform == PFFFT_REAL) {
-      pffft_real_preprocess(Ncvec, vinput, buff[ib], (v4sf*)setup->e);
-      ib = (rfftb1_ps(Ncvec*2, buff[ib], buff[0], buff[1], 
-                      setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);
-    } else {
-      pffft_cplx_preprocess(Ncvec, vinput, buff[ib], (v4sf*)setup->e);
-      ib = (cfftf1_ps(Ncvec, buff[ib], buff[0], buff[1], 
-                      setup->twiddle, &setup->ifac[0], +1) == buff[0] ? 0 : 1);
-      for (k=0; k < Ncvec; ++k) {
-        INTERLEAVE2(buff[ib][k*2], buff[ib][k*2+1], buff[ib][k*2], buff[ib][k*2+1]);
-      }
+    s->data = (float*)pffft_aligned_malloc(h.data_size*sizeof(float));
+    if (h.lane_size) s->lane_twiddle = (float*)pffft_aligned_malloc(h.lane_size*sizeof(float));
+    if (!s->data || (h.lane_size && !s->lane_twiddle)) {
+      pffft_aligned_free(s->data);
+      pffft_aligned_free(s->lane_twiddle);
+      free(s);
+      return 0;
     }
+    memcpy(s->data, (const char*)blob + data_pos, h.data_size*sizeof(float));
+    if (h.lane_size) memcpy(s->lane_twiddle, (const char*)blob + lane_pos, h.lane_size*sizeof(float));
   }
-  
-  if (buff[ib] != voutput) {
-    /* extra copy required -- this situation should only happen when finput == foutput */
-    assert(finput==foutput);
-    for (k=0; k < Ncvec; ++k) {
-      v4sf a = buff[ib][2*k], b = buff[ib][2*k+1];
-      voutput[2*k] = a; voutput[2*k+1] = b;
-    }
-    ib = !ib;
-  }
-  assert(buff[ib] == voutput);
-}
-
-void pffft_zconvolve_accumulate(PFFFT_Setup *s, const float *a, const float *b, float *ab, float scaling) {
-  int Ncvec = s->Ncvec;
-  const v4sf * RESTRICT va = (const v4sf*)a;
-  const v4sf * RESTRICT vb = (const v4sf*)b;
-  v4sf * RESTRICT vab = (v4sf*)ab;
-
-#ifdef __arm__
-  __builtin_prefetch(va);
-  __builtin_prefetch(vb);
-  __builtin_prefetch(vab);
-  __builtin_prefetch(va+2);
-  __builtin_prefetch(vb+2);
-  __builtin_prefetch(vab+2);
-  __builtin_prefetch(va+4);
-  __builtin_prefetch(vb+4);
-  __builtin_prefetch(vab+4);
-  __builtin_prefetch(va+6);
-  __builtin_prefetch(vb+6);
-  __builtin_prefetch(vab+6);
-# ifndef __clang__
-#   define ZCONVOLVE_USING_INLINE_NEON_ASM
-# endif
-#endif
+  s->e = s->data;
+  s->twiddle = s->data + h.twiddle_offset;
+  if (blob_size) *blob_size = h.blob_size;
+  return s;
+}
 
-  float ar, ai, br, bi, abr, abi;
-#ifndef ZCONVOLVE_USING_INLINE_ASM
-  v4sf vscal = LD_PS1(scaling);
-  int i;
-#endif
+/*
+  partitioned convolution. The impulse response is split in consecutive
+  segments, each one handled by a stage: overlap-save with a frequency
+  domain delay line, the segment being split in P partitions of S
+  samples, whose spectra (real transforms of size 2S, zero padded) are
+  computed once. Each block of S input samples is transformed along with
+  the previous one, its spectrum goes in a ring of the P last input
+  spectra, and the output block of the stage is the second half of the
+  backward transform of sum_p X[n-p]*H[p] (the first half holds the
+  circular wrap-around).
+
+  The uniform convolvers have a single stage with S = B (the block size
+  of pffft_convolver_process), run as soon as each block is in. The
+  non-uniform ones (Gardner) filter the first B taps directly, then have
+  stages of 2 partitions of B, 2B, 4B, ... samples, up to max_block_size
+  whose stage takes all the remaining partitions. The stage of size
+  S = r*B starts at tap 2S - B, so the output of one of its input blocks
+  is only needed r - 1 calls after the block is in, and its work is
+  spread over these calls: when r >= 2, the forward and the backward
+  transforms run on the calls c = r/4 - 1 modulo r/2 (so that the large
+  transforms of two stages never run in the same call), and the products
+  with the partitions are split evenly between the calls that separate
+  them.
+*/
+#define PFFFT_CONV_MAX_STAGES 32
+
+typedef struct pffft_conv_stage {
+  int S, P;        // partition size, nb of partitions
+  int r;           // S/B, nb of calls per block of the stage
+  int offset;      // first tap of the segment
+  int pos;         // slot of the last input spectrum in the ring, the older ones follow it
+  int next;        // next partition to multiply with the last input spectrum
+  int busy;        // between the forward and the backward transforms of a block
+  long long block; // index of the next block to transform
+  size_t stride;   // nb of floats of each spectrum, 64-byte aligned
+  PFFFT_Setup *setup; // the real transforms of size 2S, shared with pffft_get_setup
+  float *ir_dft;   // the P spectra of the partitions of the segment
+  float *fdl;      // the ring of the P last input spectra
+  const float **fdl_ptr; // fdl_ptr[i] = the slot i % P of the ring, for i < 2P, then ir_ptr[p] = the spectrum of partition p
+  float *acc;      // 2S floats: the input of the forward transforms, and the output spectrum
+  float *out;      // the last two output blocks of the stage
+} pffft_conv_stage;
+
+struct PFFFT_Convolver {
+  int B;           // block size of pffft_convolver_process
+  int nstages;
+  long long calls; // nb of blocks processed
+  int head;        // nb of taps filtered in direct form
+  float *head_ir;
+  const pffft_simd_impl *fir_simd;
+  int hist_len;    // the input history is a ring of hist_len samples, stored twice so that the windows are contiguous
+  int hist_pos;    // where the next input block goes
+  float *hist;
+  float *work;     // scratch area of the largest transforms
+  pffft_conv_stage stages[PFFFT_CONV_MAX_STAGES];
+};
 
-  assert(VALIGNED(a) && VALIGNED(b) && VALIGNED(ab));
-  ar = ((v4sf_union*)va)[0].f[0];
-  ai = ((v4sf_union*)va)[1].f[0];
-  br = ((v4sf_union*)vb)[0].f[0];
-  bi = ((v4sf_union*)vb)[1].f[0];
-  abr = ((v4sf_union*)vab)[0].f[0];
-  abi = ((v4sf_union*)vab)[1].f[0];
- 
-#ifdef ZCONVOLVE_USING_INLINE_ASM // inline asm version, unfortunately miscompiled by clang 3.2, at least on ubuntu.. so this will be restricted to gcc
-  const float *a_ = a, *b_ = b; float *ab_ = ab;
-  int N = Ncvec;
-  asm volatile("mov         r8, %2                  \n"
-               "vdup.f32    q15, %4                 \n"
-               "1:                                  \n"
-               "pld         [%0,#64]                \n"
-               "pld         [%1,#64]                \n"
-               "pld         [%2,#64]                \n"
-               "pld         [%0,#96]                \n"
-               "pld         [%1,#96]                \n"
-               "pld         [%2,#96]                \n"
-               "vld1.f32    {q0,q1},   [%0,:128]!         \n"
-               "vld1.f32    {q4,q5},   [%1,:128]!         \n"
-               "vld1.f32    {q2,q3},   [%0,:128]!         \n"
-               "vld1.f32    {q6,q7},   [%1,:128]!         \n"
-               "vld1.f32    {q8,q9},   [r8,:128]!          \n"
-               
-               "vmul.f32    q10, q0, q4             \n"
-               "vmul.f32    q11, q0, q5             \n"
-               "vmul.f32    q12, q2, q6             \n" 
-               "vmul.f32    q13, q2, q7             \n"                 
-               "vmls.f32    q10, q1, q5             \n"
-               "vmla.f32    q11, q1, q4             \n"
-               "vld1.f32    {q0,q1}, [r8,:128]!     \n"
-               "vmls.f32    q12, q3, q7             \n"
-               "vmla.f32    q13, q3, q6             \n"
-               "vmla.f32    q8, q10, q15            \n"
-               "vmla.f32    q9, q11, q15            \n"
-               "vmla.f32    q0, q12, q15            \n"
-               "vmla.f32    q1, q13, q15            \n"
-               "vst1.f32    {q8,q9},[%2,:128]!    \n"
-               "vst1.f32    {q0,q1},[%2,:128]!    \n"
-               "subs        %3, #2                  \n"
-               "bne         1b                      \n"
-               : "+r"(a_), "+r"(b_), "+r"(ab_), "+r"(N) : "r"(scaling) : "r8", "q0","q1","q2","q3","q4","q5","q6","q7","q8","q9", "q10","q11","q12","q13","q15","memory");
-#else // default routine, works fine for non-arm cpus with current compilers
-  for (i=0; i < Ncvec; i += 2) {
-    v4sf ar, ai, br, bi;
-    ar = va[2*i+0]; ai = va[2*i+1];
-    br = vb[2*i+0]; bi = vb[2*i+1];
-    VCPLXMUL(ar, ai, br, bi);
-    vab[2*i+0] = VMADD(ar, vscal, vab[2*i+0]);
-    vab[2*i+1] = VMADD(ai, vscal, vab[2*i+1]);
-    ar = va[2*i+2]; ai = va[2*i+3];
-    br = vb[2*i+2]; bi = vb[2*i+3];
-    VCPLXMUL(ar, ai, br, bi);
-    vab[2*i+2] = VMADD(ar, vscal, vab[2*i+2]);
-    vab[2*i+3] = VMADD(ai, vscal, vab[2*i+3]);
+static void pffft_conv_add_stage(PFFFT_Convolver *c, int S, int P, int offset, const float *ir, int ir_len) {
+  pffft_conv_stage *st = &c->stages[c->nstages++];
+  int p, k;
+  st->S = S;
+  st->P = P;
+  st->r = S/c->B;
+  st->offset = offset;
+  st->setup = pffft_get_setup(2*S, PFFFT_REAL);
+  st->stride = PFFFT_ALIGN64(2*S*sizeof(float))/sizeof(float);
+  st->ir_dft = (float*)pffft_aligned_malloc(P*st->stride*sizeof(float));
+  st->fdl = (float*)pffft_aligned_malloc(P*st->stride*sizeof(float));
+  st->acc = (float*)pffft_aligned_malloc(2*S*sizeof(float));
+  st->out = (float*)pffft_aligned_malloc(2*S*sizeof(float));
+  st->fdl_ptr = (const float**)malloc(3*P*sizeof(float*));
+  for (p=0; p < 2*P; ++p) st->fdl_ptr[p] = st->fdl + (p % P)*st->stride;
+  for (p=0; p < P; ++p) st->fdl_ptr[2*P + p] = st->ir_dft + p*st->stride;
+  for (p=0; p < P; ++p) {
+    for (k=0; k < 2*S; ++k) {
+      int t = offset + p*S + k;
+      st->acc[k] = (k < S && t < ir_len ? ir[t] : 0);
+    }
+    pffft_transform(st->setup, st->acc, st->ir_dft + p*st->stride, c->work, PFFFT_FORWARD);
   }
-#endif
-  if (s->transform == PFFFT_REAL) {
-    ((v4sf_union*)vab)[0].f[0] = abr + ar*br*scaling;
-    ((v4sf_union*)vab)[1].f[0] = abi + ai*bi*scaling;
+}
+
+/* the convolver of the stages of sizes up to max_block */
+static PFFFT_Convolver *pffft_conv_new(int B, int max_block) {
+  PFFFT_Convolver *c = (PFFFT_Convolver*)calloc(1, sizeof(PFFFT_Convolver));
+  c->B = B;
+  c->hist_len = 4*max_block;
+  c->hist = (float*)pffft_aligned_malloc(2*c->hist_len*sizeof(float));
+  c->work = (float*)pffft_aligned_malloc(2*max_block*sizeof(float));
+  c->fir_simd = pffft_simd_active();
+  return c;
+}
+
+PFFFT_Convolver *pffft_new_convolver(int block_size, const float *ir, int ir_len) {
+  PFFFT_Convolver *c;
+  if (block_size <= 0 || ir_len <= 0) return 0;
+  c = pffft_conv_new(block_size, block_size);
+  pffft_conv_add_stage(c, block_size, (ir_len + block_size - 1)/block_size, 0, ir, ir_len);
+  pffft_convolver_reset(c);
+  return c;
+}
+
+PFFFT_Convolver *pffft_new_convolver_nonuniform(int block_size, int max_block_size, const float *ir, int ir_len) {
+  PFFFT_Convolver *c;
+  int B = block_size, S, Smax, offset;
+  if (B <= 0 || ir_len <= 0) return 0;
+  for (Smax = B; Smax <= max_block_size/2 && Smax <= (1 << 28)/B; Smax *= 2) {}
+  c = pffft_conv_new(B, Smax);
+  c->head = (ir_len < B ? ir_len : B);
+  c->head_ir = (float*)malloc(c->head*sizeof(float));
+  memcpy(c->head_ir, ir, c->head*sizeof(float));
+  for (offset = B, S = B; offset < ir_len; S = (S < Smax ? 2*S : S)) {
+    int P = (ir_len - offset + S - 1)/S;
+    if (S < Smax && P > 2) P = 2;
+    pffft_conv_add_stage(c, S, P, offset, ir, ir_len);
+    offset += P*S;
   }
+  pffft_convolver_reset(c);
+  return c;
 }
 
+void pffft_destroy_convolver(PFFFT_Convolver *c) {
+  int k;
+  if (!c) return;
+  for (k=0; k < c->nstages; ++k) {
+    pffft_conv_stage *st = &c->stages[k];
+    pffft_release_setup(st->setup);
+    pffft_aligned_free(st->ir_dft);
+    pffft_aligned_free(st->fdl);
+    pffft_aligned_free(st->acc);
+    pffft_aligned_free(st->out);
+    free(st->fdl_ptr);
+  }
+  free(c->head_ir);
+  pffft_aligned_free(c->hist);
+  pffft_aligned_free(c->work);
+  free(c);
+}
 
-#else // defined(PFFFT_SIMD_DISABLE)
+void pffft_convolver_reset(PFFFT_Convolver *c) {
+  int k;
+  memset(c->hist, 0, 2*c->hist_len*sizeof(float));
+  c->hist_pos = 0;
+  c->calls = 0;
+  for (k=0; k < c->nstages; ++k) {
+    pffft_conv_stage *st = &c->stages[k];
+    memset(st->fdl, 0, st->P*st->stride*sizeof(float));
+    memset(st->out, 0, 2*st->S*sizeof(float));
+    st->pos = 0;
+    st->busy = 0;
+    st->block = 0;
+  }
+}
 
-// standard routine using scalar floats, without SIMD stuff.
+/* accumulates the products of at most n more partitions for the last input block of the stage */
+static void pffft_conv_accumulate(pffft_conv_stage *st, int n) {
+  if (n > st->P - st->next) n = st->P - st->next;
+  if (n <= 0) return;
+  pffft_zconvolve_accumulate_many(st->setup, n, st->fdl_ptr + st->pos + st->next, st->fdl_ptr + 2*st->P + st->next,
+                                  st->acc, 1.f/(2*st->S));
+  st->next += n;
+}
 
-#define pffft_zreorder_nosimd pffft_zreorder
-void pffft_zreorder_nosimd(PFFFT_Setup *setup, const float *in, float *out, pffft_direction_t direction) {
-  int k, N = setup->N;
-  if (setup->transform == PFFFT_COMPLEX) {
-    for (k=0; k < 2*N; ++k) out[k] = in[k];
+/* the work of a stage in the current call, 'end' being the end of the input history */
+static void pffft_conv_stage_run(PFFFT_Convolver *c, pffft_conv_stage *st, const float *end) {
+  int r = st->r;
+  int event = (r <= 2 || c->calls % (r/2) == r/4 - 1);
+  if (st->busy) {
+    pffft_conv_accumulate(st, event ? st->P : (st->P + r/2 - 1)/(r/2));
+  } else if ((r == 1 || event) && c->calls >= (st->block + 1)*r - 1) {
+    /* the input block is in: its window ends 'lag' samples ago */
+    long long lag = (c->calls + 1)*c->B - (st->block + 1)*st->S;
+    memcpy(st->acc, end - lag - 2*st->S, 2*st->S*sizeof(float));
+    st->pos = (st->pos + st->P - 1) % st->P;
+    pffft_transform(st->setup, st->acc, st->fdl + st->pos*st->stride, c->work, PFFFT_FORWARD);
+    memset(st->acc, 0, 2*st->S*sizeof(float));
+    st->next = 0;
+    st->busy = 1;
+    st->block++;
+    if (r == 1) pffft_conv_accumulate(st, st->P);
+    else return;
+  } else {
     return;
   }
-  else if (direction == PFFFT_FORWARD) {
-    float x_N = in[N-1];
-    for (k=N-1; k > 1; --k) out[k] = in[k-1]; 
-    out[0] = in[0];
-    out[1] = x_N;
+  if (event) {
+    pffft_transform(st->setup, st->acc, st->acc, c->work, PFFFT_BACKWARD);
+    memcpy(st->out + ((st->block - 1) & 1)*st->S, st->acc + st->S, st->S*sizeof(float));
+    st->busy = 0;
+  }
+}
+
+void pffft_convolver_process(PFFFT_Convolver *c, const float *input, float *output) {
+  int B = c->B, L = c->hist_len, k, i;
+  float *end;
+  memcpy(c->hist + c->hist_pos, input, B*sizeof(float));
+  memcpy(c->hist + L + c->hist_pos, input, B*sizeof(float));
+  c->hist_pos = (c->hist_pos + B) % L;
+  end = c->hist + L + c->hist_pos; // the last input sample is end[-1]
+
+  if (c->head) {
+    c->fir_simd->fir(c->head_ir, c->head, end - B, output, B);
   } else {
-    float x_N = in[1];
-    for (k=1; k < N-1; ++k) out[k] = in[k+1]; 
-    out[0] = in[0];
-    out[N-1] = x_N;
-  }
-}
-
-#define pffft_transform_internal_nosimd pffft_transform_internal
-void pffft_transform_internal_nosimd(PFFFT_Setup *setup, const float *input, float *output, float *scratch,
-                                    pffft_direction_t direction, int ordered) {
-  int Ncvec   = setup->Ncvec;
-  int nf_odd = (setup->ifac[1] & 1);
-
-  // temporary buffer is allocated on the stack if the scratch pointer is NULL
-  int stack_allocate = (scratch == 0 ? Ncvec*2 : 1);
-  VLA_ARRAY_ON_STACK(v4sf, scratch_on_stack, stack_allocate);
-  float *buff[2];
-  int ib;
-  if (scratch == 0) scratch = scratch_on_stack;
-  buff[0] = output; buff[1] = scratch;
-
-  if (setup->transform == PFFFT_COMPLEX) ordered = 0; // it is always ordered.
-  ib = (nf_odd ^ ordered ? 1 : 0);
-
-  if (direction == PFFFT_FORWARD) {
-    if (setup->transform == PFFFT_REAL) { 
-      ib = (rfftf1_ps(Ncvec*2, input, buff[ib], buff[!ib],
-                      setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);      
-    } else {
-      ib = (cfftf1_ps(Ncvec, input, buff[ib], buff[!ib], 
-                      setup->twiddle, &setup->ifac[0], -1) == buff[0] ? 0 : 1);
-    }
-    if (ordered) {
-      pffft_zreorder(setup, buff[ib], buff[!ib], PFFFT_FORWARD); ib = !ib;
-    }
-  } else {    
-    if (input == buff[ib]) { 
-      ib = !ib; // may happen when finput == foutput
-    }
-    if (ordered) {
-      pffft_zreorder(setup, input, buff[!ib], PFFFT_BACKWARD); 
-      input = buff[!ib];
+    memset(output, 0, B*sizeof(float));
+  }
+  for (k=0; k < c->nstages; ++k) {
+    pffft_conv_stage *st = &c->stages[k];
+    long long m = c->calls*B - st->offset; // index of the first output sample of the call in the output of the stage
+    pffft_conv_stage_run(c, st, end);
+    if (m >= 0) {
+      const float *y = st->out + ((m / st->S) & 1)*st->S + m % st->S;
+      for (i=0; i < B; ++i) output[i] += y[i];
     }
-    if (setup->transform == PFFFT_REAL) {
-      ib = (rfftb1_ps(Ncvec*2, input, buff[ib], buff[!ib], 
-                      setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);
-    } else {
-      ib = (cfftf1_ps(Ncvec, input, buff[ib], buff[!ib], 
-                      setup->twiddle, &setup->ifac[0], +1) == buff[0] ? 0 : 1);
+  }
+  c->calls++;
+}
+
+/*
+  streaming STFT: the input goes in a ring of N samples stored twice, so
+  that the last N samples are always contiguous, and each frame is
+  windowed while it is copied out of the ring, straight into the input
+  of the transform.
+*/
+struct PFFFT_Stft {
+  int N, hop;
+  int ordered;
+  int pos;         // where the next input sample goes in the ring
+  int fill;        // nb of input samples since the last frame
+  PFFFT_Setup *setup; // shared with pffft_get_setup
+  const pffft_simd_impl *window_simd;
+  float *data;     // all the buffers below
+  float *window;
+  float *ring;     // 2N samples, ring[i] == ring[i + N]
+  float *frame;    // the windowed frame, then its transform when the output is not aligned
+  float *work;
+};
+
+PFFFT_Stft *pffft_new_stft(int frame_size, int hop, const float *window, int ordered) {
+  PFFFT_Stft *st;
+  PFFFT_Setup *setup;
+  size_t stride;
+  int k;
+  if (hop <= 0 || hop > frame_size) return 0;
+  setup = pffft_get_setup(frame_size, PFFFT_REAL);
+  if (!setup) return 0;
+  st = (PFFFT_Stft*)calloc(1, sizeof(PFFFT_Stft));
+  st->N = frame_size;
+  st->hop = hop;
+  st->ordered = ordered;
+  st->setup = setup;
+  st->window_simd = pffft_simd_active();
+  stride = PFFFT_ALIGN64(frame_size*sizeof(float))/sizeof(float);
+  st->data = (float*)pffft_aligned_malloc(5*stride*sizeof(float));
+  st->window = st->data;
+  st->ring = st->window + stride;
+  st->frame = st->ring + 2*stride;
+  st->work = st->frame + stride;
+  for (k=0; k < frame_size; ++k) st->window[k] = (window ? window[k] : 1.f);
+  pffft_stft_reset(st);
+  return st;
+}
+
+void pffft_destroy_stft(PFFFT_Stft *st) {
+  if (!st) return;
+  pffft_release_setup(st->setup);
+  pffft_aligned_free(st->data);
+  free(st);
+}
+
+void pffft_stft_reset(PFFFT_Stft *st) {
+  memset(st->ring, 0, 2*st->N*sizeof(float));
+  st->pos = 0;
+  st->fill = 0;
+}
+
+int pffft_stft_process(PFFFT_Stft *st, const float *input, int n, float *output) {
+  int N = st->N, frames = 0;
+  while (n > 0) {
+    int m = st->hop - st->fill, first;
+    if (m > n) m = n;
+    /* append m samples to the ring, in at most two pieces */
+    first = (N - st->pos < m ? N - st->pos : m);
+    memcpy(st->ring + st->pos, input, first*sizeof(float));
+    memcpy(st->ring + N + st->pos, input, first*sizeof(float));
+    memcpy(st->ring, input + first, (m - first)*sizeof(float));
+    memcpy(st->ring + N, input + first, (m - first)*sizeof(float));
+    st->pos = (st->pos + m) % N;
+    st->fill += m;
+    input += m;
+    n -= m;
+    if (st->fill == st->hop) {
+      /* the last N samples start at the oldest one, ring[pos] */
+      float *y = output + (size_t)frames*N;
+      int aligned = (((uintptr_t)y & 63) == 0);
+      st->window_simd->window(st->ring + st->pos, st->window, st->frame, N, 0);
+      if (st->ordered) {
+        pffft_transform_ordered(st->setup, st->frame, aligned ? y : st->frame, st->work, PFFFT_FORWARD);
+      } else {
+        pffft_transform(st->setup, st->frame, aligned ? y : st->frame, st->work, PFFFT_FORWARD);
+      }
+      if (!aligned) memcpy(y, st->frame, N*sizeof(float));
+      st->fill = 0;
+      ++frames;
     }
   }
-  if (buff[ib] != output) {
-    int k;
-    // extra copy required -- this situation should happens only when finput == foutput
-    assert(input==output);
-    for (k=0; k < Ncvec; ++k) {
-      float a = buff[ib][2*k], b = buff[ib][2*k+1];
-      output[2*k] = a; output[2*k+1] = b;
+  return frames;
+}
+
+/*
+  streaming ISTFT: the overlap-add goes in a ring of N samples, the
+  position j of the frame being added at ring[(pos + j) % N]. The 1/N
+  scaling of the backward transform, the synthesis window and the COLA
+  normalization are folded in one weight per position of the frame, so
+  that each frame is added with one simd pass (two at the wrap-around).
+*/
+struct PFFFT_Istft {
+  int N, hop;
+  int ordered;
+  int pos;         // the oldest sample of the ring, the next output
+  PFFFT_Setup *setup; // shared with pffft_get_setup
+  const pffft_simd_impl *window_simd;
+  float *data;     // all the buffers below
+  float *weight;
+  float *ring;
+  float *frame;    // the backward transform of the frame
+  float *work;
+};
+
+PFFFT_Istft *pffft_new_istft(int frame_size, int hop, const float *analysis_window, const float *synthesis_window, int ordered) {
+  PFFFT_Istft *st;
+  PFFFT_Setup *setup;
+  size_t stride;
+  int N = frame_size, j, k;
+  if (hop <= 0 || hop > N) return 0;
+  setup = pffft_get_setup(N, PFFFT_REAL);
+  if (!setup) return 0;
+  st = (PFFFT_Istft*)calloc(1, sizeof(PFFFT_Istft));
+  st->N = N;
+  st->hop = hop;
+  st->ordered = ordered;
+  st->setup = setup;
+  st->window_simd = pffft_simd_active();
+  stride = PFFFT_ALIGN64(N*sizeof(float))/sizeof(float);
+  st->data = (float*)pffft_aligned_malloc(4*stride*sizeof(float));
+  st->weight = st->data;
+  st->ring = st->weight + stride;
+  st->frame = st->ring + stride;
+  st->work = st->frame + stride;
+  /* each output sample is the sum of the frames at the positions j, j + hop, j + 2*hop ... (modulo hop),
+     normalized by the sum of analysis*synthesis over these positions */
+  for (j=0; j < hop && j < N; ++j) {
+    double norm = 0;
+    for (k=j; k < N; k += hop) {
+      norm += (analysis_window ? analysis_window[k] : 1.)*(synthesis_window ? synthesis_window[k] : 1.);
+    }
+    for (k=j; k < N; k += hop) {
+      st->weight[k] = (norm != 0 ? (float)((synthesis_window ? synthesis_window[k] : 1.)/(norm*N)) : 0.f);
     }
-    ib = !ib;
   }
-  assert(buff[ib] == output);
+  pffft_istft_reset(st);
+  return st;
 }
 
-#define pffft_zconvolve_accumulate_nosimd pffft_zconvolve_accumulate
-void pffft_zconvolve_accumulate_nosimd(PFFFT_Setup *s, const float *a, const float *b,
-                                       float *ab, float scaling) {
-  int i, Ncvec = s->Ncvec;
+void pffft_destroy_istft(PFFFT_Istft *st) {
+  if (!st) return;
+  pffft_release_setup(st->setup);
+  pffft_aligned_free(st->data);
+  free(st);
+}
 
-  if (s->transform == PFFFT_REAL) {
-    // take care of the fftpack ordering
-    ab[0] += a[0]*b[0]*scaling;
-    ab[2*Ncvec-1] += a[2*Ncvec-1]*b[2*Ncvec-1]*scaling;
-    ++ab; ++a; ++b; --Ncvec;
+void pffft_istft_reset(PFFFT_Istft *st) {
+  memset(st->ring, 0, st->N*sizeof(float));
+  st->pos = 0;
+}
+
+void pffft_istft_process(PFFFT_Istft *st, const float *input, float *output) {
+  int N = st->N, hop = st->hop, first;
+  const float *x = input;
+  if (((uintptr_t)input & 63) != 0) {
+    memcpy(st->frame, input, N*sizeof(float));
+    x = st->frame;
   }
-  for (i=0; i < Ncvec; ++i) {
-    float ar, ai, br, bi;
-    ar = a[2*i+0]; ai = a[2*i+1];
-    br = b[2*i+0]; bi = b[2*i+1];
-    VCPLXMUL(ar, ai, br, bi);
-    ab[2*i+0] += ar*scaling;
-    ab[2*i+1] += ai*scaling;
+  if (st->ordered) {
+    pffft_transform_ordered(st->setup, x, st->frame, st->work, PFFFT_BACKWARD);
+  } else {
+    pffft_transform(st->setup, x, st->frame, st->work, PFFFT_BACKWARD);
   }
+  /* weighted overlap-add, then the hop oldest samples are complete */
+  first = N - st->pos;
+  st->window_simd->window(st->frame, st->weight, st->ring + st->pos, first, 1);
+  st->window_simd->window(st->frame + first, st->weight + first, st->ring, N - first, 1);
+  first = (N - st->pos < hop ? N - st->pos : hop);
+  memcpy(output, st->ring + st->pos, first*sizeof(float));
+  memcpy(output + first, st->ring, (hop - first)*sizeof(float));
+  memset(st->ring + st->pos, 0, first*sizeof(float));
+  memset(st->ring, 0, (hop - first)*sizeof(float));
+  st->pos = (st->pos + hop) % N;
 }
 
-#endif // defined(PFFFT_SIMD_DISABLE)
+PFFFTD_Setup *pffftd_new_setup(int N, pffft_transform_t transform) {
+  const pffftd_simd_impl *active = pffftd_simd_active(), *impl = active;
+  PFFFTD_Setup *s = impl->new_setup(N, transform);
+  int k;
+  for (k=0; !s && !pffft_simd_forced() && pffftd_simd_impls[k]; ++k) {
+    impl = pffftd_simd_impls[k];
+    if (impl->simd_size < active->simd_size && pffft_simd_supported(impl->simd)) {
+      s = impl->new_setup(N, transform);
+    }
+  }
+  if (s) s->simd = impl;
+  return s;
+}
 
-void pffft_transform(PFFFT_Setup *setup, const float *input, float *output, float *work, pffft_direction_t direction) {
-  pffft_transform_internal(setup, input, output, (v4sf*)work, direction, 0);
+void pffftd_transform(PFFFTD_Setup *setup, const double *input, double *output, double *work, pffft_direction_t direction) {
+  setup->simd->transform(setup, input, output, work, direction, 0);
 }
 
-void pffft_transform_ordered(PFFFT_Setup *setup, const float *input, float *output, float *work, pffft_direction_t direction) {
-  pffft_transform_internal(setup, input, output, (v4sf*)work, direction, 1);
+void pffftd_transform_ordered(PFFFTD_Setup *setup, const double *input, double *output, double *work, pffft_direction_t direction) {
+  setup->simd->transform(setup, input, output, work, direction, 1);
+}
+
+void pffftd_zreorder(PFFFTD_Setup *setup, const double *input, double *output, pffft_direction_t direction) {
+  setup->simd->zreorder(setup, input, output, direction);
+}
+
+void pffftd_transform_halfspectrum(PFFFTD_Setup *setup, const double *input, double *output, double *work, pffft_direction_t direction) {
+  setup->simd->transform(setup, input, output, work, direction, PFFFT_HALF_SPECTRUM);
+}
+
+void pffftd_zconvolve_accumulate(PFFFTD_Setup *setup, const double *dft_a, const double *dft_b, double *dft_ab, double scaling) {
+  setup->simd->zconvolve_accumulate(setup, dft_a, dft_b, dft_ab, scaling);
+}
+
+void pffftd_zconvolve_accumulate_many(PFFFTD_Setup *setup, int K, const double *const *dft_a, const double *const *dft_b,
+                                      double *dft_ab, double scaling) {
+  setup->simd->zconvolve_accumulate_many(setup, K, dft_a, dft_b, dft_ab, scaling);
+}
+
+const char *pffftd_simd_arch() { return pffftd_simd_active()->name; }
+
+int pffftd_simd_size() { return pffftd_simd_active()->simd_size; }
+
+/* a small function that will detect compiler bugs with respect to simd instructions */
+void validate_pffft_simd() {
+  const pffft_simd_impl *impl = pffft_simd_active();
+  const pffftd_simd_impl *impld = pffftd_simd_active();
+  if (impl->validate) impl->validate();
+  if (impld->validate) impld->validate();
 }
@@ -50,23 +50,42 @@
 
    This is basically an adaptation of the single precision fftpack
    (v4) as found on netlib taking advantage of SIMD instruction found
-   on cpus such as intel x86 (SSE1), powerpc (Altivec), and arm (NEON).
+   on cpus such as intel x86 (SSE1, AVX, AVX-512), powerpc (Altivec), and
+   arm (NEON, armv7 only: aarch64 builds use the scalar code).
    
    For architectures where no SIMD instruction is available, the code
    falls back to a scalar version.  
 
    Restrictions: 
 
-   - 1D transforms only, with 32-bit single precision.
+   - 1D transforms only, with 32-bit single precision (the pffftd_*
+   functions provide the same transforms in double precision).
 
-   - supports only transforms for inputs of length N of the form
+   - the fast transforms are for inputs of length N of the form
    N=(2^a)*(3^b)*(5^c), a >= 5, b >=0, c >= 0 (32, 48, 64, 96, 128,
    144, 160, etc are all acceptable lengths). Performance is best for
-   128<=N<=8192.
+   128<=N<=8192. The other prime factors up to 31 are also accepted
+   (7*1024 or 11*64, for example), the radix 7, 11 and 13 passes being
+   nearly as fast as the radix 2, 3 and 5 ones.
+
+   - with S = pffft_simd_size(), N must also be a multiple of 2*S*S
+   for real transforms, and of S*S for complex transforms when S=4
+   (SSE, Altivec or NEON, this is implied by a >= 5 for real
+   transforms). With AVX (S=8) and AVX-512 (S=16), N only has to be a
+   multiple of 2*S for real transforms and of S for complex transforms.
+
+   - the single precision transforms of other lengths (lengths with a
+   prime factor larger than 31, for example) are computed with the chirp-z (Bluestein) algorithm, on
+   top of a complex transform of length M >= 2*N-1 of the form above.
+   They are typically 5 to 20 times slower than a transform of a nearby
+   length of the form above (but still much faster than fftpack for
+   lengths with large prime factors), and their frequency components
+   are always stored in the canonical order.
 
    - all (float*) pointers in the functions below are expected to
    have an "simd-compatible" alignment, that is 16 bytes on x86 and
-   powerpc CPUs.
+   powerpc CPUs, 32 bytes when AVX is used, and 64 bytes with AVX-512
+   (pffft_aligned_malloc always returns 64-byte aligned buffers).
   
    You can allocate such buffers with the functions
    pffft_aligned_malloc / pffft_aligned_free (or with stuff like
@@ -98,10 +117,49 @@ extern "C" {
   /*
     prepare for performing transforms of size N -- the returned
     PFFFT_Setup structure is read-only so it can safely be shared by
-    multiple concurrent threads. 
+    multiple concurrent threads. Any N > 0 is supported, the lengths
+    that are not handled directly use the chirp-z transform (see the
+    restrictions above). Returns NULL when N <= 0.
   */
   PFFFT_Setup *pffft_new_setup(int N, pffft_transform_t transform);
   void pffft_destroy_setup(PFFFT_Setup *);
+
+  /* planning modes of pffft_new_setup_plan */
+  typedef enum { PFFFT_ESTIMATE, PFFFT_MEASURE } pffft_plan_t;
+
+  /*
+    same as pffft_new_setup, but with PFFFT_MEASURE the order of the
+    radix passes, and whether radix 4 passes are split in two radix 2
+    ones, are chosen by timing a few alternatives on this cpu (as the
+    FFTW_MEASURE plans), instead of always using the same factorization.
+    This takes some milliseconds (more for the large sizes), so the
+    setup should be kept, or exported with pffft_export_setup, which
+    saves the chosen factorization. The results are the same, up to
+    rounding errors. PFFFT_ESTIMATE is the same as pffft_new_setup.
+  */
+  PFFFT_Setup *pffft_new_setup_plan(int N, pffft_transform_t transform, pffft_plan_t plan);
+
+  /*
+    setups in caller memory (a pool, an arena, shared memory, ...), for
+    the code that must not call malloc, like real-time audio threads.
+    pffft_setup_size returns the number of bytes of the buffer given to
+    pffft_init_setup (0 when N <= 0), which builds in it the same setup as
+    pffft_new_setup, as a single contiguous block: the struct, then all
+    the tables. The buffer does not need any particular alignment, and
+    the returned setup (which may not start at 'buffer') stays valid as
+    long as the buffer does. pffft_init_setup does not allocate anything,
+    and pffft_destroy_setup does nothing on these setups: just free the
+    buffer when done.
+
+    For the lengths that use the chirp-z transform, the buffer also holds
+    the setup of the inner transform, and some scratch space for the
+    computation of the tables (their transforms still take their scratch
+    area from the thread local arena when N > 2048 or so, see
+    pffft_scratch_mode).
+  */
+  size_t pffft_setup_size(int N, pffft_transform_t transform);
+  PFFFT_Setup *pffft_init_setup(void *buffer, int N, pffft_transform_t transform);
+
   /* 
      Perform a Fourier transform , The z-domain data is stored in the
      most efficient order for transforming it back, or using it for
@@ -114,9 +172,12 @@ extern "C" {
      Typically you will want to scale the backward transform by 1/N.
      
      The 'work' pointer should point to an area of N (2*N for complex
-     fft) floats, properly aligned. If 'work' is NULL, then stack will
-     be used instead (this is probably the best strategy for small
-     FFTs, say for N < 16384).
+     fft) floats (pffft_work_size bytes), properly aligned. If 'work' is
+     NULL, a scratch area is taken from the stack for the small sizes
+     (up to 64 KB, i.e. N <= 16384 real or 8192 complex), and from a
+     thread local arena for the larger ones, see pffft_scratch_mode.
+     The chirp-z transforms do not use 'work', their scratch area is
+     always taken that way.
 
      input and output may alias.
   */
@@ -126,7 +187,15 @@ extern "C" {
      Similar to pffft_transform, but makes sure that the output is
      ordered as expected (interleaved complex numbers).  This is
      similar to calling pffft_transform and then pffft_zreorder.
-     
+     The reordering is done within the last pass of the forward
+     transform (the first pass of the backward one), but it still costs
+     the interleave shuffles of the canonical layout: expect
+     pffft_transform_ordered to be about 5-10% slower than
+     pffft_transform with sse and avx512, and 10-20% with avx/fma, the
+     largest gaps at N <= 1024 (measured on x86-64 for N = 1024 to
+     16384). If you only need the spectrum for a convolution or a
+     correlation, use pffft_transform and pffft_zconvolve_accumulate.
+
      input and output may alias.
   */
   void pffft_transform_ordered(PFFFT_Setup *setup, const float *input, float *output, float *work, pffft_direction_t direction);
@@ -139,12 +208,93 @@ extern "C" {
      (for real transforms, both 0-frequency and half frequency
      components, which are real, are assembled in the first entry as
      F(0)+i*F(n/2+1). Note that the original fftpack did place
-     F(n/2+1) at the end of the arrays).
+     F(n/2+1) at the end of the arrays). For odd lengths, there is no
+     F(n/2) component, and the order is the one of fftpack: F(0),
+     followed by the real and imaginary parts of F(1), F(2), etc.
      
      input and output should not alias.
   */
   void pffft_zreorder(PFFFT_Setup *setup, const float *input, float *output, pffft_direction_t direction);
 
+  /*
+     Like pffft_transform_ordered, with the layout of the real transforms
+     of FFTW (r2c / c2r): the N/2+1 frequency components F(0) .. F(N/2)
+     as interleaved complex numbers, so 2*(N/2+1) floats, F(N/2) at the
+     end instead of being packed with F(0). The imaginary parts of F(0)
+     and F(N/2) are set to 0 by the forward transform and ignored by the
+     backward one. The spectrum is written (resp. read) by the last
+     (first) stage of the transform, there is no reordering pass. The
+     buffer of the spectrum (output of the forward transform, input of
+     the backward one) must hold N+2 floats; for complex transforms this
+     is the same as pffft_transform_ordered.
+
+     input and output may alias (with a buffer of N+2 floats).
+  */
+  void pffft_transform_halfspectrum(PFFFT_Setup *setup, const float *input, float *output, float *work, pffft_direction_t direction);
+
+  /* layout of the signals of pffft_transform_batch */
+  typedef enum { PFFFT_BATCH_CONTIGUOUS, PFFFT_BATCH_ORDERED, PFFFT_BATCH_TRANSPOSED } pffft_batch_t;
+
+  /*
+     Perform 'howmany' independent transforms of size N with the same setup.
+
+     PFFFT_BATCH_CONTIGUOUS / PFFFT_BATCH_ORDERED: the signal b starts
+     at input + b*in_stride, its transform at output + b*out_stride, and
+     each of them is exactly the one of pffft_transform (resp.
+     pffft_transform_ordered). The pointers must be aligned, as well as
+     the strides, 'work' is used as in pffft_transform.
+
+     PFFFT_BATCH_TRANSPOSED: the signals are interleaved, the sample k
+     of signal b being input[k*in_stride + b] for real transforms, and
+     the complex input[k*in_stride + 2*b] + i*input[k*in_stride + 2*b+1]
+     for complex transforms (with in_stride >= howmany, resp. 2*howmany),
+     the output being stored the same way, in the canonical order of
+     pffft_transform_ordered. Each simd lane transforms one signal, so
+     there is no alignment requirement, and no restriction on N other
+     than the one on its prime factors (N=8 or N=12 are fine): this is
+     the fastest option for many small transforms (N <= 64 or so,
+     multichannel audio, image columns, ...). 'work' is not used, and
+     input and output may alias when in_stride == out_stride. The sizes
+     that need the chirp-z transform (or the setups whose tables for
+     this layout could not be allocated) gather the signals one by one
+     in the scratch area, and leave the output untouched when it cannot
+     be allocated.
+  */
+  void pffft_transform_batch(PFFFT_Setup *setup, int howmany, const float *input, int in_stride,
+                             float *output, int out_stride, float *work, pffft_direction_t direction, pffft_batch_t layout);
+
+  /* where the transforms called with a NULL 'work' take their scratch area */
+  typedef enum { PFFFT_SCRATCH_AUTO, PFFFT_SCRATCH_THREAD } pffft_scratch_t;
+
+  /*
+    scratch memory. pffft_work_size returns the number of bytes of the
+    'work' area of the transforms of 'setup' (0 when it is not used, for
+    the chirp-z transforms).
+
+    When 'work' is NULL, the scratch area comes from the stack for the
+    small sizes (PFFFT_SCRATCH_AUTO, the default), and from an arena
+    owned by the calling thread for the larger ones, or for all sizes
+    with PFFFT_SCRATCH_THREAD (for threads with small stacks). The arena
+    only allocates memory when it grows, so a thread does not allocate
+    anything once it has done the largest of its transforms, or after
+    pffft_scratch_reserve(pffft_scratch_size(setup, layout)): passing
+    NULL is then safe at any N, without stack allocations nor per-call
+    mallocs. pffft_scratch_size is the size of the arena needed by the
+    transforms of 'setup' (pffft_transform, pffft_transform_ordered and
+    pffft_transform_batch with 'layout'; the transposed batches of large
+    sizes need a lot more, the simd lanes having their own buffers), and
+    pffft_scratch_reserve returns 0 if the allocation failed, or when
+    there is no thread local storage (the scratch areas are then
+    allocated for each transform). The arena is freed when the thread
+    exits (with pthreads) or by pffft_scratch_release. pffft_scratch_mode
+    is global, and should be called before the transforms are started.
+  */
+  void pffft_scratch_mode(pffft_scratch_t mode);
+  size_t pffft_work_size(PFFFT_Setup *setup);
+  size_t pffft_scratch_size(PFFFT_Setup *setup, pffft_batch_t layout);
+  int pffft_scratch_reserve(size_t nb_bytes);
+  void pffft_scratch_release(void);
+
   /* 
      Perform a multiplication of the frequency components of dft_a and
      dft_b and accumulate them into dft_ab. The arrays should have
@@ -159,17 +309,285 @@ extern "C" {
   */
   void pffft_zconvolve_accumulate(PFFFT_Setup *setup, const float *dft_a, const float *dft_b, float *dft_ab, float scaling);
 
+  /*
+     dft_ab += (dft_a[0]*dft_b[0] + ... + dft_a[K-1]*dft_b[K-1])*scaling,
+     with the same layout as pffft_zconvolve_accumulate. This is what
+     partitioned convolutions and filter banks need: dft_ab is read and
+     written once instead of K times, so it is much faster than K calls
+     of pffft_zconvolve_accumulate when the spectra do not fit in the L1
+     cache. The rounding errors differ slightly, the products being
+     summed before the scaling. dft_ab must not alias any of the inputs.
+  */
+  void pffft_zconvolve_accumulate_many(PFFFT_Setup *setup, int K, const float *const *dft_a, const float *const *dft_b,
+                                       float *dft_ab, float scaling);
+
+  /*
+     power spectrum of a forward transform: power[k] = |X(k)|^2 for k =
+     0 .. N/2 for real transforms (N/2+1 floats, (N+1)/2 when N is odd),
+     and k = 0 .. N-1 for complex ones, in the natural order. The squared
+     magnitudes are computed in the internal layout of pffft_transform
+     and only the real results are put in order, so this is cheaper than
+     pffft_transform_ordered followed by a loop on the bins (take the
+     square root for magnitudes). 'power' needs no particular alignment,
+     'work' is NULL (the scratch arena of the thread is then used) or an
+     aligned buffer of N floats (2*N for complex transforms), which
+     receives the unordered spectrum.
+  */
+  void pffft_power_spectrum(PFFFT_Setup *setup, const float *input, float *power, float *work);
+
+  /*
+    runs task(arg, index) for index = 0 .. count-1, possibly concurrently,
+    and returns once all of them are done.
+  */
+  typedef void (*pffft_parallel_for_t)(void *pool, int count, void (*task)(void *arg, int index), void *arg);
+
+  /*
+    prepare for performing multithreaded transforms of size N, for the
+    large sizes (N >= 65536 or so) whose working set does not fit in the
+    caches. The transforms are done with the four-step algorithm: the
+    complex transform of size M = N1*N2 (M = N/2 for real transforms) is
+    split in N1 transforms of size N2 and N2 transforms of size N1,
+    N1 and N2 being multiples of 16 and having no prime factor larger
+    than 31. The other sizes get a regular (single threaded) setup.
+
+    Each step of the transforms is split in 'nthreads' tasks which are
+    given to parallel_for(pool, ...). nthreads <= 0 gives a regular setup,
+    the same as pffft_new_setup: on a single core the four-step transforms
+    are up to twice as slow as pffft_transform, so they only pay off when
+    the caller knows that several cores are available for them.
+    When parallel_for is NULL, the tasks run in a pool of threads kept by
+    pffft (pthreads, define PFFFT_NO_THREADS to disable them): its
+    threads (at most the number of online cpus minus one, whatever
+    nthreads is) are started by the first transform that needs them and
+    then stay idle until the process exits, the calling thread running
+    its share of the tasks. The pool runs the transforms of one thread at
+    a time, the ones of the other threads meanwhile running their tasks
+    themselves (as do the setups with nthreads == 1), so passing the
+    parallel_for of your own thread pool is better when several threads
+    do large transforms at the same time.
+
+    As for the chirp-z transforms, the frequency components are always in
+    the canonical order, and 'work' is N (2*N for complex transforms)
+    floats that are taken from the thread local arena when it is NULL
+    (the tasks take their buffers from the arena of the thread that runs
+    them). These setups may be used with all the functions above.
+  */
+  PFFFT_Setup *pffft_new_setup_threaded(int N, pffft_transform_t transform, int nthreads,
+                                        pffft_parallel_for_t parallel_for, void *pool);
+
+  /*
+    shared setups: pffft_get_setup returns the setup of size N kept in
+    a global cache (creating it on the first call), the same one being
+    returned to all the callers, with a reference count. Cache hits do not
+    take any lock, so this is cheap enough to be called for each request
+    of a server, for example. Each pffft_get_setup must be matched by a
+    pffft_release_setup (not pffft_destroy_setup), and the setup must not
+    be used after that.
+
+    The released setups stay in the cache, which keeps at most
+    'max_setups' of them (64 by default, the least recently used unused
+    ones being destroyed first, and the ones in use never). A limit of 0
+    destroys all the unused setups. pffft_setup_cache_stats returns the
+    number of hits, misses, and setups currently in the cache (any pointer
+    may be NULL).
+
+    The cache is keyed by (N, transform, simd flavour of
+    pffft_simd_select). It needs pthreads and gcc (or clang) atomics,
+    otherwise pffft_get_setup / pffft_release_setup simply create and
+    destroy setups.
+  */
+  PFFFT_Setup *pffft_get_setup(int N, pffft_transform_t transform);
+  void pffft_release_setup(PFFFT_Setup *setup);
+  void pffft_setup_cache_limit(int max_setups);
+  void pffft_setup_cache_stats(long *hits, long *misses, int *count);
+
+  /*
+    saving and loading setups, to skip the computation of their tables.
+
+    pffft_export_setup returns the size of the "blob" holding the setup,
+    and writes it to 'blob' when 'size' is large enough (so call it first
+    with a NULL blob to get the size). The blob contains the simd flavour
+    the tables were computed for, N, the factorization and the tables, in
+    the native byte order. The sizes handled with the chirp-z transform and
+    the setups of pffft_new_setup_threaded cannot be exported (0 is
+    returned).
+
+    pffft_import_setup returns the setup stored in a blob, or NULL if the
+    blob is invalid, from another version of pffft, or for a simd flavour
+    that this cpu does not support. When 'share' is non zero and the blob
+    is 64-byte aligned, the setup uses the tables of the blob instead of a
+    copy of them: the blob must then stay valid, and unmodified, until
+    the setup is destroyed. With a file mmap-ed read-only, this lets many
+    processes share the same copy of the tables. The blob sizes being
+    multiples of 64 bytes, several blobs can be stored one after the
+    other, 'blob_size' (if not NULL) receiving the size of the imported
+    one.
+  */
+  size_t pffft_export_setup(PFFFT_Setup *setup, void *blob, size_t size);
+  PFFFT_Setup *pffft_import_setup(const void *blob, size_t size, int share, size_t *blob_size);
+
   /*
     the float buffers must have the correct alignment (16-byte boundary
-    on intel and powerpc). This function may be used to obtain such
-    correctly aligned buffers.  
+    on intel and powerpc, 32-byte with AVX, 64-byte with AVX-512). This function may be used
+    to obtain such correctly aligned buffers.  
   */
   void *pffft_aligned_malloc(size_t nb_bytes);
   void pffft_aligned_free(void *);
 
-  /* return 4 or 1 wether support SSE/Altivec instructions was enable when building pffft.c */
+  /*
+    streaming convolution with a fixed impulse response of ir_len
+    samples, for long FIRs (reverbs, matched filters, ...). The impulse
+    response is split in partitions of block_size samples, and each call
+    of pffft_convolver_process filters the next block_size samples of the
+    input stream (uniformly partitioned overlap-save: one forward and one
+    backward real transform of size 2*block_size, and the products
+    with all the partitions in one pffft_zconvolve_accumulate_many), so
+    that all the blocks cost
+    the same. The output is the exact convolution (up to rounding errors),
+    without any latency besides the block itself. block_size should be
+    such that 2*block_size is a multiple of 32 (a power of two is best),
+    and about the latency that can be afforded: larger blocks mean fewer
+    partitions, so less cpu per sample.
+
+    'input' and 'output' (block_size floats) may alias, and need no
+    particular alignment. pffft_convolver_reset clears the input history.
+    pffft_new_convolver returns NULL when block_size or ir_len are <= 0.
+    A convolver must not be used by several threads at once.
+
+    pffft_new_convolver_nonuniform is for short blocks with long impulse
+    responses, where the P = ir_len/block_size partitions of the uniform
+    convolver cost too much: the first block_size taps are filtered
+    directly, the next ones with partitions of block_size,
+    2*block_size, 4*block_size, ... samples (two of each size), up to
+    max_block_size for all the remaining taps. The large transforms are
+    spread over several calls, so the cost of a call stays close to the
+    average one, which is about log2(ir_len/block_size) times lower than
+    the one of the uniform convolver for long responses. The output is
+    the same (still without latency), and it is processed, reset and
+    destroyed with the same functions. max_block_size is rounded down to
+    block_size times a power of two.
+  */
+  typedef struct PFFFT_Convolver PFFFT_Convolver;
+
+  PFFFT_Convolver *pffft_new_convolver(int block_size, const float *ir, int ir_len);
+  PFFFT_Convolver *pffft_new_convolver_nonuniform(int block_size, int max_block_size, const float *ir, int ir_len);
+  void pffft_destroy_convolver(PFFFT_Convolver *convolver);
+  void pffft_convolver_reset(PFFFT_Convolver *convolver);
+  void pffft_convolver_process(PFFFT_Convolver *convolver, const float *input, float *output);
+
+  /*
+    streaming short-time Fourier transform (spectrograms): every 'hop'
+    samples of the input stream, the last frame_size samples (zeros
+    before the start of the stream) are multiplied by 'window'
+    (frame_size floats, NULL for a rectangular one) and go through a
+    real forward transform, in the order of pffft_transform_ordered when
+    'ordered' is set, of pffft_transform otherwise. The window is
+    applied while the frame is copied out of the input ring, in the same
+    simd pass, and all the buffers are allocated by pffft_new_stft.
+
+    pffft_stft_process takes any number n of input samples, writes the
+    frames completed by them at output, output + frame_size, ... and
+    returns their number: (n + k)/hop, k being the nb of samples since
+    the last frame (0 after pffft_stft_reset, which also clears the
+    input history). 'output' needs no particular alignment, but the
+    frames are transformed in place only when they are 64-byte aligned
+    (pffft_aligned_malloc, and frame_size a multiple of 16), otherwise
+    they are copied. pffft_new_stft returns NULL when frame_size is not
+    supported, or when hop is not in [1, frame_size]. Sizes with large
+    prime factors (chirp-z transforms) also use the scratch arena of the
+    thread, see pffft_scratch_reserve. An STFT must not be used by
+    several threads at once.
+  */
+  typedef struct PFFFT_Stft PFFFT_Stft;
+
+  PFFFT_Stft *pffft_new_stft(int frame_size, int hop, const float *window, int ordered);
+  void pffft_destroy_stft(PFFFT_Stft *stft);
+  void pffft_stft_reset(PFFFT_Stft *stft);
+  int pffft_stft_process(PFFFT_Stft *stft, const float *input, int n, float *output);
+
+  /*
+    the matching streaming inverse STFT (weighted overlap-add): each
+    call of pffft_istft_process takes one frame (frame_size floats, in
+    the order given by 'ordered', as written by pffft_stft_process) and
+    outputs the next 'hop' samples. The backward transform is followed
+    by a single simd pass that scales by 1/frame_size, applies the
+    synthesis window, normalizes and adds the frame to the output ring.
+    The normalization divides by the sum of analysis*synthesis windows
+    over the frames that overlap each sample, so that the unmodified
+    frames of pffft_stft_process give back its input (up to rounding
+    errors) for any windows and hop, and not only for the COLA pairs.
+    The output is delayed by frame_size - hop samples: the sample k of
+    the output of the ISTFT is the sample k - frame_size + hop of the
+    input of the STFT. A NULL window is rectangular, the samples
+    covered by no frame (zero sum) are set to zero.
+
+    'frame' and 'output' need no particular alignment (an aligned frame
+    is not copied). pffft_istft_reset clears the pending overlap-add.
+    pffft_new_istft returns NULL as pffft_new_stft.
+  */
+  typedef struct PFFFT_Istft PFFFT_Istft;
+
+  PFFFT_Istft *pffft_new_istft(int frame_size, int hop, const float *analysis_window, const float *synthesis_window, int ordered);
+  void pffft_destroy_istft(PFFFT_Istft *istft);
+  void pffft_istft_reset(PFFFT_Istft *istft);
+  void pffft_istft_process(PFFFT_Istft *istft, const float *frame, float *output);
+
+  /*
+    double precision versions of the functions above, they behave exactly
+    like their single precision counterparts. With SSE2, the simd vectors
+    hold 2 doubles (S=2), so N only has to be a multiple of 4 for real
+    transforms and of 2 for complex transforms; with AVX (S=4), the same
+    restrictions as with SSE floats apply. Sizes that are not supported by
+    the AVX version automatically fall back to the SSE2 one, and then to
+    the scalar one. Double precision simd is only available on x86 cpus.
+  */
+  typedef struct PFFFTD_Setup PFFFTD_Setup;
+
+  PFFFTD_Setup *pffftd_new_setup(int N, pffft_transform_t transform);
+  void pffftd_destroy_setup(PFFFTD_Setup *);
+  void pffftd_transform(PFFFTD_Setup *setup, const double *input, double *output, double *work, pffft_direction_t direction);
+  void pffftd_transform_ordered(PFFFTD_Setup *setup, const double *input, double *output, double *work, pffft_direction_t direction);
+  void pffftd_zreorder(PFFFTD_Setup *setup, const double *input, double *output, pffft_direction_t direction);
+  void pffftd_transform_halfspectrum(PFFFTD_Setup *setup, const double *input, double *output, double *work, pffft_direction_t direction);
+  void pffftd_zconvolve_accumulate(PFFFTD_Setup *setup, const double *dft_a, const double *dft_b, double *dft_ab, double scaling);
+  void pffftd_zconvolve_accumulate_many(PFFFTD_Setup *setup, int K, const double *const *dft_a, const double *const *dft_b,
+                                        double *dft_ab, double scaling);
+
+  /* simd instruction sets that pffft.c can be built for */
+  typedef enum { PFFFT_SIMD_AUTO, PFFFT_SIMD_SCALAR, PFFFT_SIMD_SSE, PFFFT_SIMD_AVX, PFFFT_SIMD_FMA,
+                 PFFFT_SIMD_AVX512, PFFFT_SIMD_ALTIVEC, PFFFT_SIMD_NEON } pffft_simd_t;
+
+  /*
+    When built with gcc for x86 cpus, pffft.c contains scalar, SSE, AVX,
+    AVX+FMA3 and AVX-512 versions of its kernels, and pffft_new_setup uses the
+    best one supported by the cpu for N: a narrower one when N is not
+    supported by the best one, or when N is too small for it or not a
+    multiple of its block size (2*16*16 for real AVX-512 transforms,
+    16*16 for complex ones, 2*8*8 and 8*8 for AVX). On other platforms,
+    only the version enabled by the compiler flags is available.
+
+    pffft_simd_select forces the version used by the setups created
+    afterwards, whatever N (for benchmarking, for example), PFFFT_SIMD_AUTO restoring
+    the default behaviour. It returns 0 when the requested version is
+    not available. The PFFFT_SIMD environment variable ("scalar", "sse",
+    "avx", "fma", "avx512") may also be used for that. This is not thread-safe,
+    it should be done before creating setups.
+  */
+  int pffft_simd_select(pffft_simd_t simd);
+
+  /* name of the simd instruction set currently used ("sse", "avx", ...) */
+  const char *pffft_simd_arch();
+
+  /* return the simd vector size (in floats) of the instruction set currently used: 16 for AVX-512, 8 for AVX, 4 for SSE/Altivec/NEON, or 1 when simd is disabled */
   int pffft_simd_size();
 
+  /* same thing for the double precision functions, which follow the
+     choice of pffft_simd_select when the instruction set exists for
+     doubles (for example "fma" is used for doubles when "avx512" is
+     selected). pffftd_simd_size returns 4 for AVX, 2 for SSE2, 1 otherwise */
+  const char *pffftd_simd_arch();
+  int pffftd_simd_size();
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,3778 @@
+/* Copyright (c) 2013  Julien Pommier ( pommier@modartt.com )
+
+   Based on original fortran 77 code from FFTPACKv4 from NETLIB
+   (http://www.netlib.org/fftpack), authored by Dr Paul Swarztrauber
+   of NCAR, in 1985.
+
+   As confirmed by the NCAR fftpack software curators, the following
+   FFTPACKv5 license applies to FFTPACKv4 sources. My changes are
+   released under the same terms.
+
+   FFTPACK license:
+
+   http://www.cisl.ucar.edu/css/software/fftpack5/ftpk.html
+
+   Copyright (c) 2004 the University Corporation for Atmospheric
+   Research ("UCAR"). All rights reserved. Developed by NCAR's
+   Computational and Information Systems Laboratory, UCAR,
+   www.cisl.ucar.edu.
+
+   Redistribution and use of the Software in source and binary forms,
+   with or without modification, is permitted provided that the
+   following conditions are met:
+
+   - Neither the names of NCAR's Computational and Information Systems
+   Laboratory, the University Corporation for Atmospheric Research,
+   nor the names of its sponsors or contributors may be used to
+   endorse or promote products derived from this Software without
+   specific prior written permission.  
+
+   - Redistributions of source code must retain the above copyright
+   notices, this list of conditions, and the disclaimer below.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions, and the disclaimer below in the
+   documentation and/or other materials provided with the
+   distribution.
+
+   THIS SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+   SOFTWARE.
+*/
+
+/*
+  Private header of pffft.c, not meant to be used on its own: it holds the
+  simd support macros and all the fft kernels. pffft.c includes it once for
+  each simd flavour it is built for (see PFFFT_RUNTIME_DISPATCH in pffft.c),
+  with a different PFFFT_ISA_SUFFIX every time. All the functions defined
+  here are renamed by appending that suffix, and they are reached through
+  the pffft_simd_table defined at the end of the file.
+*/
+
+#ifndef PFFFT_IMPL_RENAMES
+#define PFFFT_IMPL_RENAMES
+#define PFFFT_CAT_(a, b) a##b
+#define PFFFT_CAT(a, b) PFFFT_CAT_(a, b)
+#define PFFFT_FUNC(name) PFFFT_CAT(name, PFFFT_ISA_SUFFIX)
+#define v4sf PFFFT_FUNC(v4sf)
+#define v4sf_union PFFFT_FUNC(v4sf_union)
+#define ld_ps1 PFFFT_FUNC(ld_ps1)
+#define vtranspose8 PFFFT_FUNC(vtranspose8)
+#define vreverse8 PFFFT_FUNC(vreverse8)
+#define vtranspose16 PFFFT_FUNC(vtranspose16)
+#define print_v4sf PFFFT_FUNC(print_v4sf)
+#define validate_pffft_simd PFFFT_FUNC(validate_pffft_simd)
+#define passf2_ps PFFFT_FUNC(passf2_ps)
+#define passf3_ps PFFFT_FUNC(passf3_ps)
+#define passf4_ps PFFFT_FUNC(passf4_ps)
+#define passf5_ps PFFFT_FUNC(passf5_ps)
+#define trig_angle PFFFT_FUNC(trig_angle)
+#define radix_trig PFFFT_FUNC(radix_trig)
+#define lane_m0_tables PFFFT_FUNC(lane_m0_tables)
+#define passfp_ps PFFFT_FUNC(passfp_ps)
+#define passfg_ps PFFFT_FUNC(passfg_ps)
+#define radf2_ps PFFFT_FUNC(radf2_ps)
+#define radb2_ps PFFFT_FUNC(radb2_ps)
+#define radf3_ps PFFFT_FUNC(radf3_ps)
+#define radb3_ps PFFFT_FUNC(radb3_ps)
+#define radf4_ps PFFFT_FUNC(radf4_ps)
+#define radb4_ps PFFFT_FUNC(radb4_ps)
+#define radf5_ps PFFFT_FUNC(radf5_ps)
+#define radb5_ps PFFFT_FUNC(radb5_ps)
+#define radfp_ps PFFFT_FUNC(radfp_ps)
+#define radbp_ps PFFFT_FUNC(radbp_ps)
+#define radfg_ps PFFFT_FUNC(radfg_ps)
+#define radbg_ps PFFFT_FUNC(radbg_ps)
+#define rfftf1_ps PFFFT_FUNC(rfftf1_ps)
+#define rfftb1_ps PFFFT_FUNC(rfftb1_ps)
+#define cfftf1_ps PFFFT_FUNC(cfftf1_ps)
+#define decompose PFFFT_FUNC(decompose)
+#define rfft_ntryh PFFFT_FUNC(rfft_ntryh)
+#define cfft_ntryh PFFFT_FUNC(cfft_ntryh)
+#define rffti1_ps PFFFT_FUNC(rffti1_ps)
+#define cffti1_ps PFFFT_FUNC(cffti1_ps)
+#define rffti1_twiddles_ps PFFFT_FUNC(rffti1_twiddles_ps)
+#define cffti1_twiddles_ps PFFFT_FUNC(cffti1_twiddles_ps)
+#define factor_key PFFFT_FUNC(factor_key)
+#define sort_factors PFFFT_FUNC(sort_factors)
+#define pffft_measure_plan PFFFT_FUNC(pffft_measure_plan)
+#define pffft_measure_setup PFFFT_FUNC(pffft_measure_setup)
+#define pffft_init_setup PFFFT_FUNC(pffft_init_setup)
+#define pffft_new_setup PFFFT_FUNC(pffft_new_setup)
+#define pffft_fir PFFFT_FUNC(pffft_fir)
+#define pffft_window PFFFT_FUNC(pffft_window)
+#define pffft_power_spectrum PFFFT_FUNC(pffft_power_spectrum)
+#define reversed_copy PFFFT_FUNC(reversed_copy)
+#define unreversed_copy PFFFT_FUNC(unreversed_copy)
+#define real_slot_index PFFFT_FUNC(real_slot_index)
+#define real_store_ordered PFFFT_FUNC(real_store_ordered)
+#define real_load_ordered PFFFT_FUNC(real_load_ordered)
+#define cplx_store_ordered PFFFT_FUNC(cplx_store_ordered)
+#define cplx_load_ordered PFFFT_FUNC(cplx_load_ordered)
+#define real_store_ordered_partial PFFFT_FUNC(real_store_ordered_partial)
+#define real_load_ordered_partial PFFFT_FUNC(real_load_ordered_partial)
+#define cplx_store_ordered_partial PFFFT_FUNC(cplx_store_ordered_partial)
+#define cplx_load_ordered_partial PFFFT_FUNC(cplx_load_ordered_partial)
+#define block_store_partial PFFFT_FUNC(block_store_partial)
+#define block_load_partial PFFFT_FUNC(block_load_partial)
+#define avx_partial_mask PFFFT_FUNC(avx_partial_mask)
+#define real_zreorder_forward PFFFT_FUNC(real_zreorder_forward)
+#define real_zreorder_backward PFFFT_FUNC(real_zreorder_backward)
+#define cplx_zreorder_forward PFFFT_FUNC(cplx_zreorder_forward)
+#define cplx_zreorder_backward PFFFT_FUNC(cplx_zreorder_backward)
+#define pffft_zreorder PFFFT_FUNC(pffft_zreorder)
+#define pffft_cplx_finalize PFFFT_FUNC(pffft_cplx_finalize)
+#define pffft_cplx_preprocess PFFFT_FUNC(pffft_cplx_preprocess)
+#define pffft_real_finalize_4x4 PFFFT_FUNC(pffft_real_finalize_4x4)
+#define pffft_real_finalize PFFFT_FUNC(pffft_real_finalize)
+#define pffft_real_preprocess_4x4 PFFFT_FUNC(pffft_real_preprocess_4x4)
+#define pffft_real_preprocess PFFFT_FUNC(pffft_real_preprocess)
+#define lane_cos32 PFFFT_FUNC(lane_cos32)
+#define lane_dft_pass PFFFT_FUNC(lane_dft_pass)
+#define lane_dft PFFFT_FUNC(lane_dft)
+#define pffft_real_finalize_block PFFFT_FUNC(pffft_real_finalize_block)
+#define pffft_transform_internal PFFFT_FUNC(pffft_transform_internal)
+#define pffft_zconvolve_accumulate PFFFT_FUNC(pffft_zconvolve_accumulate)
+#define pffft_zconvolve_accumulate_many PFFFT_FUNC(pffft_zconvolve_accumulate_many)
+#define pffft_lane_setup PFFFT_FUNC(pffft_lane_setup)
+#define lane_row PFFFT_FUNC(lane_row)
+#define pffft_transform_lanes PFFFT_FUNC(pffft_transform_lanes)
+#define pffft_simd_table PFFFT_FUNC(pffft_simd_table)
+#endif // PFFFT_IMPL_RENAMES
+
+/*
+  The same kernels are used for the double precision pffftd_* functions:
+  pffft.c includes this file with PFFFT_DOUBLE defined, pffft_float is then
+  the scalar type, and v4sf (still "the simd vector type") holds doubles.
+*/
+#ifdef PFFFT_DOUBLE
+#  define pffft_float double
+#  define PFFFT_Setup PFFFTD_Setup
+#  define pffft_simd_impl pffftd_simd_impl
+#  define pffft_destroy_setup pffftd_destroy_setup
+#else
+#  define pffft_float float
+#endif
+
+/* 
+   vector support macros: the rest of the code is independant of
+   SSE/Altivec/NEON -- adding support for other platforms with 4-element
+   vectors should be limited to these macros 
+*/
+
+
+/*
+  AVX double precision support macros -- 4 doubles by simd vector, so the
+  4x4 finalize/preprocess/reorder functions are used, as with SSE floats
+*/
+#if defined(PFFFT_DOUBLE) && !defined(PFFFT_SIMD_DISABLE) && defined(__AVX__)
+
+#include <immintrin.h>
+typedef __m256d v4df;
+typedef v4df v4sf;
+#  define SIMD_SZ 4
+#  define VZERO() _mm256_setzero_pd()
+#  define VMUL(a,b) _mm256_mul_pd(a,b)
+#  define VADD(a,b) _mm256_add_pd(a,b)
+#  ifdef __FMA__
+#    define PFFFT_SIMD_ID PFFFT_SIMD_FMA
+#    define PFFFT_SIMD_NAME "fma"
+#    define VMADD(a,b,c) _mm256_fmadd_pd(a,b,c)
+#    define VMSUB(a,b,c) _mm256_fmsub_pd(a,b,c)
+#    define VNMADD(a,b,c) _mm256_fnmadd_pd(a,b,c)
+#  else
+#    define PFFFT_SIMD_ID PFFFT_SIMD_AVX
+#    define PFFFT_SIMD_NAME "avx"
+#    define VMADD(a,b,c) _mm256_add_pd(_mm256_mul_pd(a,b), c)
+#  endif
+#  define VSUB(a,b) _mm256_sub_pd(a,b)
+#  define LD_PS1(p) _mm256_set1_pd(p)
+#  define INTERLEAVE2(in1, in2, out1, out2) {                           \
+    v4sf lo__ = _mm256_unpacklo_pd(in1, in2), hi__ = _mm256_unpackhi_pd(in1, in2); \
+    out1 = _mm256_permute2f128_pd(lo__, hi__, 0x20); out2 = _mm256_permute2f128_pd(lo__, hi__, 0x31); \
+  }
+#  define UNINTERLEAVE2(in1, in2, out1, out2) {                         \
+    v4sf lo__ = _mm256_permute2f128_pd(in1, in2, 0x20), hi__ = _mm256_permute2f128_pd(in1, in2, 0x31); \
+    out1 = _mm256_unpacklo_pd(lo__, hi__); out2 = _mm256_unpackhi_pd(lo__, hi__); \
+  }
+#  define VTRANSPOSE4(x0,x1,x2,x3) {                                    \
+    v4sf t0__ = _mm256_unpacklo_pd(x0, x1), t1__ = _mm256_unpackhi_pd(x0, x1); \
+    v4sf t2__ = _mm256_unpacklo_pd(x2, x3), t3__ = _mm256_unpackhi_pd(x2, x3); \
+    x0 = _mm256_permute2f128_pd(t0__, t2__, 0x20); x1 = _mm256_permute2f128_pd(t1__, t3__, 0x20); \
+    x2 = _mm256_permute2f128_pd(t0__, t2__, 0x31); x3 = _mm256_permute2f128_pd(t1__, t3__, 0x31); \
+  }
+#  define VSWAPHL(a,b) _mm256_blend_pd(a, b, 0x3)
+#  define VLOADU(p) _mm256_loadu_pd(p)
+#  define VSTOREU(p, v) _mm256_storeu_pd(p, v)
+#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0x1F) == 0)
+
+/*
+  SSE2 double precision support macros -- only 2 doubles by simd vector,
+  handled by the generic finalize/preprocess/reorder functions (2x2 blocks)
+*/
+#elif defined(PFFFT_DOUBLE) && !defined(PFFFT_SIMD_DISABLE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+
+#include <emmintrin.h>
+typedef __m128d v2df;
+typedef v2df v4sf;
+#  define SIMD_SZ 2
+#  define PFFFT_SIMD_ID PFFFT_SIMD_SSE
+#  define PFFFT_SIMD_NAME "sse"
+#  define VZERO() _mm_setzero_pd()
+#  define VMUL(a,b) _mm_mul_pd(a,b)
+#  define VADD(a,b) _mm_add_pd(a,b)
+#  define VMADD(a,b,c) _mm_add_pd(_mm_mul_pd(a,b), c)
+#  define VSUB(a,b) _mm_sub_pd(a,b)
+#  define LD_PS1(p) _mm_set1_pd(p)
+#  define INTERLEAVE2(in1, in2, out1, out2) { v4sf tmp__ = _mm_unpacklo_pd(in1, in2); out2 = _mm_unpackhi_pd(in1, in2); out1 = tmp__; }
+#  define UNINTERLEAVE2(in1, in2, out1, out2) INTERLEAVE2(in1, in2, out1, out2) // the same thing with 2-element vectors
+#  define VTRANSPOSE(x) { v4sf tmp__ = _mm_unpacklo_pd((x)[0], (x)[1]); (x)[1] = _mm_unpackhi_pd((x)[0], (x)[1]); (x)[0] = tmp__; }
+#  define VREV(a) _mm_shuffle_pd(a, a, 1)
+#  define INTERLEAVE2_REV(in1, in2, out1, out2) INTERLEAVE2(in1, in2, out2, out1)
+#  define UNINTERLEAVE2_REV(in1, in2, out1, out2) INTERLEAVE2(in2, in1, out1, out2)
+#  define VLOADU(p) _mm_loadu_pd(p)
+#  define VSTOREU(p, v) _mm_storeu_pd(p, v)
+#  define VLOAD_PARTIAL(p, n) ((n) == 2 ? _mm_loadu_pd(p) : _mm_load_sd(p))
+#  define VSETLANE0(a, x) _mm_move_sd(a, _mm_set_sd(x))
+#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0xF) == 0)
+
+/*
+  no double precision simd support for the other platforms, the scalar code is used
+*/
+#elif defined(PFFFT_DOUBLE)
+#  if !defined(PFFFT_SIMD_DISABLE)
+#    define PFFFT_SIMD_DISABLE
+#    define PFFFT_DOUBLE_SIMD_DISABLED // undefined at the end of this file
+#  endif
+
+/*
+   Altivec support macros 
+*/
+#elif !defined(PFFFT_SIMD_DISABLE) && (defined(__ppc__) || defined(__ppc64__))
+typedef vector float v4sf;
+#  define SIMD_SZ 4
+#  define PFFFT_SIMD_ID PFFFT_SIMD_ALTIVEC
+#  define PFFFT_SIMD_NAME "altivec"
+#  define VZERO() ((vector float) vec_splat_u8(0))
+#  define VMUL(a,b) vec_madd(a,b, VZERO())
+#  define VADD(a,b) vec_add(a,b)
+#  define VMADD(a,b,c) vec_madd(a,b,c)
+#  define VNMADD(a,b,c) vec_nmsub(a,b,c)
+#  define VSUB(a,b) vec_sub(a,b)
+inline v4sf ld_ps1(const float *p) { v4sf v=vec_lde(0,p); return vec_splat(vec_perm(v, v, vec_lvsl(0, p)), 0); }
+#  define LD_PS1(p) ld_ps1(&p)
+#  define INTERLEAVE2(in1, in2, out1, out2) { v4sf tmp__ = vec_mergeh(in1, in2); out2 = vec_mergel(in1, in2); out1 = tmp__; }
+#  define UNINTERLEAVE2(in1, in2, out1, out2) {                           \
+    vector unsigned char vperm1 =  (vector unsigned char)(0,1,2,3,8,9,10,11,16,17,18,19,24,25,26,27); \
+    vector unsigned char vperm2 =  (vector unsigned char)(4,5,6,7,12,13,14,15,20,21,22,23,28,29,30,31); \
+    v4sf tmp__ = vec_perm(in1, in2, vperm1); out2 = vec_perm(in1, in2, vperm2); out1 = tmp__; \
+  }
+#  define VTRANSPOSE4(x0,x1,x2,x3) {              \
+    v4sf y0 = vec_mergeh(x0, x2);               \
+    v4sf y1 = vec_mergel(x0, x2);               \
+    v4sf y2 = vec_mergeh(x1, x3);               \
+    v4sf y3 = vec_mergel(x1, x3);               \
+    x0 = vec_mergeh(y0, y2);                    \
+    x1 = vec_mergel(y0, y2);                    \
+    x2 = vec_mergeh(y1, y3);                    \
+    x3 = vec_mergel(y1, y3);                    \
+  }
+#  define VSWAPHL(a,b) vec_perm(a,b, (vector unsigned char)(16,17,18,19,20,21,22,23,8,9,10,11,12,13,14,15))
+#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0xF) == 0)
+
+/*
+  AVX-512 support macros -- 16 floats by simd vector, handled by the same
+  generic finalize/preprocess/reorder functions as AVX (16x16 blocks)
+*/
+#elif !defined(PFFFT_SIMD_DISABLE) && defined(__AVX512F__)
+
+#include <immintrin.h>
+typedef __m512 v16sf;
+typedef v16sf v4sf;
+#  define SIMD_SZ 16
+#  define PFFFT_SIMD_ID PFFFT_SIMD_AVX512
+#  define PFFFT_SIMD_NAME "avx512"
+#  define VZERO() _mm512_setzero_ps()
+#  define VMUL(a,b) _mm512_mul_ps(a,b)
+#  define VADD(a,b) _mm512_add_ps(a,b)
+#  define VMADD(a,b,c) _mm512_fmadd_ps(a,b,c)
+#  define VMSUB(a,b,c) _mm512_fmsub_ps(a,b,c)
+#  define VNMADD(a,b,c) _mm512_fnmadd_ps(a,b,c)
+#  define VSUB(a,b) _mm512_sub_ps(a,b)
+#  define LD_PS1(p) _mm512_set1_ps(p)
+#  define INTERLEAVE2(in1, in2, out1, out2) {                           \
+    v4sf tmp__ = _mm512_permutex2var_ps(in1, _mm512_set_epi32(23,7,22,6,21,5,20,4,19,3,18,2,17,1,16,0), in2); \
+    out2 = _mm512_permutex2var_ps(in1, _mm512_set_epi32(31,15,30,14,29,13,28,12,27,11,26,10,25,9,24,8), in2); \
+    out1 = tmp__;                                                       \
+  }
+#  define UNINTERLEAVE2(in1, in2, out1, out2) {                         \
+    v4sf tmp__ = _mm512_permutex2var_ps(in1, _mm512_set_epi32(30,28,26,24,22,20,18,16,14,12,10,8,6,4,2,0), in2); \
+    out2 = _mm512_permutex2var_ps(in1, _mm512_set_epi32(31,29,27,25,23,21,19,17,15,13,11,9,7,5,3,1), in2); \
+    out1 = tmp__;                                                       \
+  }
+/* 4x4 transposes inside each 128-bit lane, then two rounds of 128-bit lane shuffles */
+static ALWAYS_INLINE(void) vtranspose16(v16sf *x) {
+  v16sf t[16], s[16];
+  int k;
+  for (k=0; k < 16; k += 2) {
+    t[k] = _mm512_unpacklo_ps(x[k], x[k+1]); t[k+1] = _mm512_unpackhi_ps(x[k], x[k+1]);
+  }
+  for (k=0; k < 16; k += 4) {
+    s[k+0] = _mm512_shuffle_ps(t[k+0], t[k+2], _MM_SHUFFLE(1,0,1,0)); s[k+1] = _mm512_shuffle_ps(t[k+0], t[k+2], _MM_SHUFFLE(3,2,3,2));
+    s[k+2] = _mm512_shuffle_ps(t[k+1], t[k+3], _MM_SHUFFLE(1,0,1,0)); s[k+3] = _mm512_shuffle_ps(t[k+1], t[k+3], _MM_SHUFFLE(3,2,3,2));
+  }
+  for (k=0; k < 4; ++k) {
+    t[k+0]  = _mm512_shuffle_f32x4(s[k+0], s[k+4],  _MM_SHUFFLE(1,0,1,0));
+    t[k+4]  = _mm512_shuffle_f32x4(s[k+0], s[k+4],  _MM_SHUFFLE(3,2,3,2));
+    t[k+8]  = _mm512_shuffle_f32x4(s[k+8], s[k+12], _MM_SHUFFLE(1,0,1,0));
+    t[k+12] = _mm512_shuffle_f32x4(s[k+8], s[k+12], _MM_SHUFFLE(3,2,3,2));
+  }
+  for (k=0; k < 4; ++k) {
+    x[k+0]  = _mm512_shuffle_f32x4(t[k+0], t[k+8],  _MM_SHUFFLE(2,0,2,0));
+    x[k+4]  = _mm512_shuffle_f32x4(t[k+0], t[k+8],  _MM_SHUFFLE(3,1,3,1));
+    x[k+8]  = _mm512_shuffle_f32x4(t[k+4], t[k+12], _MM_SHUFFLE(2,0,2,0));
+    x[k+12] = _mm512_shuffle_f32x4(t[k+4], t[k+12], _MM_SHUFFLE(3,1,3,1));
+  }
+}
+#  define VTRANSPOSE(x) vtranspose16(x)
+#  define VREV(a) _mm512_permutexvar_ps(_mm512_set_epi32(0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15), a)
+/* INTERLEAVE2(VREV(in1), VREV(in2), out1, out2), and VREV of the outputs of UNINTERLEAVE2 */
+#  define INTERLEAVE2_REV(in1, in2, out1, out2) {                       \
+    v4sf tmp__ = _mm512_permutex2var_ps(in1, _mm512_set_epi32(24,8,25,9,26,10,27,11,28,12,29,13,30,14,31,15), in2); \
+    out2 = _mm512_permutex2var_ps(in1, _mm512_set_epi32(16,0,17,1,18,2,19,3,20,4,21,5,22,6,23,7), in2); \
+    out1 = tmp__;                                                       \
+  }
+#  define UNINTERLEAVE2_REV(in1, in2, out1, out2) {                     \
+    v4sf tmp__ = _mm512_permutex2var_ps(in1, _mm512_set_epi32(0,2,4,6,8,10,12,14,16,18,20,22,24,26,28,30), in2); \
+    out2 = _mm512_permutex2var_ps(in1, _mm512_set_epi32(1,3,5,7,9,11,13,15,17,19,21,23,25,27,29,31), in2); \
+    out1 = tmp__;                                                       \
+  }
+#  define VLOADU(p) _mm512_loadu_ps(p)
+#  define VSTOREU(p, v) _mm512_storeu_ps(p, v)
+/* masked load of the n first floats (0 < n <= SIMD_SZ) of a vector, the other lanes are read as zero */
+#  define VLOAD_PARTIAL(p, n) _mm512_maskz_loadu_ps((__mmask16)((1u << (n)) - 1), p)
+/* a with its lane 0 replaced by x */
+#  define VSETLANE0(a, x) _mm512_mask_mov_ps(a, 1, _mm512_set1_ps(x))
+#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0x3F) == 0)
+
+/*
+  AVX support macros -- 8 floats by simd vector. The radix kernels do not care about the
+  vector width, but the finalize/preprocess/reorder functions have to work on 8x8
+  blocks, they are handled by the generic versions below (see SIMD_SZ != 4). When FMA3 is
+  available, VMADD/VMSUB/VNMADD (and hence the complex multiplications) use fused
+  multiply-adds, this is the "fma" flavour.
+*/
+#elif !defined(PFFFT_SIMD_DISABLE) && defined(__AVX__)
+
+#include <immintrin.h>
+typedef __m256 v8sf;
+typedef v8sf v4sf; // the rest of the code only knows about v4sf, which is "the simd vector type"
+#  define SIMD_SZ 8
+#  define VZERO() _mm256_setzero_ps()
+#  define VMUL(a,b) _mm256_mul_ps(a,b)
+#  define VADD(a,b) _mm256_add_ps(a,b)
+#  ifdef __FMA__
+#    define PFFFT_SIMD_ID PFFFT_SIMD_FMA
+#    define PFFFT_SIMD_NAME "fma"
+#    define VMADD(a,b,c) _mm256_fmadd_ps(a,b,c)
+#    define VMSUB(a,b,c) _mm256_fmsub_ps(a,b,c)
+#    define VNMADD(a,b,c) _mm256_fnmadd_ps(a,b,c)
+#  else
+#    define PFFFT_SIMD_ID PFFFT_SIMD_AVX
+#    define PFFFT_SIMD_NAME "avx"
+#    define VMADD(a,b,c) _mm256_add_ps(_mm256_mul_ps(a,b), c)
+#  endif
+#  define VSUB(a,b) _mm256_sub_ps(a,b)
+#  define LD_PS1(p) _mm256_set1_ps(p)
+#  define INTERLEAVE2(in1, in2, out1, out2) {                           \
+    v4sf lo__ = _mm256_unpacklo_ps(in1, in2), hi__ = _mm256_unpackhi_ps(in1, in2); \
+    out1 = _mm256_permute2f128_ps(lo__, hi__, 0x20); out2 = _mm256_permute2f128_ps(lo__, hi__, 0x31); \
+  }
+#  define UNINTERLEAVE2(in1, in2, out1, out2) {                         \
+    v4sf lo__ = _mm256_permute2f128_ps(in1, in2, 0x20), hi__ = _mm256_permute2f128_ps(in1, in2, 0x31); \
+    out1 = _mm256_shuffle_ps(lo__, hi__, _MM_SHUFFLE(2,0,2,0)); out2 = _mm256_shuffle_ps(lo__, hi__, _MM_SHUFFLE(3,1,3,1)); \
+  }
+static ALWAYS_INLINE(void) vtranspose8(v8sf *x) {
+  v8sf t0 = _mm256_unpacklo_ps(x[0], x[1]), t1 = _mm256_unpackhi_ps(x[0], x[1]);
+  v8sf t2 = _mm256_unpacklo_ps(x[2], x[3]), t3 = _mm256_unpackhi_ps(x[2], x[3]);
+  v8sf t4 = _mm256_unpacklo_ps(x[4], x[5]), t5 = _mm256_unpackhi_ps(x[4], x[5]);
+  v8sf t6 = _mm256_unpacklo_ps(x[6], x[7]), t7 = _mm256_unpackhi_ps(x[6], x[7]);
+  v8sf s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1,0,1,0)), s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3,2,3,2));
+  v8sf s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1,0,1,0)), s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3,2,3,2));
+  v8sf s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1,0,1,0)), s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3,2,3,2));
+  v8sf s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1,0,1,0)), s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3,2,3,2));
+  x[0] = _mm256_permute2f128_ps(s0, s4, 0x20); x[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+  x[1] = _mm256_permute2f128_ps(s1, s5, 0x20); x[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+  x[2] = _mm256_permute2f128_ps(s2, s6, 0x20); x[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+  x[3] = _mm256_permute2f128_ps(s3, s7, 0x20); x[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+static ALWAYS_INLINE(v8sf) vreverse8(v8sf a) {
+  a = _mm256_permute_ps(a, _MM_SHUFFLE(0,1,2,3)); return _mm256_permute2f128_ps(a, a, 0x01);
+}
+#  define VTRANSPOSE(x) vtranspose8(x)
+#  define VREV(a) vreverse8(a)
+/* INTERLEAVE2(VREV(in1), VREV(in2), out1, out2), and VREV of the outputs of UNINTERLEAVE2 */
+#  define INTERLEAVE2_REV(in1, in2, out1, out2) {                       \
+    v4sf lo__ = _mm256_unpacklo_ps(in1, in2), hi__ = _mm256_unpackhi_ps(in1, in2); \
+    out1 = _mm256_permute_ps(_mm256_permute2f128_ps(lo__, hi__, 0x13), _MM_SHUFFLE(1,0,3,2)); \
+    out2 = _mm256_permute_ps(_mm256_permute2f128_ps(lo__, hi__, 0x02), _MM_SHUFFLE(1,0,3,2)); \
+  }
+#  define UNINTERLEAVE2_REV(in1, in2, out1, out2) {                     \
+    v4sf lo__ = _mm256_permute2f128_ps(in1, in2, 0x13), hi__ = _mm256_permute2f128_ps(in1, in2, 0x02); \
+    out1 = _mm256_shuffle_ps(lo__, hi__, _MM_SHUFFLE(0,2,0,2)); out2 = _mm256_shuffle_ps(lo__, hi__, _MM_SHUFFLE(1,3,1,3)); \
+  }
+#  define VLOADU(p) _mm256_loadu_ps(p)
+#  define VSTOREU(p, v) _mm256_storeu_ps(p, v)
+static const int avx_partial_mask[16] = { -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0 };
+#  define VLOAD_PARTIAL(p, n) _mm256_maskload_ps(p, _mm256_loadu_si256((const __m256i*)(avx_partial_mask + 8 - (n))))
+#  define VSETLANE0(a, x) _mm256_blend_ps(a, _mm256_set1_ps(x), 1)
+#  define VSTOREU_INTERLEAVE2(p, in1, in2) {                            \
+    v4sf lo__ = _mm256_unpacklo_ps(in1, in2), hi__ = _mm256_unpackhi_ps(in1, in2); \
+    _mm_storeu_ps(p, _mm256_castps256_ps128(lo__)); _mm_storeu_ps((p) + 4, _mm256_castps256_ps128(hi__)); \
+    _mm_storeu_ps((p) + 8, _mm256_extractf128_ps(lo__, 1)); _mm_storeu_ps((p) + 12, _mm256_extractf128_ps(hi__, 1)); \
+  }
+#  define VSTOREU_INTERLEAVE2_REV(p, in1, in2) {                        \
+    v4sf lo__ = _mm256_permute_ps(_mm256_unpacklo_ps(in1, in2), _MM_SHUFFLE(1,0,3,2)); \
+    v4sf hi__ = _mm256_permute_ps(_mm256_unpackhi_ps(in1, in2), _MM_SHUFFLE(1,0,3,2)); \
+    _mm_storeu_ps(p, _mm256_extractf128_ps(hi__, 1)); _mm_storeu_ps((p) + 4, _mm256_extractf128_ps(lo__, 1)); \
+    _mm_storeu_ps((p) + 8, _mm256_castps256_ps128(hi__)); _mm_storeu_ps((p) + 12, _mm256_castps256_ps128(lo__)); \
+  }
+#  define VLOADU_UNINTERLEAVE2(p, out1, out2) {                         \
+    v4sf lo__ = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)), _mm_loadu_ps((p) + 8), 1); \
+    v4sf hi__ = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps((p) + 4)), _mm_loadu_ps((p) + 12), 1); \
+    out1 = _mm256_shuffle_ps(lo__, hi__, _MM_SHUFFLE(2,0,2,0)); out2 = _mm256_shuffle_ps(lo__, hi__, _MM_SHUFFLE(3,1,3,1)); \
+  }
+#  define VLOADU_UNINTERLEAVE2_REV(p, out1, out2) {                     \
+    v4sf lo__ = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps((p) + 8)), _mm_loadu_ps(p), 1); \
+    v4sf hi__ = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps((p) + 12)), _mm_loadu_ps((p) + 4), 1); \
+    out1 = _mm256_shuffle_ps(hi__, lo__, _MM_SHUFFLE(0,2,0,2)); out2 = _mm256_shuffle_ps(hi__, lo__, _MM_SHUFFLE(1,3,1,3)); \
+  }
+#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0x1F) == 0)
+
+/*
+  SSE1 support macros
+*/
+#elif !defined(PFFFT_SIMD_DISABLE) && (defined(__x86_64__) || defined(_M_X64) || defined(i386) || defined(_M_IX86))
+
+#include <xmmintrin.h>
+typedef __m128 v4sf;
+#  define SIMD_SZ 4 // 4 floats by simd vector
+#  define PFFFT_SIMD_ID PFFFT_SIMD_SSE
+#  define PFFFT_SIMD_NAME "sse"
+#  define VZERO() _mm_setzero_ps()
+#  define VMUL(a,b) _mm_mul_ps(a,b)
+#  define VADD(a,b) _mm_add_ps(a,b)
+#  define VMADD(a,b,c) _mm_add_ps(_mm_mul_ps(a,b), c)
+#  define VSUB(a,b) _mm_sub_ps(a,b)
+#  define LD_PS1(p) _mm_set1_ps(p)
+#  define INTERLEAVE2(in1, in2, out1, out2) { v4sf tmp__ = _mm_unpacklo_ps(in1, in2); out2 = _mm_unpackhi_ps(in1, in2); out1 = tmp__; }
+#  define UNINTERLEAVE2(in1, in2, out1, out2) { v4sf tmp__ = _mm_shuffle_ps(in1, in2, _MM_SHUFFLE(2,0,2,0)); out2 = _mm_shuffle_ps(in1, in2, _MM_SHUFFLE(3,1,3,1)); out1 = tmp__; }
+#  define VTRANSPOSE4(x0,x1,x2,x3) _MM_TRANSPOSE4_PS(x0,x1,x2,x3)
+#  define VSWAPHL(a,b) _mm_shuffle_ps(b, a, _MM_SHUFFLE(3,2,1,0))
+#  define VLOADU(p) _mm_loadu_ps(p)
+#  define VSTOREU(p, v) _mm_storeu_ps(p, v)
+#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0xF) == 0)
+
+/*
+  ARM NEON support macros
+*/
+#elif !defined(PFFFT_SIMD_DISABLE) && defined(__arm__) 
+#  include <arm_neon.h>
+typedef float32x4_t v4sf;
+#  define SIMD_SZ 4
+#  define PFFFT_SIMD_ID PFFFT_SIMD_NEON
+#  define PFFFT_SIMD_NAME "neon"
+#  define VZERO() vdupq_n_f32(0)
+#  define VMUL(a,b) vmulq_f32(a,b)
+#  define VADD(a,b) vaddq_f32(a,b)
+#  define VMADD(a,b,c) vmlaq_f32(c,a,b)
+#  define VNMADD(a,b,c) vmlsq_f32(c,a,b)
+#  define VSUB(a,b) vsubq_f32(a,b)
+#  define LD_PS1(p) vld1q_dup_f32(&(p))
+#  define INTERLEAVE2(in1, in2, out1, out2) { float32x4x2_t tmp__ = vzipq_f32(in1,in2); out1=tmp__.val[0]; out2=tmp__.val[1]; }
+#  define UNINTERLEAVE2(in1, in2, out1, out2) { float32x4x2_t tmp__ = vuzpq_f32(in1,in2); out1=tmp__.val[0]; out2=tmp__.val[1]; }
+#  define VTRANSPOSE4(x0,x1,x2,x3) {                                    \
+    float32x4x2_t t0_ = vzipq_f32(x0, x2);                              \
+    float32x4x2_t t1_ = vzipq_f32(x1, x3);                              \
+    float32x4x2_t u0_ = vzipq_f32(t0_.val[0], t1_.val[0]);              \
+    float32x4x2_t u1_ = vzipq_f32(t0_.val[1], t1_.val[1]);              \
+    x0 = u0_.val[0]; x1 = u0_.val[1]; x2 = u1_.val[0]; x3 = u1_.val[1]; \
+  }
+// marginally faster version
+//#  define VTRANSPOSE4(x0,x1,x2,x3) { asm("vtrn.32 %q0, %q1;\n vtrn.32 %q2,%q3\n vswp %f0,%e2\n vswp %f1,%e3" : "+w"(x0), "+w"(x1), "+w"(x2), "+w"(x3)::); }
+#  define VSWAPHL(a,b) vcombine_f32(vget_low_f32(b), vget_high_f32(a))
+#  define VLOADU(p) vld1q_f32(p)
+#  define VSTOREU(p, v) vst1q_f32(p, v)
+#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0x3) == 0)
+
+#else
+#  if !defined(PFFFT_SIMD_DISABLE)
+#    warning "building with simd disabled !\n";
+#    define PFFFT_SIMD_DISABLE // fallback to scalar code
+#  endif
+#endif
+
+#if !defined(PFFFT_SIMD_DISABLE) && !defined(VSTOREU_INTERLEAVE2) && defined(INTERLEAVE2_REV)
+#  define VSTOREU_INTERLEAVE2(p, in1, in2) { v4sf a__, b__; INTERLEAVE2(in1, in2, a__, b__); VSTOREU(p, a__); VSTOREU((p) + SIMD_SZ, b__); }
+#  define VSTOREU_INTERLEAVE2_REV(p, in1, in2) { v4sf a__, b__; INTERLEAVE2_REV(in1, in2, a__, b__); VSTOREU(p, a__); VSTOREU((p) + SIMD_SZ, b__); }
+#  define VLOADU_UNINTERLEAVE2(p, out1, out2) { v4sf a__ = VLOADU(p), b__ = VLOADU((p) + SIMD_SZ); UNINTERLEAVE2(a__, b__, out1, out2); }
+#  define VLOADU_UNINTERLEAVE2_REV(p, out1, out2) { v4sf a__ = VLOADU(p), b__ = VLOADU((p) + SIMD_SZ); UNINTERLEAVE2_REV(a__, b__, out1, out2); }
+#endif
+
+// fallback mode for situations where SSE/Altivec are not available, use scalar mode instead
+#ifdef PFFFT_SIMD_DISABLE
+typedef pffft_float v4sf;
+#  define SIMD_SZ 1
+#  define PFFFT_SIMD_ID PFFFT_SIMD_SCALAR
+#  define PFFFT_SIMD_NAME "scalar"
+#  define VZERO() 0.f
+#  define VMUL(a,b) ((a)*(b))
+#  define VADD(a,b) ((a)+(b))
+#  define VMADD(a,b,c) ((a)*(b)+(c))
+#  define VSUB(a,b) ((a)-(b))
+#  define LD_PS1(p) (p)
+#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0x3) == 0)
+#endif
+
+// a*b-c and c-a*b, fused when the platform has them
+#ifndef VMSUB
+#define VMSUB(a,b,c) VSUB(VMUL(a,b),c)
+#endif
+#ifndef VNMADD
+#define VNMADD(a,b,c) VSUB(c,VMUL(a,b))
+#endif
+
+// shortcuts for complex multiplcations (2 multiplications and 2 multiply-adds)
+#define VCPLXMUL(ar,ai,br,bi) { v4sf tmp; tmp=VNMADD(ai,bi,VMUL(ar,br)); ai=VMADD(ar,bi,VMUL(ai,br)); ar=tmp; }
+#define VCPLXMULCONJ(ar,ai,br,bi) { v4sf tmp; tmp=VMADD(ai,bi,VMUL(ar,br)); ai=VNMADD(ar,bi,VMUL(ai,br)); ar=tmp; }
+#ifndef SVMUL
+// multiply a scalar with a vector
+#define SVMUL(f,v) VMUL(LD_PS1(f),v)
+#endif
+
+#if !defined(PFFFT_SIMD_DISABLE)
+typedef union v4sf_union {
+  v4sf  v;
+  pffft_float f[SIMD_SZ];
+} v4sf_union;
+
+#if SIMD_SZ == 4
+
+#define assertv4(v,f0,f1,f2,f3) assert(v.f[0] == (f0) && v.f[1] == (f1) && v.f[2] == (f2) && v.f[3] == (f3))
+
+/* detect bugs with the vector support macros */
+static void validate_pffft_simd(void) {
+  pffft_float f[16] = { 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15 };
+  v4sf_union a0, a1, a2, a3, t, u; 
+  memcpy(a0.f, f, 4*sizeof(pffft_float));
+  memcpy(a1.f, f+4, 4*sizeof(pffft_float));
+  memcpy(a2.f, f+8, 4*sizeof(pffft_float));
+  memcpy(a3.f, f+12, 4*sizeof(pffft_float));
+
+  t = a0; u = a1; t.v = VZERO();
+  printf("VZERO=[%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3]); assertv4(t, 0, 0, 0, 0);
+  t.v = VADD(a1.v, a2.v);
+  printf("VADD(4:7,8:11)=[%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3]); assertv4(t, 12, 14, 16, 18);
+  t.v = VMUL(a1.v, a2.v);
+  printf("VMUL(4:7,8:11)=[%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3]); assertv4(t, 32, 45, 60, 77);
+  t.v = VMADD(a1.v, a2.v,a0.v);
+  printf("VMADD(4:7,8:11,0:3)=[%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3]); assertv4(t, 32, 46, 62, 80);
+  t.v = VNMADD(a1.v, a2.v,a0.v);
+  printf("VNMADD(4:7,8:11,0:3)=[%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3]); assertv4(t, -32, -44, -58, -74);
+
+  INTERLEAVE2(a1.v,a2.v,t.v,u.v);
+  printf("INTERLEAVE2(4:7,8:11)=[%2g %2g %2g %2g] [%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3], u.f[0], u.f[1], u.f[2], u.f[3]);
+  assertv4(t, 4, 8, 5, 9); assertv4(u, 6, 10, 7, 11);
+  UNINTERLEAVE2(a1.v,a2.v,t.v,u.v);
+  printf("UNINTERLEAVE2(4:7,8:11)=[%2g %2g %2g %2g] [%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3], u.f[0], u.f[1], u.f[2], u.f[3]);
+  assertv4(t, 4, 6, 8, 10); assertv4(u, 5, 7, 9, 11);
+
+  t.v=LD_PS1(f[15]);
+  printf("LD_PS1(15)=[%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3]);
+  assertv4(t, 15, 15, 15, 15);
+  t.v = VSWAPHL(a1.v, a2.v);
+  printf("VSWAPHL(4:7,8:11)=[%2g %2g %2g %2g]\n", t.f[0], t.f[1], t.f[2], t.f[3]);
+  assertv4(t, 8, 9, 6, 7);
+  VTRANSPOSE4(a0.v, a1.v, a2.v, a3.v);
+  printf("VTRANSPOSE4(0:3,4:7,8:11,12:15)=[%2g %2g %2g %2g] [%2g %2g %2g %2g] [%2g %2g %2g %2g] [%2g %2g %2g %2g]\n", 
+         a0.f[0], a0.f[1], a0.f[2], a0.f[3], a1.f[0], a1.f[1], a1.f[2], a1.f[3], 
+         a2.f[0], a2.f[1], a2.f[2], a2.f[3], a3.f[0], a3.f[1], a3.f[2], a3.f[3]); 
+  assertv4(a0, 0, 4, 8, 12); assertv4(a1, 1, 5, 9, 13); assertv4(a2, 2, 6, 10, 14); assertv4(a3, 3, 7, 11, 15);
+}
+
+#else // SIMD_SZ != 4
+
+static void print_v4sf(const char *name, const v4sf_union *v) {
+  int j;
+  printf("%s=[", name);
+  for (j=0; j < SIMD_SZ; ++j) printf("%s%2g", (j ? " " : ""), v->f[j]);
+  printf("]\n");
+}
+
+/* detect bugs with the vector support macros -- same checks as the 4-wide version, with
+   the expected values computed in loops as the vector width varies. */
+static void validate_pffft_simd(void) {
+  v4sf_union a[SIMD_SZ+2], t, u; // at least a[0..2], even when SIMD_SZ == 2
+  int i, j;
+  for (i=0; i < SIMD_SZ+2; ++i) {
+    for (j=0; j < SIMD_SZ; ++j) a[i].f[j] = (pffft_float)(i*SIMD_SZ + j);
+  }
+
+  t.v = VZERO();
+  print_v4sf("VZERO", &t);
+  for (j=0; j < SIMD_SZ; ++j) assert(t.f[j] == 0);
+  t.v = VADD(a[1].v, a[2].v);
+  print_v4sf("VADD(a1,a2)", &t);
+  for (j=0; j < SIMD_SZ; ++j) assert(t.f[j] == a[1].f[j] + a[2].f[j]);
+  t.v = VMUL(a[1].v, a[2].v);
+  print_v4sf("VMUL(a1,a2)", &t);
+  for (j=0; j < SIMD_SZ; ++j) assert(t.f[j] == a[1].f[j] * a[2].f[j]);
+  t.v = VMADD(a[1].v, a[2].v, a[0].v);
+  print_v4sf("VMADD(a1,a2,a0)", &t);
+  for (j=0; j < SIMD_SZ; ++j) assert(t.f[j] == a[1].f[j] * a[2].f[j] + a[0].f[j]);
+  t.v = VMSUB(a[1].v, a[2].v, a[0].v);
+  print_v4sf("VMSUB(a1,a2,a0)", &t);
+  for (j=0; j < SIMD_SZ; ++j) assert(t.f[j] == a[1].f[j] * a[2].f[j] - a[0].f[j]);
+  t.v = VNMADD(a[1].v, a[2].v, a[0].v);
+  print_v4sf("VNMADD(a1,a2,a0)", &t);
+  for (j=0; j < SIMD_SZ; ++j) assert(t.f[j] == a[0].f[j] - a[1].f[j] * a[2].f[j]);
+
+  INTERLEAVE2(a[1].v, a[2].v, t.v, u.v);
+  print_v4sf("INTERLEAVE2(a1,a2).0", &t); print_v4sf("INTERLEAVE2(a1,a2).1", &u);
+  for (j=0; j < SIMD_SZ/2; ++j) {
+    assert(t.f[2*j] == a[1].f[j] && t.f[2*j+1] == a[2].f[j]);
+    assert(u.f[2*j] == a[1].f[j + SIMD_SZ/2] && u.f[2*j+1] == a[2].f[j + SIMD_SZ/2]);
+  }
+  UNINTERLEAVE2(a[1].v, a[2].v, t.v, u.v);
+  print_v4sf("UNINTERLEAVE2(a1,a2).0", &t); print_v4sf("UNINTERLEAVE2(a1,a2).1", &u);
+  for (j=0; j < SIMD_SZ; ++j) {
+    assert(t.f[j] == (pffft_float)(SIMD_SZ + 2*j) && u.f[j] == (pffft_float)(SIMD_SZ + 2*j + 1));
+  }
+
+  t.v = LD_PS1(a[1].f[SIMD_SZ-1]);
+  print_v4sf("LD_PS1(a1[last])", &t);
+  for (j=0; j < SIMD_SZ; ++j) assert(t.f[j] == a[1].f[SIMD_SZ-1]);
+  t.v = VREV(a[1].v);
+  print_v4sf("VREV(a1)", &t);
+  for (j=0; j < SIMD_SZ; ++j) assert(t.f[j] == a[1].f[SIMD_SZ-1-j]);
+  INTERLEAVE2_REV(a[1].v, a[2].v, t.v, u.v);
+  print_v4sf("INTERLEAVE2_REV(a1,a2).0", &t); print_v4sf("INTERLEAVE2_REV(a1,a2).1", &u);
+  for (j=0; j < SIMD_SZ/2; ++j) {
+    assert(t.f[2*j] == a[1].f[SIMD_SZ-1-j] && t.f[2*j+1] == a[2].f[SIMD_SZ-1-j]);
+    assert(u.f[2*j] == a[1].f[SIMD_SZ/2-1-j] && u.f[2*j+1] == a[2].f[SIMD_SZ/2-1-j]);
+  }
+  UNINTERLEAVE2_REV(a[1].v, a[2].v, t.v, u.v);
+  print_v4sf("UNINTERLEAVE2_REV(a1,a2).0", &t); print_v4sf("UNINTERLEAVE2_REV(a1,a2).1", &u);
+  for (j=0; j < SIMD_SZ; ++j) {
+    assert(t.f[j] == (pffft_float)(3*SIMD_SZ - 2 - 2*j) && u.f[j] == (pffft_float)(3*SIMD_SZ - 1 - 2*j));
+  }
+  /* the fused load/store versions must match the register ones, a[1..2] being contiguous */
+  {
+    v4sf_union s[2];
+    VSTOREU_INTERLEAVE2(s[0].f, a[1].v, a[2].v);
+    INTERLEAVE2(a[1].v, a[2].v, t.v, u.v);
+    for (j=0; j < SIMD_SZ; ++j) assert(s[0].f[j] == t.f[j] && s[1].f[j] == u.f[j]);
+    VSTOREU_INTERLEAVE2_REV(s[0].f, a[1].v, a[2].v);
+    INTERLEAVE2_REV(a[1].v, a[2].v, t.v, u.v);
+    for (j=0; j < SIMD_SZ; ++j) assert(s[0].f[j] == t.f[j] && s[1].f[j] == u.f[j]);
+    VLOADU_UNINTERLEAVE2(a[1].f, s[0].v, s[1].v);
+    UNINTERLEAVE2(a[1].v, a[2].v, t.v, u.v);
+    for (j=0; j < SIMD_SZ; ++j) assert(s[0].f[j] == t.f[j] && s[1].f[j] == u.f[j]);
+    VLOADU_UNINTERLEAVE2_REV(a[1].f, s[0].v, s[1].v);
+    UNINTERLEAVE2_REV(a[1].v, a[2].v, t.v, u.v);
+    for (j=0; j < SIMD_SZ; ++j) assert(s[0].f[j] == t.f[j] && s[1].f[j] == u.f[j]);
+    printf("VSTOREU_INTERLEAVE2 / VLOADU_UNINTERLEAVE2 (+_REV) OK\n");
+  }
+  t.v = VSETLANE0(a[1].v, a[2].f[0]);
+  print_v4sf("VSETLANE0(a1,a2[0])", &t);
+  for (j=0; j < SIMD_SZ; ++j) assert(t.f[j] == (j ? a[1].f[j] : a[2].f[0]));
+#ifdef VLOAD_PARTIAL
+  t.v = VLOAD_PARTIAL(a[1].f, SIMD_SZ-1);
+  print_v4sf("VLOAD_PARTIAL(a1,SIMD_SZ-1)", &t);
+  for (j=0; j < SIMD_SZ; ++j) assert(t.f[j] == (j < SIMD_SZ-1 ? a[1].f[j] : 0.f));
+#endif
+  {
+    v4sf x[SIMD_SZ];
+    for (i=0; i < SIMD_SZ; ++i) x[i] = a[i].v;
+    VTRANSPOSE(x);
+    for (i=0; i < SIMD_SZ; ++i) {
+      t.v = x[i];
+      print_v4sf("VTRANSPOSE", &t);
+      for (j=0; j < SIMD_SZ; ++j) assert(t.f[j] == a[j].f[i]);
+    }
+  }
+}
+#endif // SIMD_SZ != 4
+
+#endif //!PFFFT_SIMD_DISABLE
+
+/*
+  passf2 and passb2 has been merged here, fsign = -1 for passf2, +1 for passb2
+*/
+static NEVER_INLINE(void) passf2_ps(int ido, int l1, const v4sf *cc, v4sf *ch, const pffft_float *wa1, pffft_float fsign) {
+  int k, i;
+  int l1ido = l1*ido;
+  if (ido <= 2) {
+    for (k=0; k < l1ido; k += ido, ch += ido, cc+= 2*ido) {
+      ch[0]         = VADD(cc[0], cc[ido+0]);
+      ch[l1ido]     = VSUB(cc[0], cc[ido+0]);
+      ch[1]         = VADD(cc[1], cc[ido+1]);
+      ch[l1ido + 1] = VSUB(cc[1], cc[ido+1]);
+    }
+  } else {
+    for (k=0; k < l1ido; k += ido, ch += ido, cc += 2*ido) {
+      for (i=0; i<ido-1; i+=2) {
+        v4sf tr2 = VSUB(cc[i+0], cc[i+ido+0]);
+        v4sf ti2 = VSUB(cc[i+1], cc[i+ido+1]);
+        v4sf wr = LD_PS1(wa1[i]), wi = VMUL(LD_PS1(fsign), LD_PS1(wa1[i+1]));
+        ch[i]   = VADD(cc[i+0], cc[i+ido+0]);
+        ch[i+1] = VADD(cc[i+1], cc[i+ido+1]);
+        VCPLXMUL(tr2, ti2, wr, wi);
+        ch[i+l1ido]   = tr2;
+        ch[i+l1ido+1] = ti2;
+      }
+    }
+  }
+}
+
+/*
+  passf3 and passb3 has been merged here, fsign = -1 for passf3, +1 for passb3
+*/
+static NEVER_INLINE(void) passf3_ps(int ido, int l1, const v4sf *cc, v4sf *ch,
+                                    const pffft_float *wa1, const pffft_float *wa2, pffft_float fsign) {
+  static const pffft_float taur = -0.5;
+  pffft_float taui = 0.86602540378443865*fsign;
+  int i, k;
+  v4sf tr2, ti2, cr2, ci2, cr3, ci3, dr2, di2, dr3, di3;
+  int l1ido = l1*ido;
+  pffft_float wr1, wi1, wr2, wi2;
+  assert(ido >= 2);
+  for (k=0; k< l1ido; k += ido, cc+= 3*ido, ch +=ido) {
+    for (i=0; i<ido-1; i+=2) {
+      tr2 = VADD(cc[i+ido], cc[i+2*ido]);
+      cr2 = VADD(cc[i], SVMUL(taur,tr2));
+      ch[i]    = VADD(cc[i], tr2);
+      ti2 = VADD(cc[i+ido+1], cc[i+2*ido+1]);
+      ci2 = VADD(cc[i    +1], SVMUL(taur,ti2));
+      ch[i+1]  = VADD(cc[i+1], ti2);
+      cr3 = SVMUL(taui, VSUB(cc[i+ido], cc[i+2*ido]));
+      ci3 = SVMUL(taui, VSUB(cc[i+ido+1], cc[i+2*ido+1]));
+      dr2 = VSUB(cr2, ci3);
+      dr3 = VADD(cr2, ci3);
+      di2 = VADD(ci2, cr3);
+      di3 = VSUB(ci2, cr3);
+      wr1=wa1[i], wi1=fsign*wa1[i+1], wr2=wa2[i], wi2=fsign*wa2[i+1]; 
+      VCPLXMUL(dr2, di2, LD_PS1(wr1), LD_PS1(wi1));
+      ch[i+l1ido] = dr2; 
+      ch[i+l1ido + 1] = di2;
+      VCPLXMUL(dr3, di3, LD_PS1(wr2), LD_PS1(wi2));
+      ch[i+2*l1ido] = dr3;
+      ch[i+2*l1ido+1] = di3;
+    }
+  }
+} /* passf3 */
+
+static NEVER_INLINE(void) passf4_ps(int ido, int l1, const v4sf *cc, v4sf *ch,
+                                    const pffft_float *wa1, const pffft_float *wa2, const pffft_float *wa3, pffft_float fsign) {
+  /* isign == -1 for forward transform and +1 for backward transform */
+
+  int i, k;
+  v4sf ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
+  v4sf vsign = LD_PS1(fsign);
+  int l1ido = l1*ido;
+  /* the multiplications by fsign (+/-1, hence exact) are folded into the
+     butterflies as multiply-adds */
+  if (ido == 2) {
+    for (k=0; k < l1ido; k += ido, ch += ido, cc += 4*ido) {
+      tr1 = VSUB(cc[0], cc[2*ido + 0]);
+      tr2 = VADD(cc[0], cc[2*ido + 0]);
+      ti1 = VSUB(cc[1], cc[2*ido + 1]);
+      ti2 = VADD(cc[1], cc[2*ido + 1]);
+      ti4 = VSUB(cc[1*ido + 0], cc[3*ido + 0]);
+      tr4 = VSUB(cc[3*ido + 1], cc[1*ido + 1]);
+      tr3 = VADD(cc[ido + 0], cc[3*ido + 0]);
+      ti3 = VADD(cc[ido + 1], cc[3*ido + 1]);
+
+      ch[0*l1ido + 0] = VADD(tr2, tr3);
+      ch[0*l1ido + 1] = VADD(ti2, ti3);
+      ch[1*l1ido + 0] = VMADD(vsign, tr4, tr1);
+      ch[1*l1ido + 1] = VMADD(vsign, ti4, ti1);
+      ch[2*l1ido + 0] = VSUB(tr2, tr3);
+      ch[2*l1ido + 1] = VSUB(ti2, ti3);        
+      ch[3*l1ido + 0] = VNMADD(vsign, tr4, tr1);
+      ch[3*l1ido + 1] = VNMADD(vsign, ti4, ti1);
+    }
+  } else {
+    for (k=0; k < l1ido; k += ido, ch+=ido, cc += 4*ido) {
+      for (i=0; i<ido-1; i+=2) {
+        pffft_float wr1, wi1, wr2, wi2, wr3, wi3;
+        tr1 = VSUB(cc[i + 0], cc[i + 2*ido + 0]);
+        tr2 = VADD(cc[i + 0], cc[i + 2*ido + 0]);
+        ti1 = VSUB(cc[i + 1], cc[i + 2*ido + 1]);
+        ti2 = VADD(cc[i + 1], cc[i + 2*ido + 1]);
+        tr4 = VSUB(cc[i + 3*ido + 1], cc[i + 1*ido + 1]);
+        ti4 = VSUB(cc[i + 1*ido + 0], cc[i + 3*ido + 0]);
+        tr3 = VADD(cc[i + ido + 0], cc[i + 3*ido + 0]);
+        ti3 = VADD(cc[i + ido + 1], cc[i + 3*ido + 1]);
+
+        ch[i] = VADD(tr2, tr3);
+        cr3    = VSUB(tr2, tr3);
+        ch[i + 1] = VADD(ti2, ti3);
+        ci3 = VSUB(ti2, ti3);
+
+        cr2 = VMADD(vsign, tr4, tr1);
+        cr4 = VNMADD(vsign, tr4, tr1);
+        ci2 = VMADD(vsign, ti4, ti1);
+        ci4 = VNMADD(vsign, ti4, ti1);
+        wr1=wa1[i], wi1=fsign*wa1[i+1];
+        VCPLXMUL(cr2, ci2, LD_PS1(wr1), LD_PS1(wi1));
+        wr2=wa2[i], wi2=fsign*wa2[i+1]; 
+        ch[i + l1ido] = cr2;
+        ch[i + l1ido + 1] = ci2;
+
+        VCPLXMUL(cr3, ci3, LD_PS1(wr2), LD_PS1(wi2));
+        wr3=wa3[i], wi3=fsign*wa3[i+1]; 
+        ch[i + 2*l1ido] = cr3;
+        ch[i + 2*l1ido + 1] = ci3;
+
+        VCPLXMUL(cr4, ci4, LD_PS1(wr3), LD_PS1(wi3));
+        ch[i + 3*l1ido] = cr4;
+        ch[i + 3*l1ido + 1] = ci4;
+      }
+    }
+  }
+} /* passf4 */
+
+/*
+  passf5 and passb5 has been merged here, fsign = -1 for passf5, +1 for passb5
+*/
+static NEVER_INLINE(void) passf5_ps(int ido, int l1, const v4sf *cc, v4sf *ch,
+                                    const pffft_float *wa1, const pffft_float *wa2, 
+                                    const pffft_float *wa3, const pffft_float *wa4, pffft_float fsign) {  
+  static const pffft_float tr11 = .30901699437494742;
+  const pffft_float ti11 = .95105651629515357*fsign;
+  static const pffft_float tr12 = -.80901699437494742;
+  const pffft_float ti12 = .58778525229247313*fsign;
+
+  /* Local variables */
+  int i, k;
+  v4sf ci2, ci3, ci4, ci5, di3, di4, di5, di2, cr2, cr3, cr5, cr4, ti2, ti3,
+    ti4, ti5, dr3, dr4, dr5, dr2, tr2, tr3, tr4, tr5;
+
+  pffft_float wr1, wi1, wr2, wi2, wr3, wi3, wr4, wi4;
+
+#define cc_ref(a_1,a_2) cc[(a_2-1)*ido + a_1 + 1]
+#define ch_ref(a_1,a_3) ch[(a_3-1)*l1*ido + a_1 + 1]
+
+  assert(ido >= 2);
+  for (k = 0; k < l1; ++k, cc += 5*ido, ch += ido) {
+    for (i = 0; i < ido-1; i += 2) {
+      ti5 = VSUB(cc_ref(i  , 2), cc_ref(i  , 5));
+      ti2 = VADD(cc_ref(i  , 2), cc_ref(i  , 5));
+      ti4 = VSUB(cc_ref(i  , 3), cc_ref(i  , 4));
+      ti3 = VADD(cc_ref(i  , 3), cc_ref(i  , 4));
+      tr5 = VSUB(cc_ref(i-1, 2), cc_ref(i-1, 5));
+      tr2 = VADD(cc_ref(i-1, 2), cc_ref(i-1, 5));
+      tr4 = VSUB(cc_ref(i-1, 3), cc_ref(i-1, 4));
+      tr3 = VADD(cc_ref(i-1, 3), cc_ref(i-1, 4));
+      ch_ref(i-1, 1) = VADD(cc_ref(i-1, 1), VADD(tr2, tr3));
+      ch_ref(i  , 1) = VADD(cc_ref(i  , 1), VADD(ti2, ti3));
+      cr2 = VADD(cc_ref(i-1, 1), VADD(SVMUL(tr11, tr2),SVMUL(tr12, tr3)));
+      ci2 = VADD(cc_ref(i  , 1), VADD(SVMUL(tr11, ti2),SVMUL(tr12, ti3)));
+      cr3 = VADD(cc_ref(i-1, 1), VADD(SVMUL(tr12, tr2),SVMUL(tr11, tr3)));
+      ci3 = VADD(cc_ref(i  , 1), VADD(SVMUL(tr12, ti2),SVMUL(tr11, ti3)));
+      cr5 = VADD(SVMUL(ti11, tr5), SVMUL(ti12, tr4));
+      ci5 = VADD(SVMUL(ti11, ti5), SVMUL(ti12, ti4));
+      cr4 = VSUB(SVMUL(ti12, tr5), SVMUL(ti11, tr4));
+      ci4 = VSUB(SVMUL(ti12, ti5), SVMUL(ti11, ti4));
+      dr3 = VSUB(cr3, ci4);
+      dr4 = VADD(cr3, ci4);
+      di3 = VADD(ci3, cr4);
+      di4 = VSUB(ci3, cr4);
+      dr5 = VADD(cr2, ci5);
+      dr2 = VSUB(cr2, ci5);
+      di5 = VSUB(ci2, cr5);
+      di2 = VADD(ci2, cr5);
+      wr1=wa1[i], wi1=fsign*wa1[i+1], wr2=wa2[i], wi2=fsign*wa2[i+1]; 
+      wr3=wa3[i], wi3=fsign*wa3[i+1], wr4=wa4[i], wi4=fsign*wa4[i+1]; 
+      VCPLXMUL(dr2, di2, LD_PS1(wr1), LD_PS1(wi1));
+      ch_ref(i - 1, 2) = dr2;
+      ch_ref(i, 2)     = di2;
+      VCPLXMUL(dr3, di3, LD_PS1(wr2), LD_PS1(wi2));
+      ch_ref(i - 1, 3) = dr3;
+      ch_ref(i, 3)     = di3;
+      VCPLXMUL(dr4, di4, LD_PS1(wr3), LD_PS1(wi3));
+      ch_ref(i - 1, 4) = dr4;
+      ch_ref(i, 4)     = di4;
+      VCPLXMUL(dr5, di5, LD_PS1(wr4), LD_PS1(wi4));
+      ch_ref(i - 1, 5) = dr5;
+      ch_ref(i, 5)     = di5;
+    }
+  }
+#undef ch_ref
+#undef cc_ref
+}
+
+/*
+  odd prime radix passes, for the factors that are not handled by the
+  passes above. For a radix ip, with s[j] = x[j] + x[ip-j] and
+  d[j] = x[j] - x[ip-j], the outputs y[m] and y[ip-m] are
+  a[m] +/- i*b[m], where a[m] = x[0] + sum_j cos(2*pi*j*m/ip)*s[j] and
+  b[m] = sum_j sin(2*pi*j*m/ip)*d[j]: this takes (ip-1)^2/2 complex
+  multiplications by a real constant instead of (ip-1)^2.
+
+  The radix 7, 11 and 13 passes are the same code specialized for a
+  constant radix (which lets the compiler unroll the loops over j and m),
+  the other primes up to PFFFT_MAX_RADIX go through the generic version.
+*/
+#define PFFFT_MAX_RADIX 31
+
+/* cos and sin of 2*pi*a/n, computed in double precision (a being reduced
+   modulo n first, so that the angle is exact up to its last rounding) and
+   rounded once to pffft_float */
+static void trig_angle(long long a, int n, pffft_float *c, pffft_float *s) {
+  double A = 2*M_PI*(double)(a % n)/n;
+  *c = (pffft_float)cos(A);
+  *s = (pffft_float)sin(A);
+}
+
+/* cos(2*pi*j/ip), sign*sin(2*pi*j/ip) for j in [0, ip) (ip odd). This
+   runs for each pass, so the first half comes from a recurrence in double
+   precision (whose error stays far below the final rounding), and the
+   second half by symmetry */
+static void radix_trig(int ip, pffft_float *wc, pffft_float *ws, pffft_float sign) {
+  double c1 = cos(2*M_PI/ip), s1 = sin(2*M_PI/ip), c = 1, s = 0, t;
+  int j;
+  wc[0] = 1;
+  ws[0] = 0;
+  for (j=1; 2*j < ip; ++j) {
+    t = c*c1 - s*s1;
+    s = c*s1 + s*c1;
+    c = t;
+    wc[j] = (pffft_float)c;
+    ws[j] = (pffft_float)(sign*s);
+    wc[ip - j] = wc[j];
+    ws[ip - j] = -ws[j];
+  }
+}
+
+/*
+  passfp and passbp merged, fsign = -1 for the forward transform, +1 for the backward one
+*/
+static ALWAYS_INLINE(void) passfp_ps(int ido, int l1, int ip, const v4sf *cc, v4sf *ch, const pffft_float *wa, pffft_float fsign) {
+  pffft_float wc[PFFFT_MAX_RADIX], ws[PFFFT_MAX_RADIX];
+  int i, j, k, m, iph = ip/2;
+  int l1ido = l1*ido;
+  radix_trig(ip, wc, ws, fsign);
+  for (k=0; k < l1ido; k += ido, cc += ip*ido, ch += ido) {
+    for (i=0; i < ido-1; i += 2) {
+      v4sf sr[PFFFT_MAX_RADIX/2+1], si[PFFFT_MAX_RADIX/2+1], dr[PFFFT_MAX_RADIX/2+1], di[PFFFT_MAX_RADIX/2+1];
+      v4sf yr = cc[i], yi = cc[i+1];
+      for (j=1; j <= iph; ++j) {
+        sr[j] = VADD(cc[i + j*ido], cc[i + (ip-j)*ido]);
+        si[j] = VADD(cc[i + j*ido + 1], cc[i + (ip-j)*ido + 1]);
+        dr[j] = VSUB(cc[i + j*ido], cc[i + (ip-j)*ido]);
+        di[j] = VSUB(cc[i + j*ido + 1], cc[i + (ip-j)*ido + 1]);
+        yr = VADD(yr, sr[j]);
+        yi = VADD(yi, si[j]);
+      }
+      ch[i]   = yr;
+      ch[i+1] = yi;
+      for (m=1; m <= iph; ++m) {
+        v4sf ar = cc[i], ai = cc[i+1], br = VZERO(), bi = VZERO();
+        v4sf zr, zi;
+        int jm = 0;
+        /* LD_PS1 takes the address of its argument with neon and altivec */
+        pffft_float w1r = wa[(m-1)*ido + i], w1i = fsign*wa[(m-1)*ido + i+1];
+        pffft_float w2r = wa[(ip-m-1)*ido + i], w2i = fsign*wa[(ip-m-1)*ido + i+1];
+        for (j=1; j <= iph; ++j) {
+          jm += m; if (jm >= ip) jm -= ip; // (j*m) % ip
+          ar = VMADD(LD_PS1(wc[jm]), sr[j], ar);
+          ai = VMADD(LD_PS1(wc[jm]), si[j], ai);
+          br = VMADD(LD_PS1(ws[jm]), dr[j], br);
+          bi = VMADD(LD_PS1(ws[jm]), di[j], bi);
+        }
+        zr = VSUB(ar, bi); zi = VADD(ai, br);
+        VCPLXMUL(zr, zi, LD_PS1(w1r), LD_PS1(w1i));
+        ch[i + m*l1ido]   = zr;
+        ch[i + m*l1ido+1] = zi;
+        zr = VADD(ar, bi); zi = VSUB(ai, br);
+        VCPLXMUL(zr, zi, LD_PS1(w2r), LD_PS1(w2i));
+        ch[i + (ip-m)*l1ido]   = zr;
+        ch[i + (ip-m)*l1ido+1] = zi;
+      }
+    }
+  }
+}
+
+static NEVER_INLINE(void) passfg_ps(int ido, int l1, int ip, const v4sf *cc, v4sf *ch, const pffft_float *wa, pffft_float fsign) {
+  assert(ip <= PFFFT_MAX_RADIX && (ip & 1));
+  switch (ip) {
+    case 7:  passfp_ps(ido, l1, 7, cc, ch, wa, fsign); break;
+    case 11: passfp_ps(ido, l1, 11, cc, ch, wa, fsign); break;
+    case 13: passfp_ps(ido, l1, 13, cc, ch, wa, fsign); break;
+    default: passfp_ps(ido, l1, ip, cc, ch, wa, fsign); break;
+  }
+}
+
+static NEVER_INLINE(void) radf2_ps(int ido, int l1, const v4sf * RESTRICT cc, v4sf * RESTRICT ch, const pffft_float *wa1) {
+  static const pffft_float minus_one = -1;
+  int i, k, l1ido = l1*ido;
+  for (k=0; k < l1ido; k += ido) {
+    v4sf a = cc[k], b = cc[k + l1ido];
+    ch[2*k] = VADD(a, b);
+    ch[2*(k+ido)-1] = VSUB(a, b);
+  }
+  if (ido < 2) return;
+  if (ido != 2) {
+    for (k=0; k < l1ido; k += ido) {
+      for (i=2; i<ido; i+=2) {
+        v4sf tr2 = cc[i - 1 + k + l1ido], ti2 = cc[i + k + l1ido];
+        v4sf br = cc[i - 1 + k], bi = cc[i + k];
+        VCPLXMULCONJ(tr2, ti2, LD_PS1(wa1[i - 2]), LD_PS1(wa1[i - 1])); 
+        ch[i + 2*k] = VADD(bi, ti2);
+        ch[2*(k+ido) - i] = VSUB(ti2, bi);
+        ch[i - 1 + 2*k] = VADD(br, tr2);
+        ch[2*(k+ido) - i -1] = VSUB(br, tr2);
+      }
+    }
+    if (ido % 2 == 1) return;
+  }
+  for (k=0; k < l1ido; k += ido) {
+    ch[2*k + ido] = SVMUL(minus_one, cc[ido-1 + k + l1ido]);
+    ch[2*k + ido-1] = cc[k + ido-1];
+  }
+} /* radf2 */
+
+
+static NEVER_INLINE(void) radb2_ps(int ido, int l1, const v4sf *cc, v4sf *ch, const pffft_float *wa1) {
+  static const pffft_float minus_two=-2;
+  int i, k, l1ido = l1*ido;
+  v4sf a,b,c,d, tr2, ti2;
+  for (k=0; k < l1ido; k += ido) {
+    a = cc[2*k]; b = cc[2*(k+ido) - 1];
+    ch[k] = VADD(a, b);
+    ch[k + l1ido] =VSUB(a, b);
+  }
+  if (ido < 2) return;
+  if (ido != 2) {
+    for (k = 0; k < l1ido; k += ido) {
+      for (i = 2; i < ido; i += 2) {
+        a = cc[i-1 + 2*k]; b = cc[2*(k + ido) - i - 1];
+        c = cc[i+0 + 2*k]; d = cc[2*(k + ido) - i + 0];
+        ch[i-1 + k] = VADD(a, b);
+        tr2 = VSUB(a, b);
+        ch[i+0 + k] = VSUB(c, d);
+        ti2 = VADD(c, d);
+        VCPLXMUL(tr2, ti2, LD_PS1(wa1[i - 2]), LD_PS1(wa1[i - 1]));
+        ch[i-1 + k + l1ido] = tr2;
+        ch[i+0 + k + l1ido] = ti2;
+      }
+    }
+    if (ido % 2 == 1) return;
+  }
+  for (k = 0; k < l1ido; k += ido) {
+    a = cc[2*k + ido-1]; b = cc[2*k + ido];
+    ch[k + ido-1] = VADD(a,a);
+    ch[k + ido-1 + l1ido] = SVMUL(minus_two, b);
+  }
+} /* radb2 */
+
+static void radf3_ps(int ido, int l1, const v4sf * RESTRICT cc, v4sf * RESTRICT ch,
+                     const pffft_float *wa1, const pffft_float *wa2) {
+  static const pffft_float taur = -0.5;
+  static const pffft_float taui = 0.86602540378443865;
+  int i, k, ic;
+  v4sf ci2, di2, di3, cr2, dr2, dr3, ti2, ti3, tr2, tr3, wr1, wi1, wr2, wi2;
+  for (k=0; k<l1; k++) {
+    cr2 = VADD(cc[(k + l1)*ido], cc[(k + 2*l1)*ido]);
+    ch[3*k*ido] = VADD(cc[k*ido], cr2);
+    ch[(3*k+2)*ido] = SVMUL(taui, VSUB(cc[(k + l1*2)*ido], cc[(k + l1)*ido]));
+    ch[ido-1 + (3*k + 1)*ido] = VADD(cc[k*ido], SVMUL(taur, cr2));
+  }
+  if (ido == 1) return;
+  for (k=0; k<l1; k++) {
+    for (i=2; i<ido; i+=2) {
+      ic = ido - i;
+      wr1 = LD_PS1(wa1[i - 2]); wi1 = LD_PS1(wa1[i - 1]);
+      dr2 = cc[i - 1 + (k + l1)*ido]; di2 = cc[i + (k + l1)*ido];
+      VCPLXMULCONJ(dr2, di2, wr1, wi1);
+
+      wr2 = LD_PS1(wa2[i - 2]); wi2 = LD_PS1(wa2[i - 1]);
+      dr3 = cc[i - 1 + (k + l1*2)*ido]; di3 = cc[i + (k + l1*2)*ido];
+      VCPLXMULCONJ(dr3, di3, wr2, wi2);
+        
+      cr2 = VADD(dr2, dr3);
+      ci2 = VADD(di2, di3);
+      ch[i - 1 + 3*k*ido] = VADD(cc[i - 1 + k*ido], cr2);
+      ch[i + 3*k*ido] = VADD(cc[i + k*ido], ci2);
+      tr2 = VADD(cc[i - 1 + k*ido], SVMUL(taur, cr2));
+      ti2 = VADD(cc[i + k*ido], SVMUL(taur, ci2));
+      tr3 = SVMUL(taui, VSUB(di2, di3));
+      ti3 = SVMUL(taui, VSUB(dr3, dr2));
+      ch[i - 1 + (3*k + 2)*ido] = VADD(tr2, tr3);
+      ch[ic - 1 + (3*k + 1)*ido] = VSUB(tr2, tr3);
+      ch[i + (3*k + 2)*ido] = VADD(ti2, ti3);
+      ch[ic + (3*k + 1)*ido] = VSUB(ti3, ti2);
+    }
+  }
+} /* radf3 */
+
+
+static void radb3_ps(int ido, int l1, const v4sf *RESTRICT cc, v4sf *RESTRICT ch,
+                     const pffft_float *wa1, const pffft_float *wa2)
+{
+  static const pffft_float taur = -0.5;
+  static const pffft_float taui = 0.86602540378443865;
+  static const pffft_float taui_2 = 0.86602540378443865*2;
+  int i, k, ic;
+  v4sf ci2, ci3, di2, di3, cr2, cr3, dr2, dr3, ti2, tr2;
+  for (k=0; k<l1; k++) {
+    tr2 = cc[ido-1 + (3*k + 1)*ido]; tr2 = VADD(tr2,tr2);
+    cr2 = VMADD(LD_PS1(taur), tr2, cc[3*k*ido]);
+    ch[k*ido] = VADD(cc[3*k*ido], tr2);
+    ci3 = SVMUL(taui_2, cc[(3*k + 2)*ido]);
+    ch[(k + l1)*ido] = VSUB(cr2, ci3);
+    ch[(k + 2*l1)*ido] = VADD(cr2, ci3);
+  }
+  if (ido == 1) return;
+  for (k=0; k<l1; k++) {
+    for (i=2; i<ido; i+=2) {
+      ic = ido - i;
+      tr2 = VADD(cc[i - 1 + (3*k + 2)*ido], cc[ic - 1 + (3*k + 1)*ido]);
+      cr2 = VMADD(LD_PS1(taur), tr2, cc[i - 1 + 3*k*ido]);
+      ch[i - 1 + k*ido] = VADD(cc[i - 1 + 3*k*ido], tr2);
+      ti2 = VSUB(cc[i + (3*k + 2)*ido], cc[ic + (3*k + 1)*ido]);
+      ci2 = VMADD(LD_PS1(taur), ti2, cc[i + 3*k*ido]);
+      ch[i + k*ido] = VADD(cc[i + 3*k*ido], ti2);
+      cr3 = SVMUL(taui, VSUB(cc[i - 1 + (3*k + 2)*ido], cc[ic - 1 + (3*k + 1)*ido]));
+      ci3 = SVMUL(taui, VADD(cc[i + (3*k + 2)*ido], cc[ic + (3*k + 1)*ido]));
+      dr2 = VSUB(cr2, ci3);
+      dr3 = VADD(cr2, ci3);
+      di2 = VADD(ci2, cr3);
+      di3 = VSUB(ci2, cr3);
+      VCPLXMUL(dr2, di2, LD_PS1(wa1[i-2]), LD_PS1(wa1[i-1]));
+      ch[i - 1 + (k + l1)*ido] = dr2;
+      ch[i + (k + l1)*ido] = di2;
+      VCPLXMUL(dr3, di3, LD_PS1(wa2[i-2]), LD_PS1(wa2[i-1]));
+      ch[i - 1 + (k + 2*l1)*ido] = dr3;
+      ch[i + (k + 2*l1)*ido] = di3;
+    }
+  }
+} /* radb3 */
+
+static NEVER_INLINE(void) radf4_ps(int ido, int l1, const v4sf *RESTRICT cc, v4sf * RESTRICT ch,
+                                   const pffft_float * RESTRICT wa1, const pffft_float * RESTRICT wa2, const pffft_float * RESTRICT wa3)
+{
+  static const pffft_float minus_hsqt2 = (pffft_float)-0.70710678118654752;
+  int i, k, l1ido = l1*ido;
+  {
+    const v4sf *RESTRICT cc_ = cc, * RESTRICT cc_end = cc + l1ido; 
+    v4sf * RESTRICT ch_ = ch;
+    while (cc < cc_end) {
+      // this loop represents between 25% and 40% of total radf4_ps cost !
+      v4sf a0 = cc[0], a1 = cc[l1ido];
+      v4sf a2 = cc[2*l1ido], a3 = cc[3*l1ido];
+      v4sf tr1 = VADD(a1, a3);
+      v4sf tr2 = VADD(a0, a2);
+      ch[2*ido-1] = VSUB(a0, a2);
+      ch[2*ido  ] = VSUB(a3, a1);
+      ch[0      ] = VADD(tr1, tr2);
+      ch[4*ido-1] = VSUB(tr2, tr1);
+      cc += ido; ch += 4*ido;
+    }
+    cc = cc_; ch = ch_;
+  }
+  if (ido < 2) return;
+  if (ido != 2) {
+    for (k = 0; k < l1ido; k += ido) {
+      const v4sf * RESTRICT pc = (v4sf*)(cc + 1 + k);
+      for (i=2; i<ido; i += 2, pc += 2) {
+        int ic = ido - i;
+        v4sf wr, wi, cr2, ci2, cr3, ci3, cr4, ci4;
+        v4sf tr1, ti1, tr2, ti2, tr3, ti3, tr4, ti4;
+
+        cr2 = pc[1*l1ido+0];
+        ci2 = pc[1*l1ido+1];
+        wr=LD_PS1(wa1[i - 2]);
+        wi=LD_PS1(wa1[i - 1]);
+        VCPLXMULCONJ(cr2,ci2,wr,wi);
+
+        cr3 = pc[2*l1ido+0];
+        ci3 = pc[2*l1ido+1];
+        wr = LD_PS1(wa2[i-2]); 
+        wi = LD_PS1(wa2[i-1]);
+        VCPLXMULCONJ(cr3, ci3, wr, wi);
+
+        cr4 = pc[3*l1ido];
+        ci4 = pc[3*l1ido+1];
+        wr = LD_PS1(wa3[i-2]); 
+        wi = LD_PS1(wa3[i-1]);
+        VCPLXMULCONJ(cr4, ci4, wr, wi);
+
+        /* at this point, on SSE, five of "cr2 cr3 cr4 ci2 ci3 ci4" should be loaded in registers */
+
+        tr1 = VADD(cr2,cr4);
+        tr4 = VSUB(cr4,cr2); 
+        tr2 = VADD(pc[0],cr3);
+        tr3 = VSUB(pc[0],cr3);
+        ch[i - 1 + 4*k] = VADD(tr1,tr2);
+        ch[ic - 1 + 4*k + 3*ido] = VSUB(tr2,tr1); // at this point tr1 and tr2 can be disposed
+        ti1 = VADD(ci2,ci4);
+        ti4 = VSUB(ci2,ci4);
+        ch[i - 1 + 4*k + 2*ido] = VADD(ti4,tr3);
+        ch[ic - 1 + 4*k + 1*ido] = VSUB(tr3,ti4); // dispose tr3, ti4
+        ti2 = VADD(pc[1],ci3);
+        ti3 = VSUB(pc[1],ci3);
+        ch[i + 4*k] = VADD(ti1, ti2);
+        ch[ic + 4*k + 3*ido] = VSUB(ti1, ti2);
+        ch[i + 4*k + 2*ido] = VADD(tr4, ti3);
+        ch[ic + 4*k + 1*ido] = VSUB(tr4, ti3);
+      }
+    }
+    if (ido % 2 == 1) return;
+  }
+  for (k=0; k<l1ido; k += ido) {
+    v4sf a = cc[ido-1 + k + l1ido], b = cc[ido-1 + k + 3*l1ido];
+    v4sf c = cc[ido-1 + k], d = cc[ido-1 + k + 2*l1ido];
+    v4sf s = VADD(a, b), t = VSUB(b, a), h = LD_PS1(minus_hsqt2);
+    ch[ido-1 + 4*k] = VMADD(h, t, c);
+    ch[ido-1 + 4*k + 2*ido] = VNMADD(h, t, c);
+    ch[4*k + 1*ido] = VMSUB(h, s, d); 
+    ch[4*k + 3*ido] = VMADD(h, s, d); 
+  }
+} /* radf4 */
+
+
+static NEVER_INLINE(void) radb4_ps(int ido, int l1, const v4sf * RESTRICT cc, v4sf * RESTRICT ch,
+                                   const pffft_float * RESTRICT wa1, const pffft_float * RESTRICT wa2, const pffft_float *RESTRICT wa3)
+{
+  static const pffft_float minus_sqrt2 = (pffft_float)-1.4142135623730950;
+  static const pffft_float two = 2;
+  int i, k, l1ido = l1*ido;
+  v4sf ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
+  {
+    const v4sf *RESTRICT cc_ = cc, * RESTRICT ch_end = ch + l1ido; 
+    v4sf *ch_ = ch;
+    while (ch < ch_end) {
+      v4sf a = cc[0], b = cc[4*ido-1];
+      v4sf c = cc[2*ido], d = cc[2*ido-1];
+      tr2 = VADD(a,b);
+      tr1 = VSUB(a,b);
+      ch[0*l1ido] = VMADD(LD_PS1(two), d, tr2);
+      ch[2*l1ido] = VNMADD(LD_PS1(two), d, tr2);
+      ch[1*l1ido] = VNMADD(LD_PS1(two), c, tr1);
+      ch[3*l1ido] = VMADD(LD_PS1(two), c, tr1);
+      
+      cc += 4*ido; ch += ido;
+    }
+    cc = cc_; ch = ch_;
+  }
+  if (ido < 2) return;
+  if (ido != 2) {
+    for (k = 0; k < l1ido; k += ido) {
+      const v4sf * RESTRICT pc = (v4sf*)(cc - 1 + 4*k);
+      v4sf * RESTRICT ph = (v4sf*)(ch + k + 1);
+      for (i = 2; i < ido; i += 2) {
+
+        tr1 = VSUB(pc[i], pc[4*ido - i]);
+        tr2 = VADD(pc[i], pc[4*ido - i]);
+        ti4 = VSUB(pc[2*ido + i], pc[2*ido - i]);
+        tr3 = VADD(pc[2*ido + i], pc[2*ido - i]);
+        ph[0] = VADD(tr2, tr3);
+        cr3 = VSUB(tr2, tr3);
+
+        ti3 = VSUB(pc[2*ido + i + 1], pc[2*ido - i + 1]);
+        tr4 = VADD(pc[2*ido + i + 1], pc[2*ido - i + 1]);
+        cr2 = VSUB(tr1, tr4);
+        cr4 = VADD(tr1, tr4);
+
+        ti1 = VADD(pc[i + 1], pc[4*ido - i + 1]);
+        ti2 = VSUB(pc[i + 1], pc[4*ido - i + 1]);
+
+        ph[1] = VADD(ti2, ti3); ph += l1ido;
+        ci3 = VSUB(ti2, ti3);
+        ci2 = VADD(ti1, ti4);
+        ci4 = VSUB(ti1, ti4);
+        VCPLXMUL(cr2, ci2, LD_PS1(wa1[i-2]), LD_PS1(wa1[i-1]));
+        ph[0] = cr2;
+        ph[1] = ci2; ph += l1ido;
+        VCPLXMUL(cr3, ci3, LD_PS1(wa2[i-2]), LD_PS1(wa2[i-1]));
+        ph[0] = cr3;
+        ph[1] = ci3; ph += l1ido;
+        VCPLXMUL(cr4, ci4, LD_PS1(wa3[i-2]), LD_PS1(wa3[i-1]));
+        ph[0] = cr4;
+        ph[1] = ci4; ph = ph - 3*l1ido + 2;
+      }
+    }
+    if (ido % 2 == 1) return;
+  }
+  for (k=0; k < l1ido; k+=ido) {
+    int i0 = 4*k + ido;
+    v4sf c = cc[i0-1], d = cc[i0 + 2*ido-1];
+    v4sf a = cc[i0+0], b = cc[i0 + 2*ido+0];
+    tr1 = VSUB(c,d);
+    tr2 = VADD(c,d);
+    ti1 = VADD(b,a);
+    ti2 = VSUB(b,a);
+    ch[ido-1 + k + 0*l1ido] = VADD(tr2,tr2);
+    ch[ido-1 + k + 1*l1ido] = SVMUL(minus_sqrt2, VSUB(ti1, tr1));
+    ch[ido-1 + k + 2*l1ido] = VADD(ti2, ti2);
+    ch[ido-1 + k + 3*l1ido] = SVMUL(minus_sqrt2, VADD(ti1, tr1));
+  }
+} /* radb4 */
+
+static void radf5_ps(int ido, int l1, const v4sf * RESTRICT cc, v4sf * RESTRICT ch, 
+                     const pffft_float *wa1, const pffft_float *wa2, const pffft_float *wa3, const pffft_float *wa4)
+{
+  static const pffft_float tr11 = .30901699437494742;
+  static const pffft_float ti11 = .95105651629515357;
+  static const pffft_float tr12 = -.80901699437494742;
+  static const pffft_float ti12 = .58778525229247313;
+
+  /* System generated locals */
+  int cc_offset, ch_offset;
+
+  /* Local variables */
+  int i, k, ic;
+  v4sf ci2, di2, ci4, ci5, di3, di4, di5, ci3, cr2, cr3, dr2, dr3, dr4, dr5,
+    cr5, cr4, ti2, ti3, ti5, ti4, tr2, tr3, tr4, tr5;
+  int idp2;
+
+
+#define cc_ref(a_1,a_2,a_3) cc[((a_3)*l1 + (a_2))*ido + a_1]
+#define ch_ref(a_1,a_2,a_3) ch[((a_3)*5 + (a_2))*ido + a_1]
+
+  /* Parameter adjustments */
+  ch_offset = 1 + ido * 6;
+  ch -= ch_offset;
+  cc_offset = 1 + ido * (1 + l1);
+  cc -= cc_offset;
+
+  /* Function Body */
+  for (k = 1; k <= l1; ++k) {
+    cr2 = VADD(cc_ref(1, k, 5), cc_ref(1, k, 2));
+    ci5 = VSUB(cc_ref(1, k, 5), cc_ref(1, k, 2));
+    cr3 = VADD(cc_ref(1, k, 4), cc_ref(1, k, 3));
+    ci4 = VSUB(cc_ref(1, k, 4), cc_ref(1, k, 3));
+    ch_ref(1, 1, k) = VADD(cc_ref(1, k, 1), VADD(cr2, cr3));
+    ch_ref(ido, 2, k) = VADD(cc_ref(1, k, 1), VADD(SVMUL(tr11, cr2), SVMUL(tr12, cr3)));
+    ch_ref(1, 3, k) = VADD(SVMUL(ti11, ci5), SVMUL(ti12, ci4));
+    ch_ref(ido, 4, k) = VADD(cc_ref(1, k, 1), VADD(SVMUL(tr12, cr2), SVMUL(tr11, cr3)));
+    ch_ref(1, 5, k) = VSUB(SVMUL(ti12, ci5), SVMUL(ti11, ci4));
+    //printf("pffft: radf5, k=%d ch_ref=%f, ci4=%f\n", k, ch_ref(1, 5, k), ci4);
+  }
+  if (ido == 1) {
+    return;
+  }
+  idp2 = ido + 2;
+  for (k = 1; k <= l1; ++k) {
+    for (i = 3; i <= ido; i += 2) {
+      ic = idp2 - i;
+      dr2 = LD_PS1(wa1[i-3]); di2 = LD_PS1(wa1[i-2]);
+      dr3 = LD_PS1(wa2[i-3]); di3 = LD_PS1(wa2[i-2]);
+      dr4 = LD_PS1(wa3[i-3]); di4 = LD_PS1(wa3[i-2]);
+      dr5 = LD_PS1(wa4[i-3]); di5 = LD_PS1(wa4[i-2]);
+      VCPLXMULCONJ(dr2, di2, cc_ref(i-1, k, 2), cc_ref(i, k, 2));
+      VCPLXMULCONJ(dr3, di3, cc_ref(i-1, k, 3), cc_ref(i, k, 3));
+      VCPLXMULCONJ(dr4, di4, cc_ref(i-1, k, 4), cc_ref(i, k, 4));
+      VCPLXMULCONJ(dr5, di5, cc_ref(i-1, k, 5), cc_ref(i, k, 5));
+      cr2 = VADD(dr2, dr5);
+      ci5 = VSUB(dr5, dr2);
+      cr5 = VSUB(di2, di5);
+      ci2 = VADD(di2, di5);
+      cr3 = VADD(dr3, dr4);
+      ci4 = VSUB(dr4, dr3);
+      cr4 = VSUB(di3, di4);
+      ci3 = VADD(di3, di4);
+      ch_ref(i - 1, 1, k) = VADD(cc_ref(i - 1, k, 1), VADD(cr2, cr3));
+      ch_ref(i, 1, k) = VSUB(cc_ref(i, k, 1), VADD(ci2, ci3));//
+      tr2 = VADD(cc_ref(i - 1, k, 1), VADD(SVMUL(tr11, cr2), SVMUL(tr12, cr3)));
+      ti2 = VSUB(cc_ref(i, k, 1), VADD(SVMUL(tr11, ci2), SVMUL(tr12, ci3)));//
+      tr3 = VADD(cc_ref(i - 1, k, 1), VADD(SVMUL(tr12, cr2), SVMUL(tr11, cr3)));
+      ti3 = VSUB(cc_ref(i, k, 1), VADD(SVMUL(tr12, ci2), SVMUL(tr11, ci3)));//
+      tr5 = VADD(SVMUL(ti11, cr5), SVMUL(ti12, cr4));
+      ti5 = VADD(SVMUL(ti11, ci5), SVMUL(ti12, ci4));
+      tr4 = VSUB(SVMUL(ti12, cr5), SVMUL(ti11, cr4));
+      ti4 = VSUB(SVMUL(ti12, ci5), SVMUL(ti11, ci4));
+      ch_ref(i - 1, 3, k) = VSUB(tr2, tr5);
+      ch_ref(ic - 1, 2, k) = VADD(tr2, tr5);
+      ch_ref(i, 3, k) = VADD(ti2, ti5);
+      ch_ref(ic, 2, k) = VSUB(ti5, ti2);
+      ch_ref(i - 1, 5, k) = VSUB(tr3, tr4);
+      ch_ref(ic - 1, 4, k) = VADD(tr3, tr4);
+      ch_ref(i, 5, k) = VADD(ti3, ti4);
+      ch_ref(ic, 4, k) = VSUB(ti4, ti3);
+    }
+  }
+#undef cc_ref
+#undef ch_ref
+} /* radf5 */
+
+static void radb5_ps(int ido, int l1, const v4sf *RESTRICT cc, v4sf *RESTRICT ch, 
+                  const pffft_float *wa1, const pffft_float *wa2, const pffft_float *wa3, const pffft_float *wa4)
+{
+  static const pffft_float tr11 = .30901699437494742;
+  static const pffft_float ti11 = .95105651629515357;
+  static const pffft_float tr12 = -.80901699437494742;
+  static const pffft_float ti12 = .58778525229247313;
+
+  int cc_offset, ch_offset;
+
+  /* Local variables */
+  int i, k, ic;
+  v4sf ci2, ci3, ci4, ci5, di3, di4, di5, di2, cr2, cr3, cr5, cr4, ti2, ti3,
+    ti4, ti5, dr3, dr4, dr5, dr2, tr2, tr3, tr4, tr5;
+  int idp2;
+
+#define cc_ref(a_1,a_2,a_3) cc[((a_3)*5 + (a_2))*ido + a_1]
+#define ch_ref(a_1,a_2,a_3) ch[((a_3)*l1 + (a_2))*ido + a_1]
+
+  /* Parameter adjustments */
+  ch_offset = 1 + ido * (1 + l1);
+  ch -= ch_offset;
+  cc_offset = 1 + ido * 6;
+  cc -= cc_offset;
+
+  /* Function Body */
+  for (k = 1; k <= l1; ++k) {
+    ti5 = VADD(cc_ref(1, 3, k), cc_ref(1, 3, k));
+    ti4 = VADD(cc_ref(1, 5, k), cc_ref(1, 5, k));
+    tr2 = VADD(cc_ref(ido, 2, k), cc_ref(ido, 2, k));
+    tr3 = VADD(cc_ref(ido, 4, k), cc_ref(ido, 4, k));
+    ch_ref(1, k, 1) = VADD(cc_ref(1, 1, k), VADD(tr2, tr3));
+    cr2 = VADD(cc_ref(1, 1, k), VADD(SVMUL(tr11, tr2), SVMUL(tr12, tr3)));
+    cr3 = VADD(cc_ref(1, 1, k), VADD(SVMUL(tr12, tr2), SVMUL(tr11, tr3)));
+    ci5 = VADD(SVMUL(ti11, ti5), SVMUL(ti12, ti4));
+    ci4 = VSUB(SVMUL(ti12, ti5), SVMUL(ti11, ti4));
+    ch_ref(1, k, 2) = VSUB(cr2, ci5);
+    ch_ref(1, k, 3) = VSUB(cr3, ci4);
+    ch_ref(1, k, 4) = VADD(cr3, ci4);
+    ch_ref(1, k, 5) = VADD(cr2, ci5);
+  }
+  if (ido == 1) {
+    return;
+  }
+  idp2 = ido + 2;
+  for (k = 1; k <= l1; ++k) {
+    for (i = 3; i <= ido; i += 2) {
+      ic = idp2 - i;
+      ti5 = VADD(cc_ref(i  , 3, k), cc_ref(ic  , 2, k));
+      ti2 = VSUB(cc_ref(i  , 3, k), cc_ref(ic  , 2, k));
+      ti4 = VADD(cc_ref(i  , 5, k), cc_ref(ic  , 4, k));
+      ti3 = VSUB(cc_ref(i  , 5, k), cc_ref(ic  , 4, k));
+      tr5 = VSUB(cc_ref(i-1, 3, k), cc_ref(ic-1, 2, k));
+      tr2 = VADD(cc_ref(i-1, 3, k), cc_ref(ic-1, 2, k));
+      tr4 = VSUB(cc_ref(i-1, 5, k), cc_ref(ic-1, 4, k));
+      tr3 = VADD(cc_ref(i-1, 5, k), cc_ref(ic-1, 4, k));
+      ch_ref(i - 1, k, 1) = VADD(cc_ref(i-1, 1, k), VADD(tr2, tr3));
+      ch_ref(i, k, 1) = VADD(cc_ref(i, 1, k), VADD(ti2, ti3));
+      cr2 = VADD(cc_ref(i-1, 1, k), VADD(SVMUL(tr11, tr2), SVMUL(tr12, tr3)));
+      ci2 = VADD(cc_ref(i  , 1, k), VADD(SVMUL(tr11, ti2), SVMUL(tr12, ti3)));
+      cr3 = VADD(cc_ref(i-1, 1, k), VADD(SVMUL(tr12, tr2), SVMUL(tr11, tr3)));
+      ci3 = VADD(cc_ref(i  , 1, k), VADD(SVMUL(tr12, ti2), SVMUL(tr11, ti3)));
+      cr5 = VADD(SVMUL(ti11, tr5), SVMUL(ti12, tr4));
+      ci5 = VADD(SVMUL(ti11, ti5), SVMUL(ti12, ti4));
+      cr4 = VSUB(SVMUL(ti12, tr5), SVMUL(ti11, tr4));
+      ci4 = VSUB(SVMUL(ti12, ti5), SVMUL(ti11, ti4));
+      dr3 = VSUB(cr3, ci4);
+      dr4 = VADD(cr3, ci4);
+      di3 = VADD(ci3, cr4);
+      di4 = VSUB(ci3, cr4);
+      dr5 = VADD(cr2, ci5);
+      dr2 = VSUB(cr2, ci5);
+      di5 = VSUB(ci2, cr5);
+      di2 = VADD(ci2, cr5);
+      VCPLXMUL(dr2, di2, LD_PS1(wa1[i-3]), LD_PS1(wa1[i-2]));
+      VCPLXMUL(dr3, di3, LD_PS1(wa2[i-3]), LD_PS1(wa2[i-2]));
+      VCPLXMUL(dr4, di4, LD_PS1(wa3[i-3]), LD_PS1(wa3[i-2]));
+      VCPLXMUL(dr5, di5, LD_PS1(wa4[i-3]), LD_PS1(wa4[i-2]));
+
+      ch_ref(i-1, k, 2) = dr2; ch_ref(i, k, 2) = di2;
+      ch_ref(i-1, k, 3) = dr3; ch_ref(i, k, 3) = di3;
+      ch_ref(i-1, k, 4) = dr4; ch_ref(i, k, 4) = di4;
+      ch_ref(i-1, k, 5) = dr5; ch_ref(i, k, 5) = di5;
+    }
+  }
+#undef cc_ref
+#undef ch_ref
+} /* radb5 */
+
+/*
+  odd prime radix real passes, same decomposition as passfp_ps (see
+  radf3_ps / radb3_ps for the layout of the half-complex data)
+*/
+static ALWAYS_INLINE(void) radfp_ps(int ido, int l1, int ip, const v4sf * RESTRICT cc, v4sf * RESTRICT ch, const pffft_float *wa) {
+  pffft_float wc[PFFFT_MAX_RADIX], ws[PFFFT_MAX_RADIX];
+  v4sf sr[PFFFT_MAX_RADIX/2+1], si[PFFFT_MAX_RADIX/2+1], dr[PFFFT_MAX_RADIX/2+1], di[PFFFT_MAX_RADIX/2+1];
+  int i, j, k, m, ic, iph = ip/2;
+  radix_trig(ip, wc, ws, -1);
+  for (k=0; k < l1; ++k) {
+    v4sf x0 = cc[k*ido], y0 = x0;
+    for (j=1; j <= iph; ++j) {
+      sr[j] = VADD(cc[(k + j*l1)*ido], cc[(k + (ip-j)*l1)*ido]);
+      dr[j] = VSUB(cc[(k + j*l1)*ido], cc[(k + (ip-j)*l1)*ido]);
+      y0 = VADD(y0, sr[j]);
+    }
+    ch[ip*k*ido] = y0;
+    for (m=1; m <= iph; ++m) {
+      v4sf a = x0, b = VZERO();
+      int jm = 0;
+      for (j=1; j <= iph; ++j) {
+        jm += m; if (jm >= ip) jm -= ip;
+        a = VMADD(LD_PS1(wc[jm]), sr[j], a);
+        b = VMADD(LD_PS1(ws[jm]), dr[j], b);
+      }
+      ch[ido-1 + (ip*k + 2*m-1)*ido] = a;
+      ch[(ip*k + 2*m)*ido] = b;
+    }
+  }
+  if (ido == 1) return;
+  for (k=0; k < l1; ++k) {
+    for (i=2; i < ido; i += 2) {
+      v4sf x0r = cc[i - 1 + k*ido], x0i = cc[i + k*ido], yr = x0r, yi = x0i;
+      ic = ido - i;
+      for (j=1; j <= iph; ++j) {
+        v4sf ar = cc[i - 1 + (k + j*l1)*ido], ai = cc[i + (k + j*l1)*ido];
+        v4sf br = cc[i - 1 + (k + (ip-j)*l1)*ido], bi = cc[i + (k + (ip-j)*l1)*ido];
+        VCPLXMULCONJ(ar, ai, LD_PS1(wa[(j-1)*ido + i-2]), LD_PS1(wa[(j-1)*ido + i-1]));
+        VCPLXMULCONJ(br, bi, LD_PS1(wa[(ip-j-1)*ido + i-2]), LD_PS1(wa[(ip-j-1)*ido + i-1]));
+        sr[j] = VADD(ar, br); si[j] = VADD(ai, bi);
+        dr[j] = VSUB(ar, br); di[j] = VSUB(ai, bi);
+        yr = VADD(yr, sr[j]); yi = VADD(yi, si[j]);
+      }
+      ch[i - 1 + ip*k*ido] = yr;
+      ch[i + ip*k*ido] = yi;
+      for (m=1; m <= iph; ++m) {
+        v4sf ar = x0r, ai = x0i, br = VZERO(), bi = VZERO();
+        int jm = 0;
+        for (j=1; j <= iph; ++j) {
+          jm += m; if (jm >= ip) jm -= ip;
+          ar = VMADD(LD_PS1(wc[jm]), sr[j], ar);
+          ai = VMADD(LD_PS1(wc[jm]), si[j], ai);
+          br = VMADD(LD_PS1(ws[jm]), dr[j], br);
+          bi = VMADD(LD_PS1(ws[jm]), di[j], bi);
+        }
+        ch[i - 1 + (ip*k + 2*m)*ido] = VSUB(ar, bi);
+        ch[i + (ip*k + 2*m)*ido] = VADD(ai, br);
+        ch[ic - 1 + (ip*k + 2*m-1)*ido] = VADD(ar, bi);
+        ch[ic + (ip*k + 2*m-1)*ido] = VSUB(br, ai);
+      }
+    }
+  }
+}
+
+static ALWAYS_INLINE(void) radbp_ps(int ido, int l1, int ip, const v4sf * RESTRICT cc, v4sf * RESTRICT ch, const pffft_float *wa) {
+  pffft_float wc[PFFFT_MAX_RADIX], ws[PFFFT_MAX_RADIX];
+  v4sf tr[PFFFT_MAX_RADIX/2+1], ti[PFFFT_MAX_RADIX/2+1], dr[PFFFT_MAX_RADIX/2+1], di[PFFFT_MAX_RADIX/2+1];
+  int i, j, k, m, ic, iph = ip/2;
+  radix_trig(ip, wc, ws, 1);
+  for (k=0; k < l1; ++k) {
+    v4sf y0 = cc[ip*k*ido], x0 = y0;
+    for (m=1; m <= iph; ++m) {
+      tr[m] = cc[ido-1 + (ip*k + 2*m-1)*ido]; tr[m] = VADD(tr[m], tr[m]);
+      dr[m] = cc[(ip*k + 2*m)*ido]; dr[m] = VADD(dr[m], dr[m]);
+      x0 = VADD(x0, tr[m]);
+    }
+    ch[k*ido] = x0;
+    for (j=1; j <= iph; ++j) {
+      v4sf p = y0, q = VZERO();
+      int jm = 0;
+      for (m=1; m <= iph; ++m) {
+        jm += j; if (jm >= ip) jm -= ip;
+        p = VMADD(LD_PS1(wc[jm]), tr[m], p);
+        q = VMADD(LD_PS1(ws[jm]), dr[m], q);
+      }
+      ch[(k + j*l1)*ido] = VSUB(p, q);
+      ch[(k + (ip-j)*l1)*ido] = VADD(p, q);
+    }
+  }
+  if (ido == 1) return;
+  for (k=0; k < l1; ++k) {
+    for (i=2; i < ido; i += 2) {
+      v4sf y0r = cc[i - 1 + ip*k*ido], y0i = cc[i + ip*k*ido], xr = y0r, xi = y0i;
+      ic = ido - i;
+      for (m=1; m <= iph; ++m) {
+        v4sf ur = cc[i - 1 + (ip*k + 2*m)*ido], ui = cc[i + (ip*k + 2*m)*ido];
+        v4sf vr = cc[ic - 1 + (ip*k + 2*m-1)*ido], vi = cc[ic + (ip*k + 2*m-1)*ido];
+        tr[m] = VADD(ur, vr); ti[m] = VSUB(ui, vi);
+        dr[m] = VSUB(ur, vr); di[m] = VADD(ui, vi);
+        xr = VADD(xr, tr[m]); xi = VADD(xi, ti[m]);
+      }
+      ch[i - 1 + k*ido] = xr;
+      ch[i + k*ido] = xi;
+      for (j=1; j <= iph; ++j) {
+        v4sf pr = y0r, pi = y0i, qr = VZERO(), qi = VZERO();
+        v4sf zr, zi;
+        int jm = 0;
+        for (m=1; m <= iph; ++m) {
+          jm += j; if (jm >= ip) jm -= ip;
+          pr = VMADD(LD_PS1(wc[jm]), tr[m], pr);
+          pi = VMADD(LD_PS1(wc[jm]), ti[m], pi);
+          qr = VMADD(LD_PS1(ws[jm]), dr[m], qr);
+          qi = VMADD(LD_PS1(ws[jm]), di[m], qi);
+        }
+        zr = VSUB(pr, qi); zi = VADD(pi, qr);
+        VCPLXMUL(zr, zi, LD_PS1(wa[(j-1)*ido + i-2]), LD_PS1(wa[(j-1)*ido + i-1]));
+        ch[i - 1 + (k + j*l1)*ido] = zr;
+        ch[i + (k + j*l1)*ido] = zi;
+        zr = VADD(pr, qi); zi = VSUB(pi, qr);
+        VCPLXMUL(zr, zi, LD_PS1(wa[(ip-j-1)*ido + i-2]), LD_PS1(wa[(ip-j-1)*ido + i-1]));
+        ch[i - 1 + (k + (ip-j)*l1)*ido] = zr;
+        ch[i + (k + (ip-j)*l1)*ido] = zi;
+      }
+    }
+  }
+}
+
+static NEVER_INLINE(void) radfg_ps(int ido, int l1, int ip, const v4sf * RESTRICT cc, v4sf * RESTRICT ch, const pffft_float *wa) {
+  assert(ip <= PFFFT_MAX_RADIX && (ip & 1));
+  switch (ip) {
+    case 7:  radfp_ps(ido, l1, 7, cc, ch, wa); break;
+    case 11: radfp_ps(ido, l1, 11, cc, ch, wa); break;
+    case 13: radfp_ps(ido, l1, 13, cc, ch, wa); break;
+    default: radfp_ps(ido, l1, ip, cc, ch, wa); break;
+  }
+}
+
+static NEVER_INLINE(void) radbg_ps(int ido, int l1, int ip, const v4sf * RESTRICT cc, v4sf * RESTRICT ch, const pffft_float *wa) {
+  assert(ip <= PFFFT_MAX_RADIX && (ip & 1));
+  switch (ip) {
+    case 7:  radbp_ps(ido, l1, 7, cc, ch, wa); break;
+    case 11: radbp_ps(ido, l1, 11, cc, ch, wa); break;
+    case 13: radbp_ps(ido, l1, 13, cc, ch, wa); break;
+    default: radbp_ps(ido, l1, ip, cc, ch, wa); break;
+  }
+}
+
+static NEVER_INLINE(v4sf *) rfftf1_ps(int n, const v4sf *input_readonly, v4sf *work1, v4sf *work2, 
+                                      const pffft_float *wa, const int *ifac) {  
+  v4sf *in  = (v4sf*)input_readonly;
+  v4sf *out = (in == work2 ? work1 : work2);
+  int nf = ifac[1], k1;
+  int l2 = n;
+  int iw = n-1;
+  assert(in != out && work1 != work2);
+  for (k1 = 1; k1 <= nf; ++k1) {
+    int kh = nf - k1;
+    int ip = ifac[kh + 2];
+    int l1 = l2 / ip;
+    int ido = n / l2;
+    iw -= (ip - 1)*ido;
+    switch (ip) {
+      case 5: {
+        int ix2 = iw + ido;
+        int ix3 = ix2 + ido;
+        int ix4 = ix3 + ido;
+        radf5_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], &wa[ix4]);
+      } break;
+      case 4: {
+        int ix2 = iw + ido;
+        int ix3 = ix2 + ido;
+        radf4_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3]);
+      } break;
+      case 3: {
+        int ix2 = iw + ido;
+        radf3_ps(ido, l1, in, out, &wa[iw], &wa[ix2]);
+      } break;
+      case 2:
+        radf2_ps(ido, l1, in, out, &wa[iw]);
+        break;
+      default:
+        radfg_ps(ido, l1, ip, in, out, &wa[iw]);
+        break;
+    }
+    l2 = l1;
+    if (out == work2) {
+      out = work1; in = work2;
+    } else {
+      out = work2; in = work1;
+    }
+  }
+  return in; /* this is in fact the output .. */
+} /* rfftf1 */
+
+static NEVER_INLINE(v4sf *) rfftb1_ps(int n, const v4sf *input_readonly, v4sf *work1, v4sf *work2, 
+                                      const pffft_float *wa, const int *ifac) {  
+  v4sf *in  = (v4sf*)input_readonly;
+  v4sf *out = (in == work2 ? work1 : work2);
+  int nf = ifac[1], k1;
+  int l1 = 1;
+  int iw = 0;
+  assert(in != out);
+  for (k1=1; k1<=nf; k1++) {
+    int ip = ifac[k1 + 1];
+    int l2 = ip*l1;
+    int ido = n / l2;
+    switch (ip) {
+      case 5: {
+        int ix2 = iw + ido;
+        int ix3 = ix2 + ido;
+        int ix4 = ix3 + ido;
+        radb5_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], &wa[ix4]);
+      } break;
+      case 4: {
+        int ix2 = iw + ido;
+        int ix3 = ix2 + ido;
+        radb4_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3]);
+      } break;
+      case 3: {
+        int ix2 = iw + ido;
+        radb3_ps(ido, l1, in, out, &wa[iw], &wa[ix2]);
+      } break;
+      case 2:
+        radb2_ps(ido, l1, in, out, &wa[iw]);
+        break;
+      default:
+        radbg_ps(ido, l1, ip, in, out, &wa[iw]);
+        break;
+    }
+    l1 = l2;
+    iw += (ip - 1)*ido;
+
+    if (out == work2) {
+      out = work1; in = work2;
+    } else {
+      out = work2; in = work1;
+    }
+  }
+  return in; /* this is in fact the output .. */
+}
+
+/* the radices tried by decompose, for the real and complex transforms */
+static const int rfft_ntryh[] = { 4,2,3,5,7,11,13,17,19,23,29,31,0 };
+static const int cfft_ntryh[] = { 5,3,4,2,7,11,13,17,19,23,29,31,0 };
+
+static int decompose(int n, int *ifac, const int *ntryh) {
+  int nl = n, nf = 0, i, j = 0;
+  for (j=0; ntryh[j]; ++j) {
+    int ntry = ntryh[j];
+    while (nl != 1) {
+      int nq = nl / ntry;
+      int nr = nl - ntry * nq;
+      if (nr == 0) {
+        ifac[2+nf++] = ntry;
+        nl = nq;
+        if (ntry == 2 && nf != 1) {
+          for (i = 2; i <= nf; ++i) {
+            int ib = nf - i + 2;
+            ifac[ib + 1] = ifac[ib];
+          }
+          ifac[2] = 2;
+        }
+      } else break;
+    }
+  }
+  ifac[0] = n;
+  ifac[1] = nf;  
+  return nf;
+}
+
+
+
+/* twiddles of the real passes, for the factorization in ifac */
+static void rffti1_twiddles_ps(int n, pffft_float *wa, const int *ifac)
+{
+  int k1, j, ii;
+  int nf = ifac[1];
+  int is = 0;
+  int nfm1 = nf - 1;
+  int l1 = 1;
+  for (k1 = 1; k1 <= nfm1; k1++) {
+    int ip = ifac[k1 + 1];
+    int ld = 0;
+    int l2 = l1*ip;
+    int ido = n / l2;
+    int ipm = ip - 1;
+    for (j = 1; j <= ipm; ++j) {
+      int i = is, fi=0;
+      ld += l1;
+      for (ii = 3; ii <= ido; ii += 2) {
+        i += 2;
+        fi += 1;
+        trig_angle((long long)fi*ld, n, &wa[i - 2], &wa[i - 1]);
+      }
+      is += ido;
+    }
+    l1 = l2;
+  }
+}
+
+static void rffti1_ps(int n, pffft_float *wa, int *ifac)
+{
+  decompose(n,ifac,rfft_ntryh);
+  rffti1_twiddles_ps(n, wa, ifac);
+} /* rffti1 */
+
+/* twiddles of the complex passes, for the factorization in ifac */
+static void cffti1_twiddles_ps(int n, pffft_float *wa, const int *ifac)
+{
+  int k1, j, ii;
+  int nf = ifac[1];
+  int i = 1;
+  int l1 = 1;
+  for (k1=1; k1<=nf; k1++) {
+    int ip = ifac[k1+1];
+    int ld = 0;
+    int l2 = l1*ip;
+    int ido = n / l2;
+    int idot = ido + ido + 2;
+    int ipm = ip - 1;
+    for (j=1; j<=ipm; j++) {
+      int fi = 0;
+      wa[i-1] = 1;
+      wa[i] = 0;
+      ld += l1;
+      for (ii = 4; ii <= idot; ii += 2) {
+        i += 2;
+        fi += 1;
+        trig_angle((long long)fi*ld, n, &wa[i-1], &wa[i]);
+      }
+    }
+    l1 = l2;
+  }
+}
+
+static void cffti1_ps(int n, pffft_float *wa, int *ifac)
+{
+  decompose(n,ifac,cfft_ntryh);
+  cffti1_twiddles_ps(n, wa, ifac);
+} /* cffti1 */
+
+
+static v4sf *cfftf1_ps(int n, const v4sf *input_readonly, v4sf *work1, v4sf *work2, const pffft_float *wa, const int *ifac, int isign) {
+  v4sf *in  = (v4sf*)input_readonly;
+  v4sf *out = (in == work2 ? work1 : work2); 
+  int nf = ifac[1], k1;
+  int l1 = 1;
+  int iw = 0;
+  assert(in != out && work1 != work2);
+  for (k1=2; k1<=nf+1; k1++) {
+    int ip = ifac[k1];
+    int l2 = ip*l1;
+    int ido = n / l2;
+    int idot = ido + ido;
+    switch (ip) {
+      case 5: {
+        int ix2 = iw + idot;
+        int ix3 = ix2 + idot;
+        int ix4 = ix3 + idot;
+        passf5_ps(idot, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], &wa[ix4], isign);
+      } break;
+      case 4: {
+        int ix2 = iw + idot;
+        int ix3 = ix2 + idot;
+        passf4_ps(idot, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], isign);
+      } break;
+      case 2: {
+        passf2_ps(idot, l1, in, out, &wa[iw], isign);
+      } break;
+      case 3: {
+        int ix2 = iw + idot;
+        passf3_ps(idot, l1, in, out, &wa[iw], &wa[ix2], isign);
+      } break;
+      default:
+        passfg_ps(idot, l1, ip, in, out, &wa[iw], isign);
+    }
+    l1 = l2;
+    iw += (ip - 1)*idot;
+    if (out == work2) {
+      out = work1; in = work2;
+    } else {
+      out = work2; in = work1;
+    }
+  }
+
+  return in; /* this is in fact the output .. */
+}
+
+/*
+  initializes the (zeroed) setup 's' of size N, with its tables in 'data'
+  (64-byte aligned, the returned number of floats). Only returns that
+  number when 's' is null, and 0 when N is not supported by this simd
+  flavour. When 'data' is null, the fields of 's' are set, but not the
+  tables.
+*/
+/*
+  the generic finalize / preprocess functions (SIMD_SZ != 4) combine the
+  m=0 components of the real transforms across the lanes with the 4
+  matrices of SIMD_SZ vectors of lane_m0_tables, stored after 'e'
+*/
+#if !defined(PFFFT_SIMD_DISABLE) && SIMD_SZ != 4
+#  define LANE_M0_VECTORS(transform) ((transform) == PFFFT_REAL ? 4*SIMD_SZ : 0)
+#else
+#  define LANE_M0_VECTORS(transform) 0
+#endif
+
+/* T[j] (X(t*L) = sum_j T[j]*cr_j, with X(0), X(N/2) in the lanes 0 and 1),
+   U[j] (X(t*L + L/2) = sum_j U[j]*ci_j), and their inverses, see
+   pffft_real_finalize and pffft_real_preprocess */
+static void lane_m0_tables(pffft_float *m0) {
+  int j, t, S = SIMD_SZ;
+  for (j=0; j < S; ++j) {
+    for (t=0; t < S/2; ++t) {
+      pffft_float c, sn, w = (t ? 2 : 1);
+      trig_angle((long long)j*t, S, &c, &sn);
+      m0[(0*S + j)*S + 2*t] = c;
+      m0[(0*S + j)*S + 2*t+1] = (t ? -sn : (j & 1) ? -1 : 1);
+      m0[(2*S + 2*t)*S + j] = w*m0[(0*S + j)*S + 2*t];
+      m0[(2*S + 2*t+1)*S + j] = w*m0[(0*S + j)*S + 2*t+1];
+      trig_angle((long long)j*(2*t+1), 2*S, &c, &sn);
+      m0[(1*S + j)*S + 2*t] = c;
+      m0[(1*S + j)*S + 2*t+1] = -sn;
+      m0[(3*S + 2*t)*S + j] = 2*c;
+      m0[(3*S + 2*t+1)*S + j] = -2*sn;
+    }
+  }
+}
+
+static int pffft_init_setup(PFFFT_Setup *s, pffft_float *data, int N, pffft_transform_t transform) {
+  int k, m, Ncvec, data_size, ifac[15];
+  int nblocks; // nb of SIMD_SZ x SIMD_SZ blocks in the finalize / preprocess steps
+  /* unfortunately, the fft size must be a multiple of 16 for complex FFTs 
+     and 32 for real FFTs -- a lot of stuff would need to be rewritten to
+     handle other cases (or maybe just switch to a scalar fft, I don't know..) 
+     The generic code used for the other vector sizes (AVX, AVX-512, SSE2
+     doubles) handles a partial last block, so it only needs N to be a
+     multiple of 2*SIMD_SZ (real) or SIMD_SZ (complex). */
+#if SIMD_SZ != 4
+  const int min_block = SIMD_SZ;
+#else
+  const int min_block = SIMD_SZ*SIMD_SZ;
+#endif
+  if (N <= 0) return 0;
+  if (transform == PFFFT_REAL && (N%(2*min_block)) != 0) return 0;
+  if (transform == PFFFT_COMPLEX && (N%min_block) != 0) return 0;
+
+  /* check that N is decomposable with allowed prime factors (and, for the
+     scalar code, which has no finalize / preprocess step, that there is at
+     least one fft pass) */
+  decompose(N/SIMD_SZ, ifac, (transform == PFFFT_REAL ? rfft_ntryh : cfft_ntryh));
+  for (k=0, m=1; k < ifac[1]; ++k) { m *= ifac[2+k]; }
+  if (m != N/SIMD_SZ || (SIMD_SZ == 1 && ifac[1] == 0)) return 0;
+
+  /* nb of complex simd vectors */
+  Ncvec = (transform == PFFFT_REAL ? N/2 : N)/SIMD_SZ;
+  nblocks = (Ncvec + SIMD_SZ - 1)/SIMD_SZ;
+  data_size = (2*nblocks*(SIMD_SZ-1) + LANE_M0_VECTORS(transform) + (2*Ncvec + SIMD_SZ - 1)/SIMD_SZ) * SIMD_SZ;
+  if (!s) return data_size;
+
+  s->N = N;
+  s->transform = transform;  
+  s->Ncvec = Ncvec;
+  s->data_size = data_size;
+  if (!data) {
+    memcpy(s->ifac, ifac, sizeof(ifac));
+    return data_size;
+  }
+  s->data = data;
+  s->e = s->data;
+  s->twiddle = (pffft_float*)((v4sf*)s->data + 2*nblocks*(SIMD_SZ-1) + LANE_M0_VECTORS(transform));
+
+  if (LANE_M0_VECTORS(transform)) lane_m0_tables(s->e + 2*nblocks*(SIMD_SZ-1)*SIMD_SZ);
+  for (k=0; k < nblocks*SIMD_SZ; ++k) {
+    int i = k/SIMD_SZ;
+    int j = k%SIMD_SZ;
+    for (m=0; m < SIMD_SZ-1; ++m) {
+      pffft_float c, sn;
+      trig_angle((long long)(m+1)*k, N, &c, &sn);
+      s->e[(2*(i*(SIMD_SZ-1) + m) + 0) * SIMD_SZ + j] = c;
+      s->e[(2*(i*(SIMD_SZ-1) + m) + 1) * SIMD_SZ + j] = -sn;
+    }
+  }
+  if (transform == PFFFT_REAL) {
+    rffti1_ps(N/SIMD_SZ, s->twiddle, s->ifac);
+  } else {
+    cffti1_ps(N/SIMD_SZ, s->twiddle, s->ifac);
+  }
+  return data_size;
+}
+
+static PFFFT_Setup *pffft_new_setup(int N, pffft_transform_t transform) {
+  PFFFT_Setup *s;
+  int data_size = pffft_init_setup(0, 0, N, transform);
+  if (!data_size) return 0;
+  s = (PFFFT_Setup*)calloc(1, sizeof(PFFFT_Setup));
+  pffft_init_setup(s, (pffft_float*)pffft_aligned_malloc(data_size * sizeof(pffft_float)), N, transform);
+  return s;
+}
+
+/*
+  PFFFT_MEASURE planning. decompose always picks the same factorization
+  (as many radix 4 passes as possible, with the radix 2 one first), which
+  is not always the fastest one: pffft_measure_setup times the forward and
+  backward passes for a few other radix mixes (a radix 4 pass replaced by
+  two radix 2 ones) and orders of the factors, and keeps the fastest one.
+*/
+#define PFFFT_MEASURE_MAX_PLANS 16
+#define PFFFT_MEASURE_MIN_TIME 2e-4 // seconds, for each round of the timings
+#define PFFFT_MEASURE_ROUNDS 3
+
+/* the factors are sorted by increasing key: 0 ascending, 1 descending,
+   2 radix 4 first and radix 2 last, 3 odd radices first. The radix 2 and 4
+   passes of the real transforms do not handle an odd 'ido' (except 1), so
+   they always come before the odd radices there. */
+static int factor_key(int f, int order, pffft_transform_t transform) {
+  int key;
+  switch (order) {
+    case 0: key = f; break;
+    case 1: key = -f; break;
+    case 2: key = (f == 4 ? 0 : f == 2 ? 64 : f); break;
+    default: key = (f & 1 ? f : 64 + f); break;
+  }
+  if (transform == PFFFT_REAL && (f & 1)) key += 256;
+  return key;
+}
+
+static void sort_factors(int *ifac, int order, pffft_transform_t transform) {
+  int nf = ifac[1], i, j;
+  for (i=1; i < nf; ++i) {
+    int f = ifac[2+i];
+    for (j=i; j > 0 && factor_key(f, order, transform) < factor_key(ifac[2+j-1], order, transform); --j) {
+      ifac[2+j] = ifac[2+j-1];
+    }
+    ifac[2+j] = f;
+  }
+}
+
+/* best time of the forward + backward passes with the factorization ifac,
+   'buf' holding three vectors of 2*Ncvec v4sf */
+static double pffft_measure_plan(PFFFT_Setup *s, const int *ifac, pffft_float *wa, v4sf *buf, int reps) {
+  int n = s->N/SIMD_SZ, r, k;
+  v4sf *in = buf, *work1 = buf + 2*s->Ncvec, *work2 = work1 + 2*s->Ncvec;
+  double best = 0;
+  if (s->transform == PFFFT_REAL) {
+    rffti1_twiddles_ps(n, wa, ifac);
+  } else {
+    cffti1_twiddles_ps(n, wa, ifac);
+  }
+  for (r=0; r < PFFFT_MEASURE_ROUNDS; ++r) {
+    double t = pffft_wall_clock();
+    for (k=0; k < reps; ++k) {
+      if (s->transform == PFFFT_REAL) {
+        rfftf1_ps(n, in, work1, work2, wa, ifac);
+        rfftb1_ps(n, in, work1, work2, wa, ifac);
+      } else {
+        cfftf1_ps(n, in, work1, work2, wa, ifac, -1);
+        cfftf1_ps(n, in, work1, work2, wa, ifac, +1);
+      }
+    }
+    t = pffft_wall_clock() - t;
+    if (r == 0 || t < best) best = t;
+  }
+  return best;
+}
+
+static void pffft_measure_setup(PFFFT_Setup *s) {
+  int plans[PFFFT_MEASURE_MAX_PLANS][15];
+  int nplans = 1, twos = 0, nodd = 0, odd[13], fours, order, reps, best = 0, k, j;
+  int n = s->N/SIMD_SZ;
+  int wa_size = s->data_size - (int)(s->twiddle - s->data);
+  pffft_float *wa = (pffft_float*)pffft_aligned_malloc(wa_size*sizeof(pffft_float));
+  v4sf *buf = (v4sf*)pffft_aligned_malloc(6*s->Ncvec*sizeof(v4sf));
+  double best_time, t;
+
+  for (k=0; k < 2*s->Ncvec*SIMD_SZ; ++k) {
+    ((pffft_float*)buf)[k] = (pffft_float)((k % 7) - 3);
+  }
+  /* the default factorization is the first candidate, it is kept on ties */
+  memcpy(plans[0], s->ifac, sizeof(plans[0]));
+  for (k=0; k < s->ifac[1]; ++k) {
+    int f = s->ifac[2+k];
+    if (f == 4) twos += 2;
+    else if (f == 2) twos += 1;
+    else odd[nodd++] = f;
+  }
+  for (fours = twos/2; fours >= 0 && fours >= twos/2 - 2; --fours) {
+    int nf = nodd + fours + (twos - 2*fours);
+    if (nf > 13) break;
+    for (order=0; order < 4; ++order) {
+      int *p = plans[nplans];
+      p[0] = n; p[1] = nf;
+      for (k=0; k < fours; ++k) p[2+k] = 4;
+      for (; k < fours + twos - 2*fours; ++k) p[2+k] = 2;
+      for (j=0; j < nodd; ++j) p[2+k+j] = odd[j];
+      sort_factors(p, order, s->transform);
+      for (j=0; j < nplans && memcmp(plans[j], p, (2+nf)*sizeof(int)) != 0; ++j) {}
+      if (j == nplans && nplans < PFFFT_MEASURE_MAX_PLANS) ++nplans;
+    }
+  }
+
+  if (nplans > 1) {
+    /* enough repetitions for each round to last PFFFT_MEASURE_MIN_TIME */
+    for (reps=1; reps < (1<<20); reps *= 2) {
+      if (pffft_measure_plan(s, plans[0], wa, buf, reps) >= PFFFT_MEASURE_MIN_TIME) break;
+    }
+    best_time = pffft_measure_plan(s, plans[0], wa, buf, reps);
+    for (k=1; k < nplans; ++k) {
+      t = pffft_measure_plan(s, plans[k], wa, buf, reps);
+      if (t < best_time) { best_time = t; best = k; }
+    }
+    if (best != 0) {
+      memcpy(s->ifac, plans[best], sizeof(s->ifac));
+      if (s->transform == PFFFT_REAL) {
+        rffti1_twiddles_ps(n, s->twiddle, s->ifac);
+      } else {
+        cffti1_twiddles_ps(n, s->twiddle, s->ifac);
+      }
+    }
+  }
+  pffft_aligned_free(buf);
+  pffft_aligned_free(wa);
+}
+
+#if !defined(PFFFT_SIMD_DISABLE)
+
+#if SIMD_SZ == 4
+/* [0 0 1 2 3 4 5 6 7 8] -> [0 8 7 6 5 4 3 2 1] */
+static void reversed_copy(int N, const v4sf *in, int in_stride, v4sf *out) {
+  v4sf g0, g1;
+  int k;
+  INTERLEAVE2(in[0], in[1], g0, g1); in += in_stride;
+  
+  *--out = VSWAPHL(g0, g1); // [g0l, g0h], [g1l g1h] -> [g1l, g0h]
+  for (k=1; k < N; ++k) {
+    v4sf h0, h1;
+    INTERLEAVE2(in[0], in[1], h0, h1); in += in_stride;
+    *--out = VSWAPHL(g1, h0);
+    *--out = VSWAPHL(h0, h1);
+    g1 = h1;
+  }
+  *--out = VSWAPHL(g1, g0);
+}
+
+static void unreversed_copy(int N, const v4sf *in, v4sf *out, int out_stride) {
+  v4sf g0, g1, h0, h1;
+  int k;
+  g0 = g1 = in[0]; ++in;
+  for (k=1; k < N; ++k) {
+    h0 = *in++; h1 = *in++;
+    g1 = VSWAPHL(g1, h0);
+    h0 = VSWAPHL(h0, h1);
+    UNINTERLEAVE2(h0, g1, out[0], out[1]); out += out_stride;
+    g1 = h1;
+  }
+  h0 = *in++; h1 = g0;
+  g1 = VSWAPHL(g1, h0);
+  h0 = VSWAPHL(h0, h1);
+  UNINTERLEAVE2(h0, g1, out[0], out[1]);
+}
+
+#endif // SIMD_SZ == 4
+
+/*
+  Layout of the real "unordered" spectrum (the 4-wide code above handles
+  the same layout): with L = N/SIMD_SZ, the spectrum is made of blocks of
+  SIMD_SZ complex vectors ("slots"), the lane l of block k corresponding to
+  m = k*SIMD_SZ + l, for m < L/2:
+
+  slot 2t   holds X(t*L + m)
+  slot 2t+1 holds X((t+1)*L - m)
+
+  except for m=0, where slot 0 holds X(0) + i*X(N/2) and slot 2t+1 holds
+  X(t*L + L/2).
+
+  When L/2 is not a multiple of SIMD_SZ, the last block is partial: it only
+  has p = (L/2)%SIMD_SZ valid lanes, and the p first floats of each of its
+  2*SIMD_SZ vectors are stored contiguously (i.e. lane l of the vector v of
+  that block is found at v*p + l). The complex layout (slot q holding
+  X(m + q*L), L = N/SIMD_SZ) uses the same convention for its last block.
+*/
+static int real_slot_index(int L, int slot, int m) {
+  int t = slot/2;
+  if ((slot & 1) == 0) return t*L + m;
+  return m ? (t+1)*L - m : t*L + L/2;
+}
+
+#if SIMD_SZ != 4
+/*
+  The block k of the internal layout (its 2*SIMD_SZ vectors in v[]) moved
+  to / from its place in the canonical order. The zreorder functions are
+  loops over these, and the finalize / preprocess functions call them
+  directly for the ordered transforms, instead of going through memory once
+  more.
+*/
+static ALWAYS_INLINE(void) real_store_ordered(int L, int k, const v4sf *v, pffft_float *out) {
+  int t, l;
+  for (t=0; t < SIMD_SZ/2; ++t) {
+    v4sf a, b;
+    VSTOREU_INTERLEAVE2(out + 2*(t*L + k*SIMD_SZ), v[4*t+0], v[4*t+1]);
+    if (k == 0) {
+      /* lane 0 is X(t*L + L/2). The other lanes are stored as in the next
+         blocks, lane 0 spilling over X((t+1)*L) that the slot 2t+2 then
+         overwrites, except for the last slot where it would go past N/2 */
+      v4sf_union ur, ui;
+      ur.v = v[4*t+2]; ui.v = v[4*t+3];
+      if (t < SIMD_SZ/2-1) {
+        int m0 = (t+1)*L - (SIMD_SZ-1);
+        INTERLEAVE2_REV(ur.v, ui.v, a, b);
+        VSTOREU(out + 2*m0, a); VSTOREU(out + 2*m0 + SIMD_SZ, b);
+      } else {
+        for (l=1; l < SIMD_SZ; ++l) {
+          out[2*((t+1)*L - l) + 0] = ur.f[l];
+          out[2*((t+1)*L - l) + 1] = ui.f[l];
+        }
+      }
+      out[2*(t*L + L/2) + 0] = ur.f[0];
+      out[2*(t*L + L/2) + 1] = ui.f[0];
+    } else {
+      int m0 = (t+1)*L - k*SIMD_SZ - (SIMD_SZ-1);
+      VSTOREU_INTERLEAVE2_REV(out + 2*m0, v[4*t+2], v[4*t+3]);
+    }
+  }
+}
+
+static ALWAYS_INLINE(void) real_load_ordered(int L, int k, const pffft_float *in, v4sf *v) {
+  int t;
+  for (t=0; t < SIMD_SZ/2; ++t) {
+    VLOADU_UNINTERLEAVE2(in + 2*(t*L + k*SIMD_SZ), v[4*t+0], v[4*t+1]);
+    if (k == 0) {
+      v4sf a, b;
+      /* see real_store_ordered. Lane 0 is inserted in the vectors, and the
+         last slot loads the S-1 values below X(N/2) with a masked load:
+         scalar writes into a v4sf_union would stall on the store forwarding
+         of the vector read that follows */
+      int m0 = (t+1)*L - (SIMD_SZ-1);
+      a = VLOADU(in + 2*m0);
+      if (t < SIMD_SZ/2-1) {
+        b = VLOADU(in + 2*m0 + SIMD_SZ);
+      } else {
+        b = (SIMD_SZ > 2 ? VLOAD_PARTIAL(in + 2*m0 + SIMD_SZ, SIMD_SZ-2) : VZERO());
+      }
+      UNINTERLEAVE2_REV(a, b, a, b);
+      v[4*t+2] = VSETLANE0(a, in[2*(t*L + L/2) + 0]);
+      v[4*t+3] = VSETLANE0(b, in[2*(t*L + L/2) + 1]);
+    } else {
+      VLOADU_UNINTERLEAVE2_REV(in + 2*((t+1)*L - k*SIMD_SZ - (SIMD_SZ-1)), v[4*t+2], v[4*t+3]);
+    }
+  }
+}
+
+static ALWAYS_INLINE(void) cplx_store_ordered(int Ncvec, int k, const v4sf *v, pffft_float *out) {
+  int q;
+  for (q=0; q < SIMD_SZ; ++q) {
+    VSTOREU_INTERLEAVE2(out + 2*(k*SIMD_SZ + q*Ncvec), v[2*q], v[2*q+1]);
+  }
+}
+
+static ALWAYS_INLINE(void) cplx_load_ordered(int Ncvec, int k, const pffft_float *in, v4sf *v) {
+  int q;
+  for (q=0; q < SIMD_SZ; ++q) {
+    VLOADU_UNINTERLEAVE2(in + 2*(k*SIMD_SZ + q*Ncvec), v[2*q], v[2*q+1]);
+  }
+}
+
+/* the same for the p valid lanes of the partial last block k, the lane l
+   of its vector j being at v[j*stride + l] */
+static void real_store_ordered_partial(int L, int k, const pffft_float *v, int stride, int p, pffft_float *out) {
+  int t, l;
+  for (t=0; t < SIMD_SZ/2; ++t) {
+    const pffft_float *r0 = v + 4*t*stride, *i0 = r0 + stride, *r1 = i0 + stride, *i1 = r1 + stride;
+    pffft_float *o0 = out + 2*(t*L + k*SIMD_SZ), *o1 = out + 2*((t+1)*L - k*SIMD_SZ);
+    for (l=0; l < p; ++l) { o0[2*l] = r0[l]; o0[2*l+1] = i0[l]; }
+    for (l=(k == 0); l < p; ++l) { o1[-2*l] = r1[l]; o1[-2*l+1] = i1[l]; }
+    if (k == 0) { out[2*(t*L + L/2)] = r1[0]; out[2*(t*L + L/2)+1] = i1[0]; }
+  }
+}
+
+static void real_load_ordered_partial(int L, int k, const pffft_float *in, pffft_float *v, int stride, int p) {
+  int t, l;
+  for (t=0; t < SIMD_SZ/2; ++t) {
+    pffft_float *r0 = v + 4*t*stride, *i0 = r0 + stride, *r1 = i0 + stride, *i1 = r1 + stride;
+    const pffft_float *o0 = in + 2*(t*L + k*SIMD_SZ), *o1 = in + 2*((t+1)*L - k*SIMD_SZ);
+    for (l=0; l < p; ++l) { r0[l] = o0[2*l]; i0[l] = o0[2*l+1]; }
+    for (l=(k == 0); l < p; ++l) { r1[l] = o1[-2*l]; i1[l] = o1[-2*l+1]; }
+    if (k == 0) { r1[0] = in[2*(t*L + L/2)]; i1[0] = in[2*(t*L + L/2)+1]; }
+  }
+}
+
+static void cplx_store_ordered_partial(int Ncvec, int k, const pffft_float *v, int stride, int p, pffft_float *out) {
+  int q, l;
+  for (q=0; q < SIMD_SZ; ++q) {
+    for (l=0; l < p; ++l) {
+      out[2*(k*SIMD_SZ + l + q*Ncvec) + 0] = v[(2*q+0)*stride + l];
+      out[2*(k*SIMD_SZ + l + q*Ncvec) + 1] = v[(2*q+1)*stride + l];
+    }
+  }
+}
+
+static void cplx_load_ordered_partial(int Ncvec, int k, const pffft_float *in, pffft_float *v, int stride, int p) {
+  int q, l;
+  for (q=0; q < SIMD_SZ; ++q) {
+    for (l=0; l < p; ++l) {
+      v[(2*q+0)*stride + l] = in[2*(k*SIMD_SZ + l + q*Ncvec) + 0];
+      v[(2*q+1)*stride + l] = in[2*(k*SIMD_SZ + l + q*Ncvec) + 1];
+    }
+  }
+}
+
+/* the partial last block (p valid lanes, stored contiguously, see
+   real_slot_index) to / from its 2*SIMD_SZ vectors v[]. The stores are
+   scalar copies of the first lanes (as in pffft_zconvolve_accumulate).
+   The loads are full-width unaligned loads, whose lanes past p are
+   garbage that the lane-wise steps carry without storing it, except for
+   the last vectors, which would read past the end of the block: only
+   these use a masked load (a scalar fill of v[] would stall on the store
+   forwarding, and costs more than the whole block) */
+static void block_store_partial(const v4sf *v, int p, pffft_float *out) {
+  const pffft_float *f = (const pffft_float*)v;
+  int j, l;
+  for (j=0; j < 2*SIMD_SZ; ++j) {
+    for (l=0; l < p; ++l) out[j*p + l] = f[j*SIMD_SZ + l];
+  }
+}
+
+static ALWAYS_INLINE(void) block_load_partial(const pffft_float *in, int p, v4sf *v) {
+  int j;
+  for (j=0; j < 2*SIMD_SZ; ++j) {
+    v[j] = (j*p + SIMD_SZ <= 2*SIMD_SZ*p ? VLOADU(in + j*p) : VLOAD_PARTIAL(in + j*p, p));
+  }
+}
+
+static void real_zreorder_forward(int N, const v4sf *vin, pffft_float *out) {
+  int k, L = N/SIMD_SZ, dk = N/(2*SIMD_SZ*SIMD_SZ), p = (L/2)%SIMD_SZ;
+  for (k=0; k < dk; ++k) real_store_ordered(L, k, vin + 2*k*SIMD_SZ, out);
+  if (p) real_store_ordered_partial(L, dk, (const pffft_float*)(vin + 2*dk*SIMD_SZ), p, p, out);
+}
+
+static void real_zreorder_backward(int N, const pffft_float *in, v4sf *vout) {
+  int k, L = N/SIMD_SZ, dk = N/(2*SIMD_SZ*SIMD_SZ), p = (L/2)%SIMD_SZ;
+  for (k=0; k < dk; ++k) real_load_ordered(L, k, in, vout + 2*k*SIMD_SZ);
+  if (p) real_load_ordered_partial(L, dk, in, (pffft_float*)(vout + 2*dk*SIMD_SZ), p, p);
+}
+
+static void cplx_zreorder_forward(int Ncvec, const v4sf *vin, pffft_float *out) {
+  int k, dk = Ncvec/SIMD_SZ, p = Ncvec%SIMD_SZ;
+  for (k=0; k < dk; ++k) cplx_store_ordered(Ncvec, k, vin + 2*k*SIMD_SZ, out);
+  if (p) cplx_store_ordered_partial(Ncvec, dk, (const pffft_float*)(vin + 2*dk*SIMD_SZ), p, p, out);
+}
+
+static void cplx_zreorder_backward(int Ncvec, const pffft_float *in, v4sf *vout) {
+  int k, dk = Ncvec/SIMD_SZ, p = Ncvec%SIMD_SZ;
+  for (k=0; k < dk; ++k) cplx_load_ordered(Ncvec, k, in, vout + 2*k*SIMD_SZ);
+  if (p) cplx_load_ordered_partial(Ncvec, dk, in, (pffft_float*)(vout + 2*dk*SIMD_SZ), p, p);
+}
+#endif // SIMD_SZ != 4
+
+static void pffft_zreorder(PFFFT_Setup *setup, const pffft_float *in, pffft_float *out, pffft_direction_t direction) {
+  int N = setup->N, Ncvec = setup->Ncvec;
+  const v4sf *vin = (const v4sf*)in;
+  v4sf *vout = (v4sf*)out;
+  assert(in != out);
+  if (setup->transform == PFFFT_REAL) {
+#if SIMD_SZ == 4
+    int k, dk = N/32;
+    if (direction == PFFFT_FORWARD) {
+      for (k=0; k < dk; ++k) {
+        INTERLEAVE2(vin[k*8 + 0], vin[k*8 + 1], vout[2*(0*dk + k) + 0], vout[2*(0*dk + k) + 1]);
+        INTERLEAVE2(vin[k*8 + 4], vin[k*8 + 5], vout[2*(2*dk + k) + 0], vout[2*(2*dk + k) + 1]);
+      }
+      reversed_copy(dk, vin+2, 8, (v4sf*)(out + N/2));
+      reversed_copy(dk, vin+6, 8, (v4sf*)(out + N));
+    } else {
+      for (k=0; k < dk; ++k) {
+        UNINTERLEAVE2(vin[2*(0*dk + k) + 0], vin[2*(0*dk + k) + 1], vout[k*8 + 0], vout[k*8 + 1]);
+        UNINTERLEAVE2(vin[2*(2*dk + k) + 0], vin[2*(2*dk + k) + 1], vout[k*8 + 4], vout[k*8 + 5]);
+      }
+      unreversed_copy(dk, (v4sf*)(in + N/4), (v4sf*)(out + N - 6*SIMD_SZ), -8);
+      unreversed_copy(dk, (v4sf*)(in + 3*N/4), (v4sf*)(out + N - 2*SIMD_SZ), -8);
+    }
+#else
+    if (direction == PFFFT_FORWARD) {
+      real_zreorder_forward(N, vin, out);
+    } else {
+      real_zreorder_backward(N, in, vout);
+    }
+#endif
+  } else {
+#if SIMD_SZ == 4
+    int k;
+    if (direction == PFFFT_FORWARD) {
+      for (k=0; k < Ncvec; ++k) { 
+        int kk = (k/4) + (k%4)*(Ncvec/4);
+        INTERLEAVE2(vin[k*2], vin[k*2+1], vout[kk*2], vout[kk*2+1]);
+      }
+    } else {
+      for (k=0; k < Ncvec; ++k) { 
+        int kk = (k/4) + (k%4)*(Ncvec/4);
+        UNINTERLEAVE2(vin[kk*2], vin[kk*2+1], vout[k*2], vout[k*2+1]);
+      }
+    }
+#else
+    if (direction == PFFFT_FORWARD) {
+      cplx_zreorder_forward(Ncvec, vin, out);
+    } else {
+      cplx_zreorder_backward(Ncvec, in, vout);
+    }
+#endif
+  }
+}
+
+#ifndef PFFFT_DOUBLE
+/*
+  |X(k)|^2 from a forward transform in the internal layout, for k = 0 ..
+  N/2 (real transforms) or N-1 (complex ones): the squared magnitudes are
+  computed on the simd vectors of the internal layout, and put in order
+  afterwards (see real_slot_index), so that only the real results
+  are moved.
+*/
+#ifdef VSTOREU
+#  define POWER_STOREU(ptr, vec) VSTOREU(ptr, vec)
+#else /* altivec: no unaligned stores */
+#  define POWER_STOREU(ptr, vec) { v4sf_union u__; u__.v = (vec); for (l=0; l < SIMD_SZ; ++l) (ptr)[l] = u__.f[l]; }
+#endif
+static void pffft_power_spectrum(PFFFT_Setup *s, const pffft_float *spectrum, pffft_float *power) {
+  const v4sf *vin = (const v4sf*)spectrum;
+  int N = s->N, Ncvec = s->Ncvec, k, t, l;
+  if (s->transform == PFFFT_REAL) {
+    int L = N/SIMD_SZ, dk = N/(2*SIMD_SZ*SIMD_SZ), p0 = SIMD_SZ;
+    for (k=0; k < dk; ++k, vin += 2*SIMD_SZ) {
+      for (t=0; t < SIMD_SZ/2; ++t) {
+        v4sf_union po;
+        POWER_STOREU(power + t*L + k*SIMD_SZ, VMADD(vin[4*t], vin[4*t], VMUL(vin[4*t+1], vin[4*t+1])));
+        po.v = VMADD(vin[4*t+2], vin[4*t+2], VMUL(vin[4*t+3], vin[4*t+3]));
+        if (k == 0) {
+          for (l=1; l < SIMD_SZ; ++l) power[(t+1)*L - l] = po.f[l];
+          power[t*L + L/2] = po.f[0];
+        } else {
+#if defined(VREV) && defined(VSTOREU)
+          VSTOREU(power + (t+1)*L - k*SIMD_SZ - (SIMD_SZ-1), VREV(po.v));
+#else
+          for (l=0; l < SIMD_SZ; ++l) power[(t+1)*L - k*SIMD_SZ - l] = po.f[l];
+#endif
+        }
+      }
+    }
+#if SIMD_SZ != 4
+    {
+      const pffft_float *in = (const pffft_float*)vin;
+      int p = (L/2)%SIMD_SZ;
+      if (dk == 0) p0 = p;
+      for (t=0; t < SIMD_SZ && p; ++t) {
+        for (l=0; l < p; ++l) {
+          pffft_float re = in[(2*t+0)*p + l], im = in[(2*t+1)*p + l];
+          power[real_slot_index(L, t, dk*SIMD_SZ + l)] = re*re + im*im;
+        }
+      }
+    }
+#endif
+    /* X(0) + i*X(N/2) in the first lane */
+    power[0] = spectrum[0]*spectrum[0];
+    power[N/2] = spectrum[p0]*spectrum[p0];
+  } else {
+    int q, dk = Ncvec/SIMD_SZ;
+    for (k=0; k < dk; ++k, vin += 2*SIMD_SZ) {
+      for (q=0; q < SIMD_SZ; ++q) {
+        POWER_STOREU(power + k*SIMD_SZ + q*Ncvec, VMADD(vin[2*q], vin[2*q], VMUL(vin[2*q+1], vin[2*q+1])));
+      }
+    }
+#if SIMD_SZ != 4
+    {
+      const pffft_float *in = (const pffft_float*)vin;
+      int p = Ncvec%SIMD_SZ;
+      for (q=0; q < SIMD_SZ && p; ++q) {
+        for (l=0; l < p; ++l) {
+          pffft_float re = in[(2*q+0)*p + l], im = in[(2*q+1)*p + l];
+          power[dk*SIMD_SZ + l + q*Ncvec] = re*re + im*im;
+        }
+      }
+    }
+#endif
+  }
+}
+#endif
+
+#if SIMD_SZ == 4
+/* with 'ordered', the blocks go straight to their place in the canonical
+   order, as pffft_zreorder would put them, instead of the internal layout */
+static void pffft_cplx_finalize(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e, int ordered) {
+  int k, dk = Ncvec/SIMD_SZ; // number of 4x4 matrix blocks
+  v4sf r0, i0, r1, i1, r2, i2, r3, i3;
+  v4sf sr0, dr0, sr1, dr1, si0, di0, si1, di1;
+  assert(in != out);
+  for (k=0; k < dk; ++k) {    
+    r0 = in[8*k+0]; i0 = in[8*k+1];
+    r1 = in[8*k+2]; i1 = in[8*k+3];
+    r2 = in[8*k+4]; i2 = in[8*k+5];
+    r3 = in[8*k+6]; i3 = in[8*k+7];
+    VTRANSPOSE4(r0,r1,r2,r3);
+    VTRANSPOSE4(i0,i1,i2,i3);
+    VCPLXMUL(r1,i1,e[k*6+0],e[k*6+1]);
+    VCPLXMUL(r2,i2,e[k*6+2],e[k*6+3]);
+    VCPLXMUL(r3,i3,e[k*6+4],e[k*6+5]);
+
+    sr0 = VADD(r0,r2); dr0 = VSUB(r0, r2);
+    sr1 = VADD(r1,r3); dr1 = VSUB(r1, r3);
+    si0 = VADD(i0,i2); di0 = VSUB(i0, i2);
+    si1 = VADD(i1,i3); di1 = VSUB(i1, i3);
+
+    /*
+      transformation for each column is:
+      
+      [1   1   1   1   0   0   0   0]   [r0]
+      [1   0  -1   0   0  -1   0   1]   [r1]
+      [1  -1   1  -1   0   0   0   0]   [r2]
+      [1   0  -1   0   0   1   0  -1]   [r3]
+      [0   0   0   0   1   1   1   1] * [i0]
+      [0   1   0  -1   1   0  -1   0]   [i1]
+      [0   0   0   0   1  -1   1  -1]   [i2]
+      [0  -1   0   1   1   0  -1   0]   [i3]    
+    */
+    
+    r0 = VADD(sr0, sr1); i0 = VADD(si0, si1);
+    r1 = VADD(dr0, di1); i1 = VSUB(di0, dr1);
+    r2 = VSUB(sr0, sr1); i2 = VSUB(si0, si1);
+    r3 = VSUB(dr0, di1); i3 = VADD(di0, dr1);
+  
+    if (ordered) {
+      v4sf *o = out + 2*k;
+      INTERLEAVE2(r0, i0, o[0], o[1]); o += Ncvec/2;
+      INTERLEAVE2(r1, i1, o[0], o[1]); o += Ncvec/2;
+      INTERLEAVE2(r2, i2, o[0], o[1]); o += Ncvec/2;
+      INTERLEAVE2(r3, i3, o[0], o[1]);
+    } else {
+      *out++ = r0; *out++ = i0; *out++ = r1; *out++ = i1;
+      *out++ = r2; *out++ = i2; *out++ = r3; *out++ = i3;
+    }
+  }
+}
+
+/* with 'ordered', the blocks are gathered from the canonical order */
+static void pffft_cplx_preprocess(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e, int ordered) {
+  int k, dk = Ncvec/SIMD_SZ; // number of 4x4 matrix blocks
+  v4sf r0, i0, r1, i1, r2, i2, r3, i3;
+  v4sf sr0, dr0, sr1, dr1, si0, di0, si1, di1;
+  assert(in != out);
+  for (k=0; k < dk; ++k) {    
+    if (ordered) {
+      const v4sf *o = in + 2*k;
+      UNINTERLEAVE2(o[0], o[1], r0, i0); o += Ncvec/2;
+      UNINTERLEAVE2(o[0], o[1], r1, i1); o += Ncvec/2;
+      UNINTERLEAVE2(o[0], o[1], r2, i2); o += Ncvec/2;
+      UNINTERLEAVE2(o[0], o[1], r3, i3);
+    } else {
+      r0 = in[8*k+0]; i0 = in[8*k+1];
+      r1 = in[8*k+2]; i1 = in[8*k+3];
+      r2 = in[8*k+4]; i2 = in[8*k+5];
+      r3 = in[8*k+6]; i3 = in[8*k+7];
+    }
+
+    sr0 = VADD(r0,r2); dr0 = VSUB(r0, r2);
+    sr1 = VADD(r1,r3); dr1 = VSUB(r1, r3);
+    si0 = VADD(i0,i2); di0 = VSUB(i0, i2);
+    si1 = VADD(i1,i3); di1 = VSUB(i1, i3);
+
+    r0 = VADD(sr0, sr1); i0 = VADD(si0, si1);
+    r1 = VSUB(dr0, di1); i1 = VADD(di0, dr1);
+    r2 = VSUB(sr0, sr1); i2 = VSUB(si0, si1);
+    r3 = VADD(dr0, di1); i3 = VSUB(di0, dr1);
+
+    VCPLXMULCONJ(r1,i1,e[k*6+0],e[k*6+1]);
+    VCPLXMULCONJ(r2,i2,e[k*6+2],e[k*6+3]);
+    VCPLXMULCONJ(r3,i3,e[k*6+4],e[k*6+5]);
+
+    VTRANSPOSE4(r0,r1,r2,r3);
+    VTRANSPOSE4(i0,i1,i2,i3);
+
+    *out++ = r0; *out++ = i0; *out++ = r1; *out++ = i1;
+    *out++ = r2; *out++ = i2; *out++ = r3; *out++ = i3;
+  }
+}
+
+
+static ALWAYS_INLINE(void) pffft_real_finalize_4x4(const v4sf *in0, const v4sf *in1, const v4sf *in,
+                            const v4sf *e, v4sf *out) {
+  v4sf r0, i0, r1, i1, r2, i2, r3, i3;
+  v4sf sr0, dr0, sr1, dr1, si0, di0, si1, di1;
+  r0 = *in0; i0 = *in1;
+  r1 = *in++; i1 = *in++; r2 = *in++; i2 = *in++; r3 = *in++; i3 = *in++;
+  VTRANSPOSE4(r0,r1,r2,r3);
+  VTRANSPOSE4(i0,i1,i2,i3);
+ 
+  /*
+    transformation for each column is:
+
+    [1   1   1   1   0   0   0   0]   [r0]
+    [1   0  -1   0   0  -1   0   1]   [r1]
+    [1   0  -1   0   0   1   0  -1]   [r2]
+    [1  -1   1  -1   0   0   0   0]   [r3]
+    [0   0   0   0   1   1   1   1] * [i0]
+    [0  -1   0   1  -1   0   1   0]   [i1]
+    [0  -1   0   1   1   0  -1   0]   [i2]
+    [0   0   0   0  -1   1  -1   1]   [i3]    
+  */
+  
+  //cerr << "matrix initial, before e , REAL:\n 1: " << r0 << "\n 1: " << r1 << "\n 1: " << r2 << "\n 1: " << r3 << "\n";
+  //cerr << "matrix initial, before e, IMAG :\n 1: " << i0 << "\n 1: " << i1 << "\n 1: " << i2 << "\n 1: " << i3 << "\n";
+
+  VCPLXMUL(r1,i1,e[0],e[1]);
+  VCPLXMUL(r2,i2,e[2],e[3]);
+  VCPLXMUL(r3,i3,e[4],e[5]);
+
+  //cerr << "matrix initial, real part:\n 1: " << r0 << "\n 1: " << r1 << "\n 1: " << r2 << "\n 1: " << r3 << "\n";
+  //cerr << "matrix initial, imag part:\n 1: " << i0 << "\n 1: " << i1 << "\n 1: " << i2 << "\n 1: " << i3 << "\n";
+
+  sr0 = VADD(r0,r2); dr0 = VSUB(r0,r2); 
+  sr1 = VADD(r1,r3); dr1 = VSUB(r3,r1);
+  si0 = VADD(i0,i2); di0 = VSUB(i0,i2); 
+  si1 = VADD(i1,i3); di1 = VSUB(i3,i1);
+
+  r0 = VADD(sr0, sr1);
+  r3 = VSUB(sr0, sr1);
+  i0 = VADD(si0, si1);
+  i3 = VSUB(si1, si0);
+  r1 = VADD(dr0, di1);
+  r2 = VSUB(dr0, di1);
+  i1 = VSUB(dr1, di0);
+  i2 = VADD(dr1, di0);
+
+  *out++ = r0;
+  *out++ = i0;
+  *out++ = r1;
+  *out++ = i1;
+  *out++ = r2;
+  *out++ = i2;
+  *out++ = r3;
+  *out++ = i3;
+
+}
+
+/* with 'ordered', the blocks go straight to their place in the canonical
+   order, with the stores of pffft_zreorder: the odd slots are reversed as in
+   reversed_copy, each block completing the vectors started by the previous
+   one */
+static NEVER_INLINE(void) pffft_real_finalize(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e, int ordered) {
+  int k, L = 2*Ncvec, dk = Ncvec/SIMD_SZ; // number of 4x4 matrix blocks
+  /* fftpack order is f0r f1r f1i f2r f2i ... f(n-1)r f(n-1)i f(n)r */
+
+  v4sf_union cr, ci, *uout = (v4sf_union*)out;
+  v4sf save = in[7], zero=VZERO();
+  pffft_float x[8], *fout = (pffft_float*)out;
+  static const pffft_float s = (pffft_float)M_SQRT2/2;
+
+  cr.v = in[0]; ci.v = in[Ncvec*2-1];
+  assert(in != out);
+  if (ordered) {
+    v4sf *o1 = out + Ncvec, *o3 = out + 2*Ncvec, g0[2], g1[2];
+    g0[0] = g0[1] = g1[0] = g1[1] = zero;
+    for (k=0; k < dk; ++k) {
+      v4sf v[8], h0, h1;
+      pffft_real_finalize_4x4(k ? in + 8*k-1 : &zero, k ? in + 8*k : &zero, in + 8*k+1, e + k*6, v);
+      INTERLEAVE2(v[0], v[1], out[2*k], out[2*k+1]);
+      INTERLEAVE2(v[4], v[5], out[Ncvec + 2*k], out[Ncvec + 2*k+1]);
+      INTERLEAVE2(v[2], v[3], h0, h1);
+      if (k == 0) g0[0] = h0; else *--o1 = VSWAPHL(g1[0], h0);
+      *--o1 = VSWAPHL(h0, h1);
+      g1[0] = h1;
+      INTERLEAVE2(v[6], v[7], h0, h1);
+      if (k == 0) g0[1] = h0; else *--o3 = VSWAPHL(g1[1], h0);
+      *--o3 = VSWAPHL(h0, h1);
+      g1[1] = h1;
+    }
+    *--o1 = VSWAPHL(g1[0], g0[0]);
+    *--o3 = VSWAPHL(g1[1], g0[1]);
+  } else {
+    pffft_real_finalize_4x4(&zero, &zero, in+1, e, out);
+  }
+
+  /*
+    [cr0 cr1 cr2 cr3 ci0 ci1 ci2 ci3]
+
+    [Xr(1)]  ] [1   1   1   1   0   0   0   0]
+    [Xr(N/4) ] [0   0   0   0   1   s   0  -s]
+    [Xr(N/2) ] [1   0  -1   0   0   0   0   0]
+    [Xr(3N/4)] [0   0   0   0   1  -s   0   s]
+    [Xi(1)   ] [1  -1   1  -1   0   0   0   0]
+    [Xi(N/4) ] [0   0   0   0   0  -s  -1  -s]
+    [Xi(N/2) ] [0  -1   0   1   0   0   0   0]
+    [Xi(3N/4)] [0   0   0   0   0  -s   1  -s]
+  */
+
+  x[0]=(cr.f[0]+cr.f[2]) + (cr.f[1]+cr.f[3]); /* xr0 */
+  x[1]=(cr.f[0]+cr.f[2]) - (cr.f[1]+cr.f[3]); /* xi0 */
+  x[4]=(cr.f[0]-cr.f[2]);                     /* xr2 */
+  x[5]=(cr.f[3]-cr.f[1]);                     /* xi2 */
+  x[2]= ci.f[0] + s*(ci.f[1]-ci.f[3]);        /* xr1 */
+  x[3]=-ci.f[2] - s*(ci.f[1]+ci.f[3]);        /* xi1 */
+  x[6]= ci.f[0] - s*(ci.f[1]-ci.f[3]);        /* xr3 */
+  x[7]= ci.f[2] - s*(ci.f[1]+ci.f[3]);        /* xi3 */
+  for (k=0; k < 4; ++k) {
+    if (ordered) {
+      fout[2*real_slot_index(L, k, 0)] = x[2*k]; fout[2*real_slot_index(L, k, 0)+1] = x[2*k+1];
+    } else {
+      uout[2*k].f[0] = x[2*k]; uout[2*k+1].f[0] = x[2*k+1];
+    }
+  }
+
+  for (k=1; k < dk && !ordered; ++k) {
+    v4sf save_next = in[8*k+7];
+    pffft_real_finalize_4x4(&save, &in[8*k+0], in + 8*k+1,
+                           e + k*6, out + k*8);
+    save = save_next;
+  }
+
+}
+
+static ALWAYS_INLINE(void) pffft_real_preprocess_4x4(const v4sf *in, 
+                                             const v4sf *e, v4sf *out, int first) {
+  v4sf r0=in[0], i0=in[1], r1=in[2], i1=in[3], r2=in[4], i2=in[5], r3=in[6], i3=in[7];
+  /*
+    transformation for each column is:
+
+    [1   1   1   1   0   0   0   0]   [r0]
+    [1   0   0  -1   0  -1  -1   0]   [r1]
+    [1  -1  -1   1   0   0   0   0]   [r2]
+    [1   0   0  -1   0   1   1   0]   [r3]
+    [0   0   0   0   1  -1   1  -1] * [i0]
+    [0  -1   1   0   1   0   0   1]   [i1]
+    [0   0   0   0   1   1  -1  -1]   [i2]
+    [0   1  -1   0   1   0   0   1]   [i3]    
+  */
+
+  v4sf sr0 = VADD(r0,r3), dr0 = VSUB(r0,r3); 
+  v4sf sr1 = VADD(r1,r2), dr1 = VSUB(r1,r2);
+  v4sf si0 = VADD(i0,i3), di0 = VSUB(i0,i3); 
+  v4sf si1 = VADD(i1,i2), di1 = VSUB(i1,i2);
+
+  r0 = VADD(sr0, sr1);
+  r2 = VSUB(sr0, sr1);
+  r1 = VSUB(dr0, si1);
+  r3 = VADD(dr0, si1);
+  i0 = VSUB(di0, di1);
+  i2 = VADD(di0, di1);
+  i1 = VSUB(si0, dr1);
+  i3 = VADD(si0, dr1);
+
+  VCPLXMULCONJ(r1,i1,e[0],e[1]);
+  VCPLXMULCONJ(r2,i2,e[2],e[3]);
+  VCPLXMULCONJ(r3,i3,e[4],e[5]);
+
+  VTRANSPOSE4(r0,r1,r2,r3);
+  VTRANSPOSE4(i0,i1,i2,i3);
+
+  if (!first) {
+    *out++ = r0;
+    *out++ = i0;
+  }
+  *out++ = r1;
+  *out++ = i1;
+  *out++ = r2;
+  *out++ = i2;
+  *out++ = r3;
+  *out++ = i3;
+}
+
+/* with 'ordered', the blocks are gathered from the canonical order, with the
+   loads of pffft_zreorder (see unreversed_copy) */
+static NEVER_INLINE(void) pffft_real_preprocess(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e, int ordered) {
+  int k, L = 2*Ncvec, dk = Ncvec/SIMD_SZ; // number of 4x4 matrix blocks
+  /* fftpack order is f0r f1r f1i f2r f2i ... f(n-1)r f(n-1)i f(n)r */
+
+  v4sf_union Xr, Xi, *uout = (v4sf_union*)out;
+  const pffft_float *fin = (const pffft_float*)in;
+  pffft_float cr0, ci0, cr1, ci1, cr2, ci2, cr3, ci3;
+  static const pffft_float s = (pffft_float)M_SQRT2;
+  assert(in != out);
+  for (k=0; k < 4; ++k) {
+    int o = ordered ? 2*real_slot_index(L, k, 0) : 8*k;
+    Xr.f[k] = fin[o];
+    Xi.f[k] = fin[o + (ordered ? 1 : 4)];
+  }
+  if (ordered == PFFFT_HALF_SPECTRUM) Xi.f[0] = fin[4*L]; /* X(N/2) at the end */
+
+  if (ordered) {
+    const v4sf *i1 = in + Ncvec, *i3 = in + 2*Ncvec;
+    v4sf c1 = in[Ncvec/2], c3 = in[3*Ncvec/2];
+    for (k=0; k < dk; ++k) {
+      v4sf v[8], a, b;
+      UNINTERLEAVE2(in[2*k], in[2*k+1], v[0], v[1]);
+      UNINTERLEAVE2(in[Ncvec + 2*k], in[Ncvec + 2*k+1], v[4], v[5]);
+      b = *--i1; a = *--i1;
+      UNINTERLEAVE2(VSWAPHL(b, c1), VSWAPHL(a, b), v[2], v[3]);
+      c1 = a;
+      b = *--i3; a = *--i3;
+      UNINTERLEAVE2(VSWAPHL(b, c3), VSWAPHL(a, b), v[6], v[7]);
+      c3 = a;
+      if (k == 0) pffft_real_preprocess_4x4(v, e, out+1, 1);
+      else pffft_real_preprocess_4x4(v, e + k*6, out-1+k*8, 0);
+    }
+  } else {
+    pffft_real_preprocess_4x4(in, e, out+1, 1); // will write only 6 values
+  }
+
+  /*
+    [Xr0 Xr1 Xr2 Xr3 Xi0 Xi1 Xi2 Xi3]
+
+    [cr0] [1   0   2   0   1   0   0   0]
+    [cr1] [1   0   0   0  -1   0  -2   0]
+    [cr2] [1   0  -2   0   1   0   0   0]
+    [cr3] [1   0   0   0  -1   0   2   0]
+    [ci0] [0   2   0   2   0   0   0   0]
+    [ci1] [0   s   0  -s   0  -s   0  -s]
+    [ci2] [0   0   0   0   0  -2   0   2]
+    [ci3] [0  -s   0   s   0  -s   0  -s]
+  */
+  for (k=1; k < dk && !ordered; ++k) {    
+    pffft_real_preprocess_4x4(in+8*k, e + k*6, out-1+k*8, 0);
+  }
+
+  cr0=(Xr.f[0]+Xi.f[0]) + 2*Xr.f[2]; uout[0].f[0] = cr0;
+  cr1=(Xr.f[0]-Xi.f[0]) - 2*Xi.f[2]; uout[0].f[1] = cr1;
+  cr2=(Xr.f[0]+Xi.f[0]) - 2*Xr.f[2]; uout[0].f[2] = cr2;
+  cr3=(Xr.f[0]-Xi.f[0]) + 2*Xi.f[2]; uout[0].f[3] = cr3;
+  ci0= 2*(Xr.f[1]+Xr.f[3]);                       uout[2*Ncvec-1].f[0] = ci0;
+  ci1= s*(Xr.f[1]-Xr.f[3]) - s*(Xi.f[1]+Xi.f[3]); uout[2*Ncvec-1].f[1] = ci1;
+  ci2= 2*(Xi.f[3]-Xi.f[1]);                       uout[2*Ncvec-1].f[2] = ci2;
+  ci3=-s*(Xr.f[1]-Xr.f[3]) - s*(Xi.f[1]+Xi.f[3]); uout[2*Ncvec-1].f[3] = ci3;
+}
+
+#else // SIMD_SZ != 4
+
+/*
+  Generic versions of the finalize / preprocess functions, for vectors that
+  do not hold 4 elements. Each lane of the simd vectors went through its own fft of
+  length N/SIMD_SZ, these SIMD_SZ sub-ffts are combined with a SIMD_SZ-point
+  dft: a block of SIMD_SZ complex vectors is transposed, so that each vector
+  holds SIMD_SZ consecutive frequencies of one sub-fft, the twiddles from 'e'
+  are applied and the dft is performed across the vectors.
+*/
+
+/* cos(2*pi*k/32), the lane dfts only need multiples of 2*pi/(2*SIMD_SZ) */
+static const pffft_float lane_cos32[32] = {
+  1.0000000000000000,  0.9807852804032304,  0.9238795325112868,  0.8314696123025452,
+  0.7071067811865475,  0.5555702330196022,  0.3826834323650898,  0.1950903220161283,
+  0.0000000000000000, -0.1950903220161283, -0.3826834323650898, -0.5555702330196022,
+ -0.7071067811865475, -0.8314696123025452, -0.9238795325112868, -0.9807852804032304,
+ -1.0000000000000000, -0.9807852804032304, -0.9238795325112868, -0.8314696123025452,
+ -0.7071067811865475, -0.5555702330196022, -0.3826834323650898, -0.1950903220161283,
+  0.0000000000000000,  0.1950903220161283,  0.3826834323650898,  0.5555702330196022,
+  0.7071067811865475,  0.8314696123025452,  0.9238795325112868,  0.9807852804032304
+};
+#define LANE_COS(k, n) lane_cos32[((k)*(32/(n))) & 31]     /* cos(2*pi*k/n) */
+#define LANE_SIN(k, n) lane_cos32[((k)*(32/(n)) - 8) & 31] /* sin(2*pi*k/n) */
+
+/* one radix-2 pass of the stockham autosort dft across the vectors r[], i[] */
+static ALWAYS_INLINE(void) lane_dft_pass(v4sf *r, v4sf *i, int l, int m, pffft_float sign) {
+  v4sf yr[SIMD_SZ], yi[SIMD_SZ];
+  int j, k;
+  for (j=0; j < l; ++j) {
+    for (k=0; k < m; ++k) {
+      v4sf ar = r[k + j*m], ai = i[k + j*m];
+      v4sf br = r[k + j*m + l*m], bi = i[k + j*m + l*m];
+      v4sf dr = VSUB(ar, br), di = VSUB(ai, bi);
+      yr[k + 2*j*m] = VADD(ar, br);
+      yi[k + 2*j*m] = VADD(ai, bi);
+      if (2*j == l) { /* multiplication by -i (forward) or +i */
+        v4sf tmp = dr;
+        if (sign < 0) { dr = di; di = VSUB(VZERO(), tmp); }
+        else { dr = VSUB(VZERO(), di); di = tmp; }
+      } else if (j) {
+        VCPLXMUL(dr, di, LD_PS1(LANE_COS(j, 2*l)), LD_PS1(sign*LANE_SIN(j, 2*l)));
+      }
+      yr[k + 2*j*m + m] = dr;
+      yi[k + 2*j*m + m] = di;
+    }
+  }
+  for (k=0; k < SIMD_SZ; ++k) { r[k] = yr[k]; i[k] = yi[k]; }
+}
+
+/* in-place SIMD_SZ-point dft across the vectors r[], i[], sign = -1 for the
+   forward dft, +1 for the backward one. The passes are spelled out so that
+   all loops have constant bounds and everything stays in registers */
+static ALWAYS_INLINE(void) lane_dft(v4sf *r, v4sf *i, pffft_float sign) {
+  lane_dft_pass(r, i, SIMD_SZ/2, 1, sign);
+#if SIMD_SZ >= 4
+  lane_dft_pass(r, i, SIMD_SZ/4, 2, sign);
+#endif
+#if SIMD_SZ >= 8
+  lane_dft_pass(r, i, SIMD_SZ/8, 4, sign);
+#endif
+#if SIMD_SZ == 16
+  lane_dft_pass(r, i, 1, 8, sign);
+#endif
+}
+
+/* the last block is partial when Ncvec is not a multiple of SIMD_SZ, its p
+   vectors are zero-padded, and the p first lanes of its output vectors are
+   copied from a local block (see the layout described above
+   real_slot_index). With 'ordered', the blocks go straight to their place
+   in the canonical order instead */
+static void pffft_cplx_finalize(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e, int ordered) {
+  int k, j, dk = Ncvec/SIMD_SZ, p = Ncvec%SIMD_SZ; // number of SIMD_SZ x SIMD_SZ matrix blocks
+  v4sf r[SIMD_SZ], i[SIMD_SZ], blk[2*SIMD_SZ];
+  pffft_float *canon = (pffft_float*)out;
+  assert(in != out);
+  for (k=0; k < dk; ++k, in += 2*SIMD_SZ, out += 2*SIMD_SZ, e += 2*(SIMD_SZ-1)) {
+    for (j=0; j < SIMD_SZ; ++j) { r[j] = in[2*j]; i[j] = in[2*j+1]; }
+    VTRANSPOSE(r);
+    VTRANSPOSE(i);
+    for (j=1; j < SIMD_SZ; ++j) VCPLXMUL(r[j], i[j], e[2*j-2], e[2*j-1]);
+    lane_dft(r, i, -1.f);
+    if (ordered) {
+      for (j=0; j < SIMD_SZ; ++j) { blk[2*j] = r[j]; blk[2*j+1] = i[j]; }
+      cplx_store_ordered(Ncvec, k, blk, canon);
+    } else {
+      for (j=0; j < SIMD_SZ; ++j) { out[2*j] = r[j]; out[2*j+1] = i[j]; }
+    }
+  }
+  if (p) {
+    pffft_float *fout = (pffft_float*)out;
+    for (j=0; j < SIMD_SZ; ++j) { r[j] = j < p ? in[2*j] : VZERO(); i[j] = j < p ? in[2*j+1] : VZERO(); }
+    VTRANSPOSE(r);
+    VTRANSPOSE(i);
+    for (j=1; j < SIMD_SZ; ++j) VCPLXMUL(r[j], i[j], e[2*j-2], e[2*j-1]);
+    lane_dft(r, i, -1.f);
+    for (j=0; j < SIMD_SZ; ++j) { blk[2*j] = r[j]; blk[2*j+1] = i[j]; }
+    if (ordered) {
+      cplx_store_ordered_partial(Ncvec, dk, (const pffft_float*)blk, SIMD_SZ, p, canon);
+    } else {
+      block_store_partial(blk, p, fout);
+    }
+  }
+}
+
+/* with 'ordered', the blocks are gathered from the canonical order */
+static void pffft_cplx_preprocess(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e, int ordered) {
+  int k, j, dk = Ncvec/SIMD_SZ, p = Ncvec%SIMD_SZ; // number of SIMD_SZ x SIMD_SZ matrix blocks
+  v4sf r[SIMD_SZ], i[SIMD_SZ], blk[2*SIMD_SZ];
+  const pffft_float *canon = (const pffft_float*)in;
+  assert(in != out);
+  for (k=0; k < dk; ++k, in += 2*SIMD_SZ, out += 2*SIMD_SZ, e += 2*(SIMD_SZ-1)) {
+    const v4sf *bin = in;
+    if (ordered) { cplx_load_ordered(Ncvec, k, canon, blk); bin = blk; }
+    for (j=0; j < SIMD_SZ; ++j) { r[j] = bin[2*j]; i[j] = bin[2*j+1]; }
+    lane_dft(r, i, +1.f);
+    for (j=1; j < SIMD_SZ; ++j) VCPLXMULCONJ(r[j], i[j], e[2*j-2], e[2*j-1]);
+    VTRANSPOSE(r);
+    VTRANSPOSE(i);
+    for (j=0; j < SIMD_SZ; ++j) { out[2*j] = r[j]; out[2*j+1] = i[j]; }
+  }
+  if (p) {
+    if (ordered) {
+      for (j=0; j < 2*SIMD_SZ; ++j) blk[j] = VZERO();
+      cplx_load_ordered_partial(Ncvec, dk, canon, (pffft_float*)blk, SIMD_SZ, p);
+    } else {
+      block_load_partial((const pffft_float*)in, p, blk);
+    }
+    for (j=0; j < SIMD_SZ; ++j) { r[j] = blk[2*j]; i[j] = blk[2*j+1]; }
+    lane_dft(r, i, +1.f);
+    for (j=1; j < SIMD_SZ; ++j) VCPLXMULCONJ(r[j], i[j], e[2*j-2], e[2*j-1]);
+    VTRANSPOSE(r);
+    VTRANSPOSE(i);
+    for (j=0; j < p; ++j) { out[2*j] = r[j]; out[2*j+1] = i[j]; }
+  }
+}
+
+/* r[j], i[j] hold X_j(m) for the SIMD_SZ frequencies of the block, see the
+   description of the layout above real_slot_index */
+static ALWAYS_INLINE(void) pffft_real_finalize_block(v4sf *r, v4sf *i, const v4sf *e, v4sf *out) {
+  int j;
+  VTRANSPOSE(r);
+  VTRANSPOSE(i);
+  for (j=1; j < SIMD_SZ; ++j) VCPLXMUL(r[j], i[j], e[2*j-2], e[2*j-1]);
+  lane_dft(r, i, -1.f);
+  for (j=0; j < SIMD_SZ/2; ++j) {
+    out[4*j+0] = r[j];
+    out[4*j+1] = i[j];
+    out[4*j+2] = r[SIMD_SZ-1-j];
+    out[4*j+3] = VSUB(VZERO(), i[SIMD_SZ-1-j]);
+  }
+}
+
+/* with 'ordered', the blocks go straight to their place in the canonical
+   order, instead of the internal layout */
+static NEVER_INLINE(void) pffft_real_finalize(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e, int ordered) {
+  int k, j, t, L = 2*Ncvec, dk = Ncvec/SIMD_SZ, p = Ncvec%SIMD_SZ; // number of SIMD_SZ x SIMD_SZ matrix blocks
+  int p0 = dk ? SIMD_SZ : p; // number of valid lanes in the first block
+  /* fftpack order is f0r f1r f1i f2r f2i ... f(n-1)r f(n-1)i f(n)r */
+  v4sf r[SIMD_SZ], i[SIMD_SZ], blk[2*SIMD_SZ];
+  const v4sf *m0 = e + 2*(dk + (p != 0))*(SIMD_SZ-1); /* see lane_m0_tables */
+  v4sf_union cr, ci, x, y;
+  pffft_float *fout = (pffft_float*)out;
+  assert(in != out);
+  cr.v = in[0]; ci.v = in[Ncvec*2-1];
+
+  /* the first row of the first block (frequency 0) is handled separately below */
+  if (dk) {
+    r[0] = i[0] = VZERO();
+    for (j=1; j < SIMD_SZ; ++j) { r[j] = in[2*j-1]; i[j] = in[2*j]; }
+    if (ordered) {
+      pffft_real_finalize_block(r, i, e, blk);
+      real_store_ordered(L, 0, blk, fout);
+    } else {
+      pffft_real_finalize_block(r, i, e, out);
+    }
+  }
+  for (k=1; k < dk; ++k) {
+    const v4sf *pin = in + 2*k*SIMD_SZ - 1;
+    for (j=0; j < SIMD_SZ; ++j) { r[j] = pin[2*j]; i[j] = pin[2*j+1]; }
+    if (ordered) {
+      pffft_real_finalize_block(r, i, e + k*2*(SIMD_SZ-1), blk);
+      real_store_ordered(L, k, blk, fout);
+    } else {
+      pffft_real_finalize_block(r, i, e + k*2*(SIMD_SZ-1), out + k*2*SIMD_SZ);
+    }
+  }
+  if (p) {
+    const v4sf *pin = in + 2*dk*SIMD_SZ - 1;
+    for (j=0; j < SIMD_SZ; ++j) {
+      int valid = j < p && (dk || j);
+      r[j] = valid ? pin[2*j] : VZERO(); i[j] = valid ? pin[2*j+1] : VZERO();
+    }
+    pffft_real_finalize_block(r, i, e + dk*2*(SIMD_SZ-1), blk);
+    if (ordered) {
+      real_store_ordered_partial(L, dk, (const pffft_float*)blk, SIMD_SZ, p, fout);
+    } else {
+      block_store_partial(blk, p, (pffft_float*)(out + dk*2*SIMD_SZ));
+    }
+  }
+
+  /* cr holds the (real) X_j(0) of each sub-fft, and ci their (real)
+     X_j(L/2): x gets X(t*L) in its lanes 2t, 2t+1 (X(0) + i*X(N/2) for
+     t=0), and y gets X(t*L + L/2) */
+  x.v = y.v = VZERO();
+  for (j=0; j < SIMD_SZ; ++j) {
+    x.v = VMADD(LD_PS1(cr.f[j]), m0[j], x.v);
+    y.v = VMADD(LD_PS1(ci.f[j]), m0[SIMD_SZ + j], y.v);
+  }
+  for (t=0; t < SIMD_SZ/2; ++t) {
+    if (ordered) {
+      fout[2*t*L + 0] = x.f[2*t]; fout[2*t*L + 1] = x.f[2*t+1];
+      fout[2*t*L + L] = y.f[2*t]; fout[2*t*L + L + 1] = y.f[2*t+1];
+    } else {
+      fout[(4*t+0)*p0] = x.f[2*t]; fout[(4*t+1)*p0] = x.f[2*t+1];
+      fout[(4*t+2)*p0] = y.f[2*t]; fout[(4*t+3)*p0] = y.f[2*t+1];
+    }
+  }
+}
+
+/* with 'ordered', the blocks are gathered from the canonical order */
+static NEVER_INLINE(void) pffft_real_preprocess(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e, int ordered) {
+  int k, j, t, L = 2*Ncvec, dk = Ncvec/SIMD_SZ, p = Ncvec%SIMD_SZ; // number of SIMD_SZ x SIMD_SZ matrix blocks
+  int p0 = dk ? SIMD_SZ : p; // number of valid lanes in the first block
+  /* fftpack order is f0r f1r f1i f2r f2i ... f(n-1)r f(n-1)i f(n)r */
+  v4sf r[SIMD_SZ], i[SIMD_SZ], blk[2*SIMD_SZ];
+  const pffft_float *fin = (const pffft_float*)in;
+  const v4sf *m0 = e + 2*(dk + (p != 0))*(SIMD_SZ-1); /* see lane_m0_tables */
+  pffft_float xr[SIMD_SZ], xi[SIMD_SZ]; /* the frequencies of m=0, slot by slot */
+  v4sf cr, ci;
+  assert(in != out);
+
+  for (j=0; j < SIMD_SZ; ++j) {
+    int o = ordered ? 2*real_slot_index(L, j, 0) : 2*j*p0;
+    xr[j] = fin[o]; xi[j] = fin[o + (ordered ? 1 : p0)];
+  }
+  if (ordered == PFFFT_HALF_SPECTRUM) xi[0] = fin[SIMD_SZ*L]; /* X(N/2) at the end */
+
+  /* inverse of the m=0 special case of pffft_real_finalize */
+  cr = ci = VZERO();
+  for (t=0; t < SIMD_SZ/2; ++t) {
+    cr = VMADD(LD_PS1(xr[2*t]), m0[2*SIMD_SZ + 2*t], cr);
+    cr = VMADD(LD_PS1(xi[2*t]), m0[2*SIMD_SZ + 2*t+1], cr);
+    ci = VMADD(LD_PS1(xr[2*t+1]), m0[3*SIMD_SZ + 2*t], ci);
+    ci = VMADD(LD_PS1(xi[2*t+1]), m0[3*SIMD_SZ + 2*t+1], ci);
+  }
+
+  for (k=0; k < dk; ++k) {
+    const v4sf *bin = in + 2*k*SIMD_SZ;
+    if (ordered) { real_load_ordered(L, k, fin, blk); bin = blk; }
+    for (t=0; t < SIMD_SZ/2; ++t) {
+      r[t] = bin[4*t+0];
+      i[t] = bin[4*t+1];
+      r[SIMD_SZ-1-t] = bin[4*t+2];
+      i[SIMD_SZ-1-t] = VSUB(VZERO(), bin[4*t+3]);
+    }
+    lane_dft(r, i, +1.f);
+    for (j=1; j < SIMD_SZ; ++j) VCPLXMULCONJ(r[j], i[j], e[k*2*(SIMD_SZ-1) + 2*j-2], e[k*2*(SIMD_SZ-1) + 2*j-1]);
+    VTRANSPOSE(r);
+    VTRANSPOSE(i);
+    for (j=(k == 0 ? 1 : 0); j < SIMD_SZ; ++j) {
+      out[2*(k*SIMD_SZ + j) - 1] = r[j];
+      out[2*(k*SIMD_SZ + j)] = i[j];
+    }
+  }
+  if (p) {
+    if (ordered) {
+      for (j=0; j < 2*SIMD_SZ; ++j) blk[j] = VZERO();
+      real_load_ordered_partial(L, dk, fin, (pffft_float*)blk, SIMD_SZ, p);
+    } else {
+      block_load_partial((const pffft_float*)(in + 2*dk*SIMD_SZ), p, blk);
+    }
+    for (t=0; t < SIMD_SZ/2; ++t) {
+      r[t] = blk[4*t+0];
+      i[t] = blk[4*t+1];
+      r[SIMD_SZ-1-t] = blk[4*t+2];
+      i[SIMD_SZ-1-t] = VSUB(VZERO(), blk[4*t+3]);
+    }
+    lane_dft(r, i, +1.f);
+    for (j=1; j < SIMD_SZ; ++j) VCPLXMULCONJ(r[j], i[j], e[dk*2*(SIMD_SZ-1) + 2*j-2], e[dk*2*(SIMD_SZ-1) + 2*j-1]);
+    VTRANSPOSE(r);
+    VTRANSPOSE(i);
+    for (j=(dk == 0 ? 1 : 0); j < p; ++j) {
+      out[2*(dk*SIMD_SZ + j) - 1] = r[j];
+      out[2*(dk*SIMD_SZ + j)] = i[j];
+    }
+  }
+  out[0] = cr;
+  out[2*Ncvec-1] = ci;
+}
+
+#endif // SIMD_SZ != 4
+
+static void pffft_transform_internal(PFFFT_Setup *setup, const pffft_float *finput, pffft_float *foutput, pffft_float *work,
+                                     pffft_direction_t direction, int ordered) {
+  int k, Ncvec   = setup->Ncvec;
+  v4sf *scratch = (v4sf*)work;
+  int nf_odd = (setup->ifac[1] & 1);
+
+  // temporary buffer if the scratch pointer is NULL: on the stack for the
+  // small sizes, in the scratch arena of the thread for the large ones
+  int on_stack = (scratch == 0 && pffft_scratch_on_stack(Ncvec*2*sizeof(v4sf)));
+  int from_arena = (scratch == 0 && !on_stack);
+  VLA_ARRAY_ON_STACK(v4sf, scratch_on_stack, on_stack ? Ncvec*2 : 1);
+
+  const v4sf *vinput = (const v4sf*)finput;
+  v4sf *voutput      = (v4sf*)foutput;
+  v4sf *buff[2];
+  int ib = (nf_odd ? 1 : 0);
+
+  assert(VALIGNED(finput) && VALIGNED(foutput));
+  if (on_stack) scratch = scratch_on_stack;
+  if (from_arena) scratch = (v4sf*)pffft_scratch_alloc(Ncvec*2*sizeof(v4sf));
+  buff[0] = voutput; buff[1] = scratch;
+
+  //assert(finput != foutput);
+  if (direction == PFFFT_FORWARD) {
+    ib = !ib;
+    if (setup->transform == PFFFT_REAL) { 
+      ib = (rfftf1_ps(Ncvec*2, vinput, buff[ib], buff[!ib],
+                      setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);      
+      pffft_real_finalize(Ncvec, buff[ib], buff[!ib], (v4sf*)setup->e, ordered);
+    } else {
+      v4sf *tmp = buff[ib];
+      for (k=0; k < Ncvec; ++k) {
+        UNINTERLEAVE2(vinput[k*2], vinput[k*2+1], tmp[k*2], tmp[k*2+1]);
+      }
+      ib = (cfftf1_ps(Ncvec, buff[ib], buff[!ib], buff[ib], 
+                      setup->twiddle, &setup->ifac[0], -1) == buff[0] ? 0 : 1);
+      pffft_cplx_finalize(Ncvec, buff[ib], buff[!ib], (v4sf*)setup->e, ordered);
+    }
+    ib = !ib;
+  } else {
+    if (vinput == buff[ib]) { 
+      ib = !ib; // may happen when finput == foutput
+    }
+    if (setup->transform == PFFFT_REAL) {
+      pffft_real_preprocess(Ncvec, vinput, buff[ib], (v4sf*)setup->e, ordered);
+      ib = (rfftb1_ps(Ncvec*2, buff[ib], buff[0], buff[1], 
+                      setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);
+    } else {
+      pffft_cplx_preprocess(Ncvec, vinput, buff[ib], (v4sf*)setup->e, ordered);
+      ib = (cfftf1_ps(Ncvec, buff[ib], buff[0], buff[1], 
+                      setup->twiddle, &setup->ifac[0], +1) == buff[0] ? 0 : 1);
+      for (k=0; k < Ncvec; ++k) {
+        INTERLEAVE2(buff[ib][k*2], buff[ib][k*2+1], buff[ib][k*2], buff[ib][k*2+1]);
+      }
+    }
+  }
+  
+  if (buff[ib] != voutput) {
+    /* extra copy required -- this situation should only happen when finput == foutput */
+    assert(finput==foutput);
+    for (k=0; k < Ncvec; ++k) {
+      v4sf a = buff[ib][2*k], b = buff[ib][2*k+1];
+      voutput[2*k] = a; voutput[2*k+1] = b;
+    }
+    ib = !ib;
+  }
+  assert(buff[ib] == voutput);
+  if (ordered == PFFFT_HALF_SPECTRUM && setup->transform == PFFFT_REAL && direction == PFFFT_FORWARD) {
+    /* X(N/2) leaves the imaginary part of X(0) for the end of the spectrum. This
+       is done here and not by the finalize, which writes in 'work' when the
+       transform is done in place */
+    int N = setup->N;
+    foutput[N] = foutput[1]; foutput[1] = foutput[N+1] = 0;
+  }
+  if (from_arena) pffft_scratch_free(scratch);
+}
+
+static void pffft_zconvolve_accumulate(PFFFT_Setup *s, const pffft_float *a, const pffft_float *b, pffft_float *ab, pffft_float scaling) {
+  int Ncvec = s->Ncvec;
+  const v4sf * RESTRICT va = (const v4sf*)a;
+  const v4sf * RESTRICT vb = (const v4sf*)b;
+  v4sf * RESTRICT vab = (v4sf*)ab;
+
+#if defined(__arm__) && !defined(PFFFT_SIMD_DISABLE) && !defined(PFFFT_DOUBLE)
+  __builtin_prefetch(va);
+  __builtin_prefetch(vb);
+  __builtin_prefetch(vab);
+  __builtin_prefetch(va+2);
+  __builtin_prefetch(vb+2);
+  __builtin_prefetch(vab+2);
+  __builtin_prefetch(va+4);
+  __builtin_prefetch(vb+4);
+  __builtin_prefetch(vab+4);
+  __builtin_prefetch(va+6);
+  __builtin_prefetch(vb+6);
+  __builtin_prefetch(vab+6);
+# ifndef __clang__
+#   define ZCONVOLVE_USING_INLINE_NEON_ASM
+# endif
+#endif
+
+  pffft_float ar, ai, br, bi, abr, abi;
+#ifndef ZCONVOLVE_USING_INLINE_ASM
+  v4sf vscal = LD_PS1(scaling);
+  int i;
+#endif
+  int p0 = SIMD_SZ; // number of valid lanes in the first block
+#if SIMD_SZ != 4
+  int p = Ncvec % SIMD_SZ; // the last block is partial, see real_slot_index
+  if (Ncvec < SIMD_SZ) p0 = p;
+  Ncvec -= p;
+#endif
+
+  assert(VALIGNED(a) && VALIGNED(b) && VALIGNED(ab));
+  ar = a[0];
+  ai = a[p0];
+  br = b[0];
+  bi = b[p0];
+  abr = ab[0];
+  abi = ab[p0];
+ 
+#ifdef ZCONVOLVE_USING_INLINE_ASM // inline asm version, unfortunately miscompiled by clang 3.2, at least on ubuntu.. so this will be restricted to gcc
+  const pffft_float *a_ = a, *b_ = b; pffft_float *ab_ = ab;
+  int N = Ncvec;
+  asm volatile("mov         r8, %2                  \n"
+               "vdup.f32    q15, %4                 \n"
+               "1:                                  \n"
+               "pld         [%0,#64]                \n"
+               "pld         [%1,#64]                \n"
+               "pld         [%2,#64]                \n"
+               "pld         [%0,#96]                \n"
+               "pld         [%1,#96]                \n"
+               "pld         [%2,#96]                \n"
+               "vld1.f32    {q0,q1},   [%0,:128]!         \n"
+               "vld1.f32    {q4,q5},   [%1,:128]!         \n"
+               "vld1.f32    {q2,q3},   [%0,:128]!         \n"
+               "vld1.f32    {q6,q7},   [%1,:128]!         \n"
+               "vld1.f32    {q8,q9},   [r8,:128]!          \n"
+               
+               "vmul.f32    q10, q0, q4             \n"
+               "vmul.f32    q11, q0, q5             \n"
+               "vmul.f32    q12, q2, q6             \n" 
+               "vmul.f32    q13, q2, q7             \n"                 
+               "vmls.f32    q10, q1, q5             \n"
+               "vmla.f32    q11, q1, q4             \n"
+               "vld1.f32    {q0,q1}, [r8,:128]!     \n"
+               "vmls.f32    q12, q3, q7             \n"
+               "vmla.f32    q13, q3, q6             \n"
+               "vmla.f32    q8, q10, q15            \n"
+               "vmla.f32    q9, q11, q15            \n"
+               "vmla.f32    q0, q12, q15            \n"
+               "vmla.f32    q1, q13, q15            \n"
+               "vst1.f32    {q8,q9},[%2,:128]!    \n"
+               "vst1.f32    {q0,q1},[%2,:128]!    \n"
+               "subs        %3, #2                  \n"
+               "bne         1b                      \n"
+               : "+r"(a_), "+r"(b_), "+r"(ab_), "+r"(N) : "r"(scaling) : "r8", "q0","q1","q2","q3","q4","q5","q6","q7","q8","q9", "q10","q11","q12","q13","q15","memory");
+#else // default routine, works fine for non-arm cpus with current compilers
+  for (i=0; i < Ncvec; i += 2) {
+    v4sf ar, ai, br, bi;
+    ar = va[2*i+0]; ai = va[2*i+1];
+    br = vb[2*i+0]; bi = vb[2*i+1];
+    VCPLXMUL(ar, ai, br, bi);
+    vab[2*i+0] = VMADD(ar, vscal, vab[2*i+0]);
+    vab[2*i+1] = VMADD(ai, vscal, vab[2*i+1]);
+    ar = va[2*i+2]; ai = va[2*i+3];
+    br = vb[2*i+2]; bi = vb[2*i+3];
+    VCPLXMUL(ar, ai, br, bi);
+    vab[2*i+2] = VMADD(ar, vscal, vab[2*i+2]);
+    vab[2*i+3] = VMADD(ai, vscal, vab[2*i+3]);
+  }
+#endif
+#if SIMD_SZ != 4
+  if (p) {
+    const pffft_float *ta = a + 2*Ncvec*SIMD_SZ, *tb = b + 2*Ncvec*SIMD_SZ;
+    pffft_float *tab = ab + 2*Ncvec*SIMD_SZ;
+    /* rows of p real parts followed by p imaginary parts: scalar code */
+    int j;
+    for (i=0; i < 2*SIMD_SZ*p; i += 2*p) {
+      for (j=i; j < i + p; ++j) {
+        pffft_float xr = ta[j], xi = ta[j+p], yr = tb[j], yi = tb[j+p];
+        tab[j] += (xr*yr - xi*yi)*scaling;
+        tab[j+p] += (xr*yi + xi*yr)*scaling;
+      }
+    }
+  }
+#endif
+  if (s->transform == PFFFT_REAL) {
+    ab[0] = abr + ar*br*scaling;
+    ab[p0] = abi + ai*bi*scaling;
+  }
+}
+
+/*
+  ab += (a[0]*b[0] + ... + a[K-1]*b[K-1])*scaling: the sums of the
+  products stay in registers, and each block of ab is loaded and stored
+  once per group of ZCONVOLVE_GROUP terms (with all the terms at once, the
+  2K input streams defeat the hardware prefetchers when they are not in
+  the cache). The real and imaginary parts of the products are summed
+  separately (re = rr - ii), so that each term is 4 VMADD.
+*/
+#define ZCONVOLVE_GROUP 8
+static void pffft_zconvolve_accumulate_many(PFFFT_Setup *s, int K, const pffft_float *const *a, const pffft_float *const *b,
+                                            pffft_float *ab, pffft_float scaling) {
+  int Ncvec = s->Ncvec, i, k, k0;
+  v4sf * RESTRICT vab = (v4sf*)ab;
+  v4sf vscal = LD_PS1(scaling);
+  pffft_float dc = 0, nyquist = 0;
+  int p0 = SIMD_SZ; // number of valid lanes in the first block
+#if SIMD_SZ != 4
+  int p = Ncvec % SIMD_SZ; // the last block is partial, see real_slot_index
+  if (Ncvec < SIMD_SZ) p0 = p;
+  Ncvec -= p;
+#endif
+
+  if (K == 1) {
+    pffft_zconvolve_accumulate(s, a[0], b[0], ab, scaling);
+    return;
+  }
+  assert(VALIGNED(ab));
+  if (s->transform == PFFFT_REAL) {
+    /* the purely real components packed in the first block, summed before ab is overwritten */
+    for (k=0; k < K; ++k) {
+      dc += a[k][0]*b[k][0];
+      nyquist += a[k][p0]*b[k][p0];
+    }
+    dc = ab[0] + dc*scaling;
+    nyquist = ab[p0] + nyquist*scaling;
+  }
+
+  for (k0=0; k0 < K; k0 += ZCONVOLVE_GROUP) for (i=0; i < Ncvec; i += 2) {
+    int k1 = (K - k0 < ZCONVOLVE_GROUP ? K : k0 + ZCONVOLVE_GROUP);
+    v4sf rr0 = VZERO(), ii0 = VZERO(), ri0 = VZERO();
+    v4sf rr1 = VZERO(), ii1 = VZERO(), ri1 = VZERO();
+    for (k=k0; k < k1; ++k) {
+      const v4sf *va = (const v4sf*)a[k] + 2*i, *vb = (const v4sf*)b[k] + 2*i;
+      v4sf ar0 = va[0], ai0 = va[1], br0 = vb[0], bi0 = vb[1];
+      v4sf ar1 = va[2], ai1 = va[3], br1 = vb[2], bi1 = vb[3];
+      rr0 = VMADD(ar0, br0, rr0); ii0 = VMADD(ai0, bi0, ii0);
+      ri0 = VMADD(ar0, bi0, ri0); ri0 = VMADD(ai0, br0, ri0);
+      rr1 = VMADD(ar1, br1, rr1); ii1 = VMADD(ai1, bi1, ii1);
+      ri1 = VMADD(ar1, bi1, ri1); ri1 = VMADD(ai1, br1, ri1);
+    }
+    vab[2*i+0] = VMADD(VSUB(rr0, ii0), vscal, vab[2*i+0]);
+    vab[2*i+1] = VMADD(ri0, vscal, vab[2*i+1]);
+    vab[2*i+2] = VMADD(VSUB(rr1, ii1), vscal, vab[2*i+2]);
+    vab[2*i+3] = VMADD(ri1, vscal, vab[2*i+3]);
+  }
+#if SIMD_SZ != 4
+  if (p) {
+    /* the partial block, as in pffft_zconvolve_accumulate */
+    int o = 2*Ncvec*SIMD_SZ, j;
+    for (i=0; i < SIMD_SZ; ++i, o += 2*p) {
+      for (j=o; j < o + p; ++j) {
+        pffft_float re = 0, im = 0;
+        for (k=0; k < K; ++k) {
+          pffft_float ar = a[k][j], ai = a[k][j+p], br = b[k][j], bi = b[k][j+p];
+          re += ar*br - ai*bi;
+          im += ar*bi + ai*br;
+        }
+        ab[j] += re*scaling;
+        ab[j+p] += im*scaling;
+      }
+    }
+  }
+#endif
+  if (s->transform == PFFFT_REAL) {
+    ab[0] = dc;
+    ab[p0] = nyquist;
+  }
+}
+
+
+#else // defined(PFFFT_SIMD_DISABLE)
+
+// standard routine using scalar floats, without SIMD stuff.
+
+#define pffft_zreorder_nosimd pffft_zreorder
+static void pffft_zreorder_nosimd(PFFFT_Setup *setup, const pffft_float *in, pffft_float *out, pffft_direction_t direction) {
+  int k, N = setup->N;
+  if (setup->transform == PFFFT_COMPLEX) {
+    for (k=0; k < 2*N; ++k) out[k] = in[k];
+    return;
+  }
+  else if (direction == PFFFT_FORWARD) {
+    pffft_float x_N = in[N-1];
+    for (k=N-1; k > 1; --k) out[k] = in[k-1]; 
+    out[0] = in[0];
+    out[1] = x_N;
+  } else {
+    pffft_float x_N = in[1];
+    for (k=1; k < N-1; ++k) out[k] = in[k+1]; 
+    out[0] = in[0];
+    out[N-1] = x_N;
+  }
+}
+
+#define pffft_transform_internal_nosimd pffft_transform_internal
+static void pffft_transform_internal_nosimd(PFFFT_Setup *setup, const pffft_float *input, pffft_float *output, pffft_float *scratch,
+                                    pffft_direction_t direction, int ordered) {
+  int Ncvec   = setup->Ncvec;
+  int nf_odd = (setup->ifac[1] & 1);
+
+  // temporary buffer if the scratch pointer is NULL: on the stack for the
+  // small sizes, in the scratch arena of the thread for the large ones
+  int on_stack = (scratch == 0 && pffft_scratch_on_stack(Ncvec*2*sizeof(v4sf)));
+  int from_arena = (scratch == 0 && !on_stack);
+  VLA_ARRAY_ON_STACK(v4sf, scratch_on_stack, on_stack ? Ncvec*2 : 1);
+  pffft_float *buff[2];
+  int ib, half = (ordered == PFFFT_HALF_SPECTRUM && setup->transform == PFFFT_REAL);
+  if (on_stack) scratch = scratch_on_stack;
+  if (from_arena) scratch = (pffft_float*)pffft_scratch_alloc(Ncvec*2*sizeof(v4sf));
+  buff[0] = output; buff[1] = scratch;
+
+  if (setup->transform == PFFFT_COMPLEX) ordered = 0; // it is always ordered.
+  ordered = (ordered != 0);
+  ib = (nf_odd ^ ordered ? 1 : 0);
+
+  if (direction == PFFFT_FORWARD) {
+    if (setup->transform == PFFFT_REAL) { 
+      ib = (rfftf1_ps(Ncvec*2, input, buff[ib], buff[!ib],
+                      setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);      
+    } else {
+      ib = (cfftf1_ps(Ncvec, input, buff[ib], buff[!ib], 
+                      setup->twiddle, &setup->ifac[0], -1) == buff[0] ? 0 : 1);
+    }
+    if (ordered) {
+      pffft_zreorder(setup, buff[ib], buff[!ib], PFFFT_FORWARD); ib = !ib;
+    }
+  } else {    
+    if (input == buff[ib]) { 
+      ib = !ib; // may happen when finput == foutput
+    }
+    if (ordered) {
+      pffft_zreorder(setup, input, buff[!ib], PFFFT_BACKWARD); 
+      if (half) buff[!ib][2*Ncvec-1] = input[2*Ncvec]; // X(N/2) is at the end
+      input = buff[!ib];
+    }
+    if (setup->transform == PFFFT_REAL) {
+      ib = (rfftb1_ps(Ncvec*2, input, buff[ib], buff[!ib], 
+                      setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);
+    } else {
+      ib = (cfftf1_ps(Ncvec, input, buff[ib], buff[!ib], 
+                      setup->twiddle, &setup->ifac[0], +1) == buff[0] ? 0 : 1);
+    }
+  }
+  if (buff[ib] != output) {
+    int k;
+    // extra copy required -- this situation should happens only when finput == foutput
+    assert(input==output);
+    for (k=0; k < Ncvec; ++k) {
+      pffft_float a = buff[ib][2*k], b = buff[ib][2*k+1];
+      output[2*k] = a; output[2*k+1] = b;
+    }
+    ib = !ib;
+  }
+  assert(buff[ib] == output);
+  if (half && direction == PFFFT_FORWARD) { // see pffft_transform_internal
+    output[2*Ncvec] = output[1]; output[1] = output[2*Ncvec+1] = 0;
+  }
+  if (from_arena) pffft_scratch_free(scratch);
+}
+
+#define pffft_zconvolve_accumulate_nosimd pffft_zconvolve_accumulate
+static void pffft_zconvolve_accumulate_nosimd(PFFFT_Setup *s, const pffft_float *a, const pffft_float *b,
+                                       pffft_float *ab, pffft_float scaling) {
+  int i, Ncvec = s->Ncvec;
+
+  if (s->transform == PFFFT_REAL) {
+    // take care of the fftpack ordering
+    ab[0] += a[0]*b[0]*scaling;
+    ab[2*Ncvec-1] += a[2*Ncvec-1]*b[2*Ncvec-1]*scaling;
+    ++ab; ++a; ++b; --Ncvec;
+  }
+  for (i=0; i < Ncvec; ++i) {
+    pffft_float ar, ai, br, bi;
+    ar = a[2*i+0]; ai = a[2*i+1];
+    br = b[2*i+0]; bi = b[2*i+1];
+    VCPLXMUL(ar, ai, br, bi);
+    ab[2*i+0] += ar*scaling;
+    ab[2*i+1] += ai*scaling;
+  }
+}
+
+#define pffft_zconvolve_accumulate_many_nosimd pffft_zconvolve_accumulate_many
+static void pffft_zconvolve_accumulate_many_nosimd(PFFFT_Setup *s, int K, const pffft_float *const *a, const pffft_float *const *b,
+                                                   pffft_float *ab, pffft_float scaling) {
+  int i, k, Ncvec = s->Ncvec, o = 0;
+
+  if (s->transform == PFFFT_REAL) {
+    // take care of the fftpack ordering
+    pffft_float dc = 0, nyquist = 0;
+    for (k=0; k < K; ++k) {
+      dc += a[k][0]*b[k][0];
+      nyquist += a[k][2*Ncvec-1]*b[k][2*Ncvec-1];
+    }
+    ab[0] += dc*scaling;
+    ab[2*Ncvec-1] += nyquist*scaling;
+    o = 1; --Ncvec;
+  }
+  for (i=o; i < o + 2*Ncvec; i += 2) {
+    pffft_float re = 0, im = 0;
+    for (k=0; k < K; ++k) {
+      pffft_float ar = a[k][i], ai = a[k][i+1], br = b[k][i], bi = b[k][i+1];
+      re += ar*br - ai*bi;
+      im += ar*bi + ai*br;
+    }
+    ab[i] += re*scaling;
+    ab[i+1] += im*scaling;
+  }
+}
+
+#ifndef PFFFT_DOUBLE
+#define pffft_power_spectrum_nosimd pffft_power_spectrum
+static void pffft_power_spectrum_nosimd(PFFFT_Setup *s, const pffft_float *spectrum, pffft_float *power) {
+  int k, N = s->N;
+  if (s->transform == PFFFT_REAL) {
+    // the fftpack ordering: X(0), then the (re,im) pairs, then X(N/2)
+    power[0] = spectrum[0]*spectrum[0];
+    for (k=1; k < N/2; ++k) power[k] = spectrum[2*k-1]*spectrum[2*k-1] + spectrum[2*k]*spectrum[2*k];
+    power[N/2] = spectrum[N-1]*spectrum[N-1];
+  } else {
+    for (k=0; k < N; ++k) power[k] = spectrum[2*k]*spectrum[2*k] + spectrum[2*k+1]*spectrum[2*k+1];
+  }
+}
+#endif
+
+#endif // defined(PFFFT_SIMD_DISABLE)
+
+/*
+  transposed batches: SIMD_SZ signals are transformed at once, each simd
+  lane holding one of them, with the fftpack-structured passes above and
+  the (scalar) twiddles of length N. There is no finalize / preprocess
+  step and no transpose, so this is the fastest option for small N, and
+  the only restriction on N is on its prime factors.
+*/
+
+/* compute the twiddles (only the factors when 'twiddle' is null) of the
+   transposed batches, returns 0 when N is not supported */
+static int pffft_lane_setup(int N, pffft_transform_t transform, pffft_float *twiddle, int *ifac) {
+  int k, m;
+  if (!twiddle) {
+    decompose(N, ifac, (transform == PFFFT_REAL ? rfft_ntryh : cfft_ntryh));
+  } else if (transform == PFFFT_REAL) {
+    rffti1_ps(N, twiddle, ifac);
+  } else {
+    cffti1_ps(N, twiddle, ifac);
+  }
+  for (k=0, m=1; k < ifac[1]; ++k) { m *= ifac[2+k]; }
+  return m == N;
+}
+
+/* position, in the fftpack order, of the component k of the canonical order of real transforms */
+static ALWAYS_INLINE(int) lane_row(int N, int k) {
+  if (k == 0 || (N & 1)) return k;
+  return (k == 1 ? N-1 : k-1);
+}
+
+static void pffft_transform_lanes(int N, pffft_transform_t transform, const pffft_float *twiddle, const int *ifac,
+                                  int howmany, const pffft_float *input, int in_stride,
+                                  pffft_float *output, int out_stride, pffft_direction_t direction) {
+  int cplx = (transform == PFFFT_COMPLEX);
+  int nv = (cplx ? 2*N : N); // nb of simd vectors per group of SIMD_SZ signals
+  int real_fwd = (!cplx && direction == PFFFT_FORWARD), real_bwd = (!cplx && direction == PFFFT_BACKWARD);
+  int b, j, k;
+  int on_stack = pffft_scratch_on_stack(2*nv*sizeof(v4sf));
+  VLA_ARRAY_ON_STACK(v4sf, buf_on_stack, on_stack ? 2*nv : 1);
+  v4sf *buf = (on_stack ? buf_on_stack : (v4sf*)pffft_scratch_alloc(2*nv*sizeof(v4sf)));
+
+  for (b=0; b < howmany; b += SIMD_SZ) {
+    int nb = (howmany - b < SIMD_SZ ? howmany - b : SIMD_SZ); // nb of signals in this group
+    const pffft_float *in = input + (cplx ? 2*b : b);
+    pffft_float *out = output + (cplx ? 2*b : b);
+    pffft_float *fbuf = (pffft_float*)buf;
+    v4sf *res;
+
+    /* load the signals of the group in the simd lanes (the real spectra go back to the fftpack order) */
+#if !defined(PFFFT_SIMD_DISABLE) && defined(VLOADU)
+    if (nb == SIMD_SZ) {
+      for (k=0; k < N; ++k) {
+        if (cplx) {
+          v4sf a = VLOADU(in + k*in_stride), c = VLOADU(in + k*in_stride + SIMD_SZ);
+          UNINTERLEAVE2(a, c, buf[2*k], buf[2*k+1]);
+        } else {
+          buf[real_bwd ? lane_row(N, k) : k] = VLOADU(in + k*in_stride);
+        }
+      }
+    } else
+#endif
+    {
+      for (k=0; k < N; ++k) {
+        for (j=0; j < SIMD_SZ; ++j) {
+          if (cplx) {
+            fbuf[2*k*SIMD_SZ + j]     = (j < nb ? in[k*in_stride + 2*j] : 0);
+            fbuf[(2*k+1)*SIMD_SZ + j] = (j < nb ? in[k*in_stride + 2*j+1] : 0);
+          } else {
+            fbuf[(real_bwd ? lane_row(N, k) : k)*SIMD_SZ + j] = (j < nb ? in[k*in_stride + j] : 0);
+          }
+        }
+      }
+    }
+
+    if (cplx) {
+      res = cfftf1_ps(N, buf, buf, buf + nv, twiddle, ifac, direction == PFFFT_FORWARD ? -1 : +1);
+    } else if (real_fwd) {
+      res = rfftf1_ps(N, buf, buf, buf + nv, twiddle, ifac);
+    } else {
+      res = rfftb1_ps(N, buf, buf, buf + nv, twiddle, ifac);
+    }
+
+    /* store the results, in the canonical order */
+#if !defined(PFFFT_SIMD_DISABLE) && defined(VLOADU)
+    if (nb == SIMD_SZ) {
+      for (k=0; k < N; ++k) {
+        if (cplx) {
+          v4sf a, c;
+          INTERLEAVE2(res[2*k], res[2*k+1], a, c);
+          VSTOREU(out + k*out_stride, a); VSTOREU(out + k*out_stride + SIMD_SZ, c);
+        } else {
+          VSTOREU(out + k*out_stride, res[real_fwd ? lane_row(N, k) : k]);
+        }
+      }
+    } else
+#endif
+    {
+      const pffft_float *fres = (const pffft_float*)res;
+      for (k=0; k < N; ++k) {
+        for (j=0; j < nb; ++j) {
+          if (cplx) {
+            out[k*out_stride + 2*j]   = fres[2*k*SIMD_SZ + j];
+            out[k*out_stride + 2*j+1] = fres[(2*k+1)*SIMD_SZ + j];
+          } else {
+            out[k*out_stride + j] = fres[(real_fwd ? lane_row(N, k) : k)*SIMD_SZ + j];
+          }
+        }
+      }
+    }
+  }
+  if (!on_stack) pffft_scratch_free(buf);
+}
+
+#ifndef PFFFT_DOUBLE
+/*
+  direct form FIR of the first taps of the zero latency convolvers:
+  y[i] = sum_j h[j]*x[i-j] for i in [0, n) and j in [0, ntaps), with
+  ntaps - 1 samples of history before x. No alignment is needed.
+*/
+static void pffft_fir(const pffft_float *h, int ntaps, const pffft_float *x, pffft_float *y, int n) {
+  int i = 0, j;
+#if !defined(PFFFT_SIMD_DISABLE) && defined(VLOADU)
+  for (; i + SIMD_SZ <= n; i += SIMD_SZ) {
+    v4sf acc = VZERO();
+    for (j=0; j < ntaps; ++j) {
+      acc = VMADD(LD_PS1(h[j]), VLOADU(x + i - j), acc);
+    }
+    VSTOREU(y + i, acc);
+  }
+#endif
+  for (; i < n; ++i) {
+    pffft_float acc = 0;
+    for (j=0; j < ntaps; ++j) acc += h[j]*x[i - j];
+    y[i] = acc;
+  }
+}
+
+/* y = x*w (or y += x*w when accumulate is set), the windowing of the STFT frames. No alignment is needed */
+static void pffft_window(const pffft_float *x, const pffft_float *w, pffft_float *y, int n, int accumulate) {
+  int i = 0;
+#if !defined(PFFFT_SIMD_DISABLE) && defined(VLOADU)
+  if (accumulate) {
+    for (; i + SIMD_SZ <= n; i += SIMD_SZ) VSTOREU(y + i, VMADD(VLOADU(x + i), VLOADU(w + i), VLOADU(y + i)));
+  } else {
+    for (; i + SIMD_SZ <= n; i += SIMD_SZ) VSTOREU(y + i, VMUL(VLOADU(x + i), VLOADU(w + i)));
+  }
+#endif
+  if (accumulate) {
+    for (; i < n; ++i) y[i] += x[i]*w[i];
+  } else {
+    for (; i < n; ++i) y[i] = x[i]*w[i];
+  }
+}
+#endif
+
+static const pffft_simd_impl pffft_simd_table = {
+  PFFFT_SIMD_ID, PFFFT_SIMD_NAME, SIMD_SZ,
+  pffft_new_setup, pffft_init_setup, pffft_transform_internal, pffft_zreorder, pffft_zconvolve_accumulate,
+  pffft_lane_setup, pffft_transform_lanes, pffft_measure_setup,
+#if !defined(PFFFT_SIMD_DISABLE)
+  validate_pffft_simd,
+#else
+  0,
+#endif
+  pffft_zconvolve_accumulate_many,
+#ifndef PFFFT_DOUBLE
+  pffft_fir, pffft_window, pffft_power_spectrum
+#endif
+};
+
+/* clean up, so that this file can be included again for another simd flavour */
+#ifdef PFFFT_DOUBLE_SIMD_DISABLED
+#  undef PFFFT_SIMD_DISABLE
+#  undef PFFFT_DOUBLE_SIMD_DISABLED
+#endif
+#undef pffft_float
+#undef PFFFT_Setup
+#undef ZCONVOLVE_GROUP
+#undef POWER_STOREU
+#undef pffft_simd_impl
+#undef pffft_destroy_setup
+#undef SIMD_SZ
+#undef PFFFT_SIMD_ID
+#undef PFFFT_SIMD_NAME
+#undef VZERO
+#undef VMUL
+#undef VADD
+#undef VMADD
+#undef VMSUB
+#undef VNMADD
+#undef VSUB
+#undef LD_PS1
+#undef INTERLEAVE2
+#undef UNINTERLEAVE2
+#undef INTERLEAVE2_REV
+#undef UNINTERLEAVE2_REV
+#undef VTRANSPOSE4
+#undef VTRANSPOSE
+#undef VSWAPHL
+#undef VREV
+#undef VLOADU
+#undef VSTOREU
+#undef VALIGNED
+#undef VCPLXMUL
+#undef VCPLXMULCONJ
+#undef SVMUL
+#undef LANE_COS
+#undef LANE_SIN
+#undef LANE_M0_VECTORS
+#undef VLOAD_PARTIAL
+#undef VSETLANE0
+#undef VSTOREU_INTERLEAVE2
+#undef VSTOREU_INTERLEAVE2_REV
+#undef VLOADU_UNINTERLEAVE2
+#undef VLOADU_UNINTERLEAVE2_REV
+#undef ZCONVOLVE_USING_INLINE_NEON_ASM
+#undef PFFFT_MAX_RADIX
+#undef PFFFT_MEASURE_MAX_PLANS
+#undef PFFFT_MEASURE_MIN_TIME
+#undef PFFFT_MEASURE_ROUNDS
+#undef pffft_zreorder_nosimd
+#undef pffft_transform_internal_nosimd
+#undef pffft_zconvolve_accumulate_nosimd
@@ -17,6 +17,12 @@
   on windows, with visual c++:
   cl /Ox -D_USE_MATH_DEFINES /arch:SSE test_pffft.c pffft.c fftpack.c
   
+  with gcc on x86, the SSE, AVX (8-wide vectors), AVX+FMA3 and AVX-512
+  (16-wide vectors) versions are all built, and the best one is picked at
+  runtime (run with PFFFT_SIMD=sse, avx, fma or avx512 to force one of
+  them). To only build the AVX+FMA3 one:
+  gcc -o test_pffft -DPFFFT_NO_DISPATCH -mavx -mfma -O3 -Wall -W pffft.c test_pffft.c fftpack.c -lm
+
   build without SIMD instructions:
   gcc -o test_pffft -DPFFFT_SIMD_DISABLE -O3 -Wall -W pffft.c test_pffft.c fftpack.c -lm
 
@@ -62,6 +68,15 @@ double frand() {
 { return (double)clock()/(double)CLOCKS_PER_SEC; }
 #endif
 
+/* wall clock time, for the multithreaded benchmarks (clock() adds up the time of all the threads) */
+double wclock_sec(void) {
+#if defined(TIME_UTC)
+  struct timespec t; timespec_get(&t, TIME_UTC); return t.tv_sec + 1e-9*t.tv_nsec;
+#else
+  return uclock_sec();
+#endif
+}
+
 
 /* compare results with the regular fftpack */
 void pffft_validate_N(int N, int cplx) {
@@ -93,7 +108,8 @@ void pffft_validate_N(int N, int cplx) {
         rffti(N, wrk);
         rfftf(N, ref, wrk);
         // use our ordering for real ffts instead of the one of fftpack
-        {
+        // (odd sizes, done with the chirp-z transform, keep the fftpack one)
+        if (N % 2 == 0) {
           float refN=ref[N-1];
           for (k=N-2; k >= 1; --k) ref[k+1] = ref[k]; 
           ref[1] = refN;
@@ -173,7 +189,9 @@ void pffft_validate_N(int N, int cplx) {
       pffft_zconvolve_accumulate(s, ref, ref, out, 1.0);
       pffft_zreorder(s, out, tmp2, PFFFT_FORWARD);
       
-      for (k=0; k < Nfloat; k += 2) {
+      k = 0;
+      if (!cplx && N % 2) { tmp[0] *= tmp[0]; k = 1; } // odd real sizes: F(0), then the (re,im) pairs
+      for (; k < Nfloat; k += 2) {
         float ar = tmp[k], ai=tmp[k+1];
         if (cplx || k > 0) {
           tmp[k] = ar*ar - ai*ai;
@@ -194,6 +212,81 @@ void pffft_validate_N(int N, int cplx) {
       }
     }
 
+    // the sum of products of pffft_zconvolve_accumulate_many, against successive pffft_zconvolve_accumulate
+    {
+      const float *va[3], *vb[3];
+      float conv_err = 0, conv_max = 0;
+      va[0] = ref; va[1] = in; va[2] = ref;
+      vb[0] = in; vb[1] = in; vb[2] = ref;
+      memcpy(out, in, Nbytes);
+      memcpy(tmp2, in, Nbytes);
+      pffft_zconvolve_accumulate_many(s, 3, va, vb, out, 0.5f);
+      for (k=0; k < 3; ++k) pffft_zconvolve_accumulate(s, va[k], vb[k], tmp2, 0.5f);
+      for (k=0; k < Nfloat; ++k) {
+        conv_err = MAX(conv_err, fabs(out[k] - tmp2[k]));
+        conv_max = MAX(conv_max, fabs(tmp2[k]));
+      }
+      if (conv_err > 1e-5*conv_max) {
+        printf("zconvolve_many error ? %g %g\n", conv_err, conv_max); exit(1);
+      }
+    }
+
+    // half spectrum (N/2+1 bins, F(N/2) at the end), against the canonical order
+    if (pass == 1) {
+      int nbins = (cplx ? N : N/2 + 1);
+      float *half = pffft_aligned_malloc((Nfloat + 2)*sizeof(float));
+      pffft_transform_ordered(s, in, tmp, 0, PFFFT_FORWARD);
+      pffft_transform_halfspectrum(s, in, half, 0, PFFFT_FORWARD);
+      memcpy(out, half, Nbytes);
+      memcpy(half, in, Nbytes);
+      pffft_transform_halfspectrum(s, half, half, 0, PFFFT_FORWARD);
+      for (k=0; k < nbins; ++k) {
+        float re, im = 0;
+        if (cplx) { re = tmp[2*k]; im = tmp[2*k+1]; }
+        else if (k == 0) re = tmp[0];
+        else if (N % 2 == 0 && k == N/2) re = tmp[1];
+        else if (N % 2 == 0) { re = tmp[2*k]; im = tmp[2*k+1]; }
+        else { re = tmp[2*k-1]; im = tmp[2*k]; }
+        if (half[2*k] != re || half[2*k+1] != im) {
+          printf("%s half spectrum mismatch for N=%d\n", (cplx?"CPLX":"REAL"), N); exit(1);
+        }
+      }
+      for (k=0; k < Nfloat; ++k) assert(out[k] == half[k]);
+      // the imaginary parts of F(0) and F(N/2) are ignored by the backward transform
+      if (!cplx) { half[1] = 1e3f; if (N % 2 == 0) half[N+1] = -1e3f; }
+      pffft_transform_ordered(s, tmp, tmp2, 0, PFFFT_BACKWARD);
+      pffft_transform_halfspectrum(s, half, out, 0, PFFFT_BACKWARD);
+      pffft_transform_halfspectrum(s, half, half, 0, PFFFT_BACKWARD);
+      for (k=0; k < Nfloat; ++k) {
+        if (out[k] != tmp2[k] || half[k] != tmp2[k]) {
+          printf("%s half spectrum IFFT mismatch for N=%d\n", (cplx?"CPLX":"REAL"), N); exit(1);
+        }
+      }
+      pffft_aligned_free(half);
+    }
+
+    // power spectrum, against the canonical order
+    {
+      int nbins = (cplx ? N : N/2 + 1);
+      float pow_err = 0, pow_max = 0;
+      pffft_transform_ordered(s, in, tmp, 0, PFFFT_FORWARD);
+      memset(out, 0, Nbytes);
+      pffft_power_spectrum(s, in, out + 1, pass ? tmp2 : 0); // unaligned output
+      for (k=0; k < nbins; ++k) {
+        float re, im = 0;
+        if (cplx) { re = tmp[2*k]; im = tmp[2*k+1]; }
+        else if (k == 0) re = tmp[0];
+        else if (N % 2 == 0 && k == N/2) re = tmp[1];
+        else if (N % 2 == 0) { re = tmp[2*k]; im = tmp[2*k+1]; }
+        else { re = tmp[2*k-1]; im = tmp[2*k]; }
+        pow_err = MAX(pow_err, fabs(out[1 + k] - (re*re + im*im)));
+        pow_max = MAX(pow_max, re*re + im*im);
+      }
+      if (pow_err > 1e-5*pow_max || out[0] != 0 || (nbins + 1 < Nfloat && out[nbins + 1] != 0)) {
+        printf("power spectrum error for N=%d ? %g %g\n", N, pow_err, pow_max); exit(1);
+      }
+    }
+
   }
 
   printf("%s PFFFT is OK for N=%d\n", (cplx?"CPLX":"REAL"), N); fflush(stdout);
@@ -207,7 +300,12 @@ void pffft_validate_N(int N, int cplx) {
 }
 
 void pffft_validate(int cplx) {
-  static int Ntest[] = { 16, 32, 64, 96, 128, 160, 192, 256, 288, 384, 5*96, 512, 576, 5*128, 800, 864, 1024, 2048, 2592, 4000, 4096, 12000, 36864, 0};
+  static int Ntest[] = { 16, 32, 64, 96, 128, 160, 192, 256, 288, 384, 5*96, 512, 576, 5*128, 800, 864, 1024, 2048, 2592, 4000, 4096, 12000, 36864,
+                         /* odd prime factors up to 31 */
+                         7*32, 11*64, 13*128, 7*1024, 7*7*3*5*32, 17*19*32, 31*64, 7*11*13*32,
+                         /* sizes handled by the chirp-z transform (fftpack, used as the
+                            reference, loses accuracy with large prime factors) */
+                         7, 17, 22, 97, 7*11*13, 3*7*11*13, 37*64, 0};
   int k;
   for (k = 0; Ntest[k]; ++k) {
     int N = Ntest[k];
@@ -216,6 +314,702 @@ void pffft_validate(int cplx) {
   }
 }
 
+/* compare the batched transforms with the single ones */
+void pffft_validate_batch_N(int N, int cplx) {
+  const int howmany = 19; // not a multiple of the simd size, the last group is partial
+  int Nfloat = N*(cplx?2:1), stride = (cplx ? 2*howmany : howmany) + 3;
+  float *in = pffft_aligned_malloc(N*stride*sizeof(float));
+  float *out = pffft_aligned_malloc(N*stride*sizeof(float));
+  float *x = pffft_aligned_malloc(Nfloat*sizeof(float));
+  float *ref = pffft_aligned_malloc(howmany*Nfloat*sizeof(float));
+  float *tmp = pffft_aligned_malloc(howmany*Nfloat*sizeof(float));
+  PFFFT_Setup *s = pffft_new_setup(N, cplx ? PFFFT_COMPLEX : PFFFT_REAL);
+  float ref_max = 0, err = 0;
+  int b, k;
+
+  for (k=0; k < N*stride; ++k) in[k] = frand()*2-1;
+  for (b=0; b < howmany; ++b) {
+    for (k=0; k < Nfloat; ++k) x[k] = in[(cplx ? k/2 : k)*stride + (cplx ? 2*b + (k&1) : b)];
+    pffft_transform_ordered(s, x, ref + b*Nfloat, 0, PFFFT_FORWARD);
+    for (k=0; k < Nfloat; ++k) ref_max = MAX(ref_max, fabs(ref[b*Nfloat + k]));
+  }
+
+  // transposed batch, forward then in-place backward
+  pffft_transform_batch(s, howmany, in, stride, out, stride, 0, PFFFT_FORWARD, PFFFT_BATCH_TRANSPOSED);
+  for (b=0; b < howmany; ++b) {
+    for (k=0; k < Nfloat; ++k) {
+      float y = out[(cplx ? k/2 : k)*stride + (cplx ? 2*b + (k&1) : b)];
+      err = MAX(err, fabs(y - ref[b*Nfloat + k]));
+    }
+  }
+  if (err > 1e-5*ref_max) {
+    printf("%s transposed batch mismatch found for N=%d (%g)\n", (cplx?"CPLX":"REAL"), N, err); exit(1);
+  }
+  pffft_transform_batch(s, howmany, out, stride, out, stride, 0, PFFFT_BACKWARD, PFFFT_BATCH_TRANSPOSED);
+  for (k=0; k < N*stride; ++k) {
+    int b2 = (k % stride) / (cplx ? 2 : 1);
+    if (b2 < howmany && fabs(in[k] - out[k]/N) > 1e-3) {
+      printf("%s transposed batch does not invert for N=%d\n", (cplx?"CPLX":"REAL"), N); exit(1);
+    }
+  }
+
+  // contiguous batch, the transforms must be exactly the single ones
+  for (b=0; b < howmany; ++b) {
+    for (k=0; k < Nfloat; ++k) tmp[b*Nfloat + k] = in[k];
+  }
+  pffft_transform_batch(s, howmany, tmp, Nfloat, tmp, Nfloat, 0, PFFFT_FORWARD, PFFFT_BATCH_ORDERED);
+  pffft_transform_ordered(s, in, x, 0, PFFFT_FORWARD);
+  for (b=0; b < howmany; ++b) {
+    for (k=0; k < Nfloat; ++k) assert(tmp[b*Nfloat + k] == x[k]);
+  }
+
+  printf("%s batches are OK for N=%d\n", (cplx?"CPLX":"REAL"), N); fflush(stdout);
+
+  pffft_destroy_setup(s);
+  pffft_aligned_free(in);
+  pffft_aligned_free(out);
+  pffft_aligned_free(x);
+  pffft_aligned_free(ref);
+  pffft_aligned_free(tmp);
+}
+
+void pffft_validate_batch(int cplx) {
+  static int Ntest[] = { 1, 2, 3, 8, 12, 15, 32, 100, 256, 7*13, 2*37, 0};
+  int k;
+  for (k = 0; Ntest[k]; ++k) {
+    pffft_validate_batch_N(Ntest[k], cplx);
+  }
+}
+
+/* a parallel_for running the tasks in reverse order, to check that they are independent */
+void serial_parallel_for(void *pool, int count, void (*task)(void *arg, int index), void *arg) {
+  int k;
+  for (k=count-1; k >= 0; --k) task(arg, k);
+  ++*(int*)pool;
+}
+
+/* compare the four-step transforms with the regular ones */
+void pffft_validate_threaded_N(int N, int cplx, int nthreads, int own_pool) {
+  int Nfloat = N*(cplx?2:1), Nbytes = Nfloat*sizeof(float), calls = 0, k;
+  float *in = pffft_aligned_malloc(Nbytes), *ref = pffft_aligned_malloc(Nbytes), *out = pffft_aligned_malloc(Nbytes + 2*sizeof(float));
+  PFFFT_Setup *s = pffft_new_setup(N, cplx ? PFFFT_COMPLEX : PFFFT_REAL);
+  PFFFT_Setup *st = pffft_new_setup_threaded(N, cplx ? PFFFT_COMPLEX : PFFFT_REAL, nthreads,
+                                             own_pool ? serial_parallel_for : 0, &calls);
+  float ref_max = 0, err = 0;
+
+  for (k=0; k < Nfloat; ++k) in[k] = frand()*2-1;
+  pffft_transform_ordered(s, in, ref, 0, PFFFT_FORWARD);
+  pffft_transform(st, in, out, 0, PFFFT_FORWARD);
+  for (k=0; k < Nfloat; ++k) {
+    ref_max = MAX(ref_max, fabs(ref[k])); err = MAX(err, fabs(out[k] - ref[k]));
+  }
+  if (err > 1e-5*ref_max*log(N)) {
+    printf("%s four-step mismatch found for N=%d (%g)\n", (cplx?"CPLX":"REAL"), N, err/ref_max); exit(1);
+  }
+  pffft_transform_ordered(st, out, out, 0, PFFFT_BACKWARD);
+  for (k=0; k < Nfloat; ++k) {
+    if (fabs(in[k] - out[k]/N) > 1e-5*log(N)) {
+      printf("%s four-step IFFT does not match for N=%d\n", (cplx?"CPLX":"REAL"), N); exit(1);
+    }
+  }
+  if (own_pool) assert(calls == (cplx ? 4 : 6));
+
+  // half spectrum: F(N/2) at the end of the canonical order
+  pffft_transform(st, in, ref, 0, PFFFT_FORWARD);
+  pffft_transform_halfspectrum(st, in, out, 0, PFFFT_FORWARD);
+  for (k=0; k < Nfloat; ++k) assert(out[k] == (cplx || k != 1 ? ref[k] : 0));
+  if (!cplx) assert(out[N] == ref[1] && out[N+1] == 0);
+  pffft_transform_halfspectrum(st, out, out, 0, PFFFT_BACKWARD);
+  for (k=0; k < Nfloat; ++k) {
+    if (fabs(in[k] - out[k]/N) > 1e-5*log(N)) {
+      printf("%s four-step half spectrum IFFT does not match for N=%d\n", (cplx?"CPLX":"REAL"), N); exit(1);
+    }
+  }
+
+  printf("%s four-step PFFFT is OK for N=%d (%d threads)\n", (cplx?"CPLX":"REAL"), N, nthreads); fflush(stdout);
+  pffft_destroy_setup(s);
+  pffft_destroy_setup(st);
+  pffft_aligned_free(in);
+  pffft_aligned_free(ref);
+  pffft_aligned_free(out);
+}
+
+void pffft_validate_threaded(int cplx) {
+  /* complex sizes that are the product of two multiples of 16, the real sizes being twice them */
+  static int Ntest[] = { 256, 512, 16*48, 7*16*32, 65536, 3*5*4096, 0};
+  PFFFT_Setup *s = pffft_new_setup_threaded(65536, cplx ? PFFFT_COMPLEX : PFFFT_REAL, 0, 0, 0);
+  int k;
+  if (pffft_export_setup(s, 0, 0) == 0) { // nthreads <= 0: a regular setup, which can be exported
+    printf("%s four-step setup with nthreads=0\n", (cplx?"CPLX":"REAL")); exit(1);
+  }
+  pffft_destroy_setup(s);
+  for (k = 0; Ntest[k]; ++k) {
+    pffft_validate_threaded_N(Ntest[k]*(cplx ? 1 : 2), cplx, 3, 0);
+    pffft_validate_threaded_N(Ntest[k]*(cplx ? 1 : 2), cplx, 2, 1);
+  }
+}
+
+/* export / import of setups, the imported ones must give exactly the same results */
+void pffft_validate_export(int N, int cplx) {
+  int Nfloat = N*(cplx?2:1), k, share, hN;
+  PFFFT_Setup *s = pffft_new_setup(N, cplx ? PFFFT_COMPLEX : PFFFT_REAL), *s2;
+  size_t size = pffft_export_setup(s, 0, 0), blob_size = 0;
+  char *blob = pffft_aligned_malloc(2*size + 1);
+  float *in = pffft_aligned_malloc(Nfloat*sizeof(float)), *out = pffft_aligned_malloc(Nfloat*sizeof(float));
+  float *ref = pffft_aligned_malloc(Nfloat*sizeof(float));
+
+  assert(size > 0 && size % 64 == 0);
+  if (pffft_export_setup(s, blob, size - 1) != size || // too small, nothing written
+      pffft_export_setup(s, blob, size) != size) {
+    printf("%s setup export size mismatch for N=%d\n", (cplx?"CPLX":"REAL"), N); exit(1);
+  }
+  for (k=0; k < Nfloat; ++k) in[k] = frand()*2-1;
+  for (share = 0; share < 3; ++share) {
+    const char *b = blob;
+    if (share == 2) { memmove(blob + 1, blob, size); ++b; } // unaligned: copied
+    s2 = pffft_import_setup(b, size, share, &blob_size);
+    assert(s2 && blob_size == size);
+    pffft_transform(s, in, ref, 0, PFFFT_FORWARD);
+    pffft_transform(s2, in, out, 0, PFFFT_FORWARD);
+    assert(memcmp(ref, out, Nfloat*sizeof(float)) == 0);
+    pffft_transform_batch(s, 1, in, cplx ? 2 : 1, ref, cplx ? 2 : 1, 0, PFFFT_BACKWARD, PFFFT_BATCH_TRANSPOSED);
+    pffft_transform_batch(s2, 1, in, cplx ? 2 : 1, out, cplx ? 2 : 1, 0, PFFFT_BACKWARD, PFFFT_BATCH_TRANSPOSED);
+    assert(memcmp(ref, out, Nfloat*sizeof(float)) == 0);
+    pffft_destroy_setup(s2);
+  }
+  memmove(blob, blob + 1, size);
+  s2 = pffft_import_setup(blob, size - 64, 0, 0); // truncated
+  assert(s2 == 0);
+  memcpy(&hN, blob + 32, sizeof(int)); // N, after the magic and 6 ints of the header
+  assert(hN == N);
+  hN = 2*N;
+  memcpy(blob + 32, &hN, sizeof(int));
+  s2 = pffft_import_setup(blob, size, 0, 0); // tables of another size
+  assert(s2 == 0);
+  blob[0] = 'X';
+  s2 = pffft_import_setup(blob, size, 0, 0); // corrupted
+  assert(s2 == 0);
+
+  printf("%s setup export is OK for N=%d\n", (cplx?"CPLX":"REAL"), N);
+  pffft_destroy_setup(s);
+  pffft_aligned_free(blob);
+  pffft_aligned_free(in);
+  pffft_aligned_free(out);
+  pffft_aligned_free(ref);
+}
+
+/* the setups planned with PFFFT_MEASURE give the same results, and their
+   factorization is kept by pffft_export_setup */
+void pffft_validate_measure(int N, int cplx) {
+  int Nfloat = N*(cplx?2:1), k;
+  pffft_transform_t transform = cplx ? PFFFT_COMPLEX : PFFFT_REAL;
+  PFFFT_Setup *s = pffft_new_setup(N, transform), *s2 = pffft_new_setup_plan(N, transform, PFFFT_MEASURE), *s3;
+  size_t size = pffft_export_setup(s2, 0, 0);
+  char *blob = pffft_aligned_malloc(size);
+  float *in = pffft_aligned_malloc(Nfloat*sizeof(float)), *out = pffft_aligned_malloc(Nfloat*sizeof(float));
+  float *ref = pffft_aligned_malloc(Nfloat*sizeof(float));
+  float max_err = 0, max_ref = 0;
+
+  for (k=0; k < Nfloat; ++k) in[k] = frand()*2-1;
+  pffft_transform_ordered(s, in, ref, 0, PFFFT_FORWARD);
+  pffft_transform_ordered(s2, in, out, 0, PFFFT_FORWARD);
+  for (k=0; k < Nfloat; ++k) {
+    max_err = MAX(max_err, fabs(out[k] - ref[k]));
+    max_ref = MAX(max_ref, fabs(ref[k]));
+  }
+  if (max_err > 1e-5*max_ref) {
+    printf("%s measured setup mismatch for N=%d: %g\n", (cplx?"CPLX":"REAL"), N, max_err/max_ref); exit(1);
+  }
+  pffft_transform(s2, in, ref, 0, PFFFT_FORWARD);
+  pffft_transform(s2, ref, out, 0, PFFFT_BACKWARD);
+  for (k=0; k < Nfloat; ++k) {
+    if (fabs(in[k] - out[k]/N) > 1e-3) {
+      printf("%s measured setup round trip error for N=%d\n", (cplx?"CPLX":"REAL"), N); exit(1);
+    }
+  }
+  if (pffft_export_setup(s2, blob, size) != size) {
+    printf("%s measured setup export size mismatch for N=%d\n", (cplx?"CPLX":"REAL"), N); exit(1);
+  }
+  s3 = pffft_import_setup(blob, size, 0, 0);
+  pffft_transform(s2, in, ref, 0, PFFFT_FORWARD);
+  pffft_transform(s3, in, out, 0, PFFFT_FORWARD);
+  assert(memcmp(ref, out, Nfloat*sizeof(float)) == 0);
+
+  printf("%s measured setup is OK for N=%d\n", (cplx?"CPLX":"REAL"), N);
+  pffft_destroy_setup(s);
+  pffft_destroy_setup(s2);
+  pffft_destroy_setup(s3);
+  pffft_aligned_free(blob);
+  pffft_aligned_free(in);
+  pffft_aligned_free(out);
+  pffft_aligned_free(ref);
+}
+
+/* the setups built in caller memory are the same as the ones of pffft_new_setup */
+void pffft_validate_init_setup(int N, int cplx) {
+  int Nfloat = N*(cplx?2:1), k;
+  pffft_transform_t transform = cplx ? PFFFT_COMPLEX : PFFFT_REAL;
+  size_t size = pffft_setup_size(N, transform);
+  char *buffer = malloc(size + 2);
+  PFFFT_Setup *s = pffft_new_setup(N, transform), *s2;
+  float *in = pffft_aligned_malloc(Nfloat*sizeof(float)), *out = pffft_aligned_malloc(Nfloat*sizeof(float));
+  float *ref = pffft_aligned_malloc(Nfloat*sizeof(float));
+
+  assert(size > 0);
+  memset(buffer, 0xff, size + 2);
+  s2 = pffft_init_setup(buffer + 1, N, transform); // not aligned
+  assert(s2 && (char*)s2 >= buffer + 1 && (char*)s2 < buffer + 65);
+  assert(buffer[size + 1] == (char)0xff); // nothing written past the end
+  for (k=0; k < Nfloat; ++k) in[k] = frand()*2-1;
+  pffft_transform_ordered(s, in, ref, 0, PFFFT_FORWARD);
+  pffft_transform_ordered(s2, in, out, 0, PFFFT_FORWARD);
+  assert(memcmp(ref, out, Nfloat*sizeof(float)) == 0);
+  pffft_transform_batch(s, 1, in, cplx ? 2 : 1, ref, cplx ? 2 : 1, 0, PFFFT_BACKWARD, PFFFT_BATCH_TRANSPOSED);
+  pffft_transform_batch(s2, 1, in, cplx ? 2 : 1, out, cplx ? 2 : 1, 0, PFFFT_BACKWARD, PFFFT_BATCH_TRANSPOSED);
+  assert(memcmp(ref, out, Nfloat*sizeof(float)) == 0);
+  pffft_destroy_setup(s2); // does nothing
+  size = pffft_setup_size(0, transform);
+  s2 = pffft_init_setup(buffer, 0, transform);
+  assert(size == 0 && s2 == 0);
+
+  printf("%s setup in caller memory is OK for N=%d\n", (cplx?"CPLX":"REAL"), N);
+  pffft_destroy_setup(s);
+  free(buffer);
+  pffft_aligned_free(in);
+  pffft_aligned_free(out);
+  pffft_aligned_free(ref);
+}
+
+/* the transforms with a NULL 'work' give the same results with their
+   scratch area in the thread local arena */
+void pffft_validate_scratch(int N, int cplx, int threaded) {
+  int Nfloat = N*(cplx?2:1), k, calls = 0;
+  pffft_transform_t transform = cplx ? PFFFT_COMPLEX : PFFFT_REAL;
+  PFFFT_Setup *s = (threaded ? pffft_new_setup_threaded(N, transform, 2, serial_parallel_for, &calls)
+                    : pffft_new_setup(N, transform));
+  size_t work_size = pffft_work_size(s);
+  float *in = pffft_aligned_malloc(Nfloat*sizeof(float)), *out = pffft_aligned_malloc(Nfloat*sizeof(float));
+  float *ref = pffft_aligned_malloc(Nfloat*sizeof(float));
+  float *work = (work_size ? pffft_aligned_malloc(work_size) : 0);
+
+  assert(work_size == 0 || work_size == Nfloat*sizeof(float));
+  for (k=0; k < Nfloat; ++k) in[k] = frand()*2-1;
+  pffft_transform_ordered(s, in, ref, work, PFFFT_FORWARD);
+  pffft_scratch_mode(PFFFT_SCRATCH_THREAD);
+  if (!pffft_scratch_reserve(pffft_scratch_size(s, PFFFT_BATCH_TRANSPOSED))) {
+    printf("scratch arena reservation failed for N=%d\n", N); exit(1);
+  }
+  pffft_transform_ordered(s, in, out, 0, PFFFT_FORWARD);
+  assert(memcmp(ref, out, Nfloat*sizeof(float)) == 0);
+  pffft_transform_batch(s, 1, in, cplx ? 2 : 1, ref, cplx ? 2 : 1, work, PFFFT_BACKWARD, PFFFT_BATCH_TRANSPOSED);
+  pffft_transform_batch(s, 1, in, cplx ? 2 : 1, out, cplx ? 2 : 1, 0, PFFFT_BACKWARD, PFFFT_BATCH_TRANSPOSED);
+  assert(memcmp(ref, out, Nfloat*sizeof(float)) == 0);
+  pffft_scratch_release();
+  pffft_scratch_mode(PFFFT_SCRATCH_AUTO);
+
+  printf("%s scratch arena is OK for N=%d%s\n", (cplx?"CPLX":"REAL"), N, (threaded ? " (four-step)" : ""));
+  pffft_destroy_setup(s);
+  pffft_aligned_free(in);
+  pffft_aligned_free(out);
+  pffft_aligned_free(ref);
+  pffft_aligned_free(work);
+}
+
+/* compare the streaming convolution with a direct one, the input being
+   fed in blocks of various lengths */
+/* max_block_size == 0 for the uniform convolver */
+void pffft_validate_convolver(int block_size, int max_block_size, int ir_len) {
+  const int nblocks = MAX(40, 3*(ir_len + max_block_size)/block_size), len = nblocks*block_size;
+  float *ir = malloc(ir_len*sizeof(float)), *in = malloc(len*sizeof(float)), *out = malloc(len*sizeof(float));
+  PFFFT_Convolver *c;
+  double err = 0, ref_max = 0;
+  int b, k, j;
+
+  for (k=0; k < ir_len; ++k) ir[k] = (frand()*2-1)*exp(-4.0*k/ir_len);
+  c = pffft_new_convolver(0, ir, ir_len);
+  assert(c == 0);
+  c = pffft_new_convolver(block_size, ir, 0);
+  assert(c == 0);
+  c = pffft_new_convolver_nonuniform(block_size, max_block_size, ir, 0);
+  assert(c == 0);
+  if (max_block_size) {
+    c = pffft_new_convolver_nonuniform(block_size, max_block_size, ir, ir_len);
+  } else {
+    c = pffft_new_convolver(block_size, ir, ir_len);
+  }
+  for (k=0; k < len; ++k) in[k] = frand()*2-1;
+  for (b=0; b < nblocks; ++b) {
+    if (b == nblocks/2) pffft_convolver_reset(c); // the stream starts again
+    memcpy(out + b*block_size, in + b*block_size, block_size*sizeof(float));
+    pffft_convolver_process(c, out + b*block_size, out + b*block_size); // in place
+  }
+  for (k=0; k < len; ++k) {
+    int start = (k >= (nblocks/2)*block_size ? (nblocks/2)*block_size : 0);
+    double y = 0;
+    for (j=0; j < ir_len && k - j >= start; ++j) y += (double)ir[j]*in[k - j];
+    err = MAX(err, fabs(out[k] - y));
+    ref_max = MAX(ref_max, fabs(y));
+  }
+  if (err > 1e-5*ref_max) {
+    printf("convolver error for block_size=%d max_block_size=%d ir_len=%d : %g (max %g)\n", block_size, max_block_size, ir_len, err, ref_max);
+    exit(1);
+  }
+
+  printf("convolver is OK for block_size=%d max_block_size=%d ir_len=%d\n", block_size, max_block_size, ir_len);
+  pffft_destroy_convolver(c);
+  free(ir);
+  free(in);
+  free(out);
+}
+
+/* the frames of the streaming STFT, fed with blocks of various sizes, against pffft_transform */
+void pffft_validate_stft(int N, int hop, int ordered) {
+  const int len = 20*N + 7;
+  float *in = malloc(len*sizeof(float)), *window = malloc(N*sizeof(float));
+  float *frames = pffft_aligned_malloc((len/hop + 1)*(size_t)N*sizeof(float));
+  float *ref = pffft_aligned_malloc(N*sizeof(float));
+  PFFFT_Setup *s = pffft_new_setup(N, PFFFT_REAL);
+  PFFFT_Stft *st;
+  int pos, nframes = 0, start, half, chunk, f, k;
+
+  st = pffft_new_stft(N, 0, window, ordered);
+  assert(st == 0);
+  st = pffft_new_stft(N, N+1, window, ordered);
+  assert(st == 0);
+  for (k=0; k < N; ++k) window[k] = 0.5f - 0.5f*cos(2*M_PI*k/N);
+  for (k=0; k < len; ++k) in[k] = frand()*2-1;
+  st = pffft_new_stft(N, hop, window, ordered);
+  for (half=0; half < 2; ++half) { // the stream starts again at len/2
+    int end = (half ? len : len/2);
+    start = (half ? len/2 : 0);
+    if (half) pffft_stft_reset(st);
+    for (pos=start, chunk=1; pos < end; chunk = chunk*7 % 1000 + 1) {
+      int n = (chunk < end - pos ? chunk : end - pos);
+      f = pffft_stft_process(st, in + pos, n, frames + (size_t)nframes*N);
+      pos += n;
+      /* the frames end at start + hop, start + 2*hop, ... */
+      for (k=0; k < f; ++k, ++nframes) {
+        int t = start + ((pos - start)/hop - f + 1 + k)*hop, j;
+        float *y = frames + (size_t)nframes*N;
+        for (j=0; j < N; ++j) ref[j] = (t - N + j >= start ? in[t - N + j]*window[j] : 0);
+        if (ordered) pffft_transform_ordered(s, ref, ref, 0, PFFFT_FORWARD);
+        else pffft_transform(s, ref, ref, 0, PFFFT_FORWARD);
+        for (j=0; j < N; ++j) {
+          if (y[j] != ref[j]) {
+            printf("stft mismatch for N=%d hop=%d, frame ending at %d, bin %d : %g %g\n", N, hop, t, j, y[j], ref[j]);
+            exit(1);
+          }
+        }
+      }
+    }
+  }
+  assert(nframes == (len/2)/hop + (len - len/2)/hop);
+
+  printf("stft is OK for N=%d hop=%d ordered=%d\n", N, hop, ordered);
+  pffft_destroy_stft(st);
+  pffft_destroy_setup(s);
+  pffft_aligned_free(frames);
+  pffft_aligned_free(ref);
+  free(in);
+  free(window);
+}
+
+/* STFT then ISTFT give back the input, delayed by N - hop samples. hann != 0 for Hann windows, rectangular otherwise */
+void pffft_validate_istft(int N, int hop, int hann, int ordered) {
+  const int nframes = 40, len = nframes*hop, delay = N - hop;
+  float *in = malloc(len*sizeof(float)), *out = malloc(len*sizeof(float)), *window = malloc(N*sizeof(float));
+  float *frame = pffft_aligned_malloc(N*sizeof(float));
+  PFFFT_Stft *st;
+  PFFFT_Istft *ist;
+  double err = 0;
+  int f, k;
+
+  ist = pffft_new_istft(N, 0, 0, 0, ordered);
+  assert(ist == 0);
+  ist = pffft_new_istft(N, N+1, 0, 0, ordered);
+  assert(ist == 0);
+  for (k=0; k < N; ++k) window[k] = (hann ? 0.5f - 0.5f*cos(2*M_PI*k/N) : 1.f);
+  for (k=0; k < len; ++k) in[k] = frand()*2-1;
+  st = pffft_new_stft(N, hop, window, ordered);
+  ist = pffft_new_istft(N, hop, window, window, ordered);
+  for (f=0; f < nframes; ++f) {
+    if (f == nframes/2) { // the stream starts again
+      pffft_stft_reset(st);
+      pffft_istft_reset(ist);
+    }
+    if (pffft_stft_process(st, in + f*hop, hop, frame) != 1) {
+      printf("istft test: no stft frame for N=%d hop=%d\n", N, hop); exit(1);
+    }
+    pffft_istft_process(ist, frame, out + f*hop);
+  }
+  for (k=0; k < len; ++k) {
+    int start = (k >= (nframes/2)*hop ? (nframes/2)*hop : 0);
+    err = MAX(err, fabs(out[k] - (k - delay >= start ? in[k - delay] : 0)));
+  }
+  if (err > 1e-5) {
+    printf("istft error for N=%d hop=%d : %g\n", N, hop, err);
+    exit(1);
+  }
+
+  printf("istft is OK for N=%d hop=%d hann=%d ordered=%d\n", N, hop, hann, ordered);
+  pffft_destroy_stft(st);
+  pffft_destroy_istft(ist);
+  pffft_aligned_free(frame);
+  free(in);
+  free(out);
+  free(window);
+}
+
+/* reference counting and eviction of the shared setups */
+void pffft_validate_setup_cache() {
+  PFFFT_Setup *a, *b, *c;
+  long hits0, hits, misses0, misses;
+  int count, k;
+
+  pffft_setup_cache_limit(0);
+  pffft_setup_cache_stats(&hits0, &misses0, &count);
+  assert(count == 0);
+  pffft_setup_cache_limit(4);
+  a = pffft_get_setup(512, PFFFT_REAL);
+  b = pffft_get_setup(512, PFFFT_REAL);
+  c = pffft_get_setup(512, PFFFT_COMPLEX);
+  pffft_setup_cache_stats(&hits, &misses, &count);
+  assert(misses - misses0 + hits - hits0 == 3 && a != c);
+  if (count) { // otherwise the cache is not available on this platform
+    assert(a == b && count == 2 && hits - hits0 == 1);
+  }
+  pffft_release_setup(a);
+  pffft_release_setup(b);
+  pffft_release_setup(c);
+
+  /* at most 4 setups are kept, the ones in use are never evicted */
+  for (k=1; k <= 8; ++k) pffft_release_setup(pffft_get_setup(32*k, PFFFT_COMPLEX));
+  pffft_setup_cache_stats(0, 0, &count);
+  assert(count <= 4);
+  a = pffft_get_setup(512, PFFFT_REAL);
+  pffft_setup_cache_limit(0);
+  pffft_setup_cache_stats(0, 0, &count);
+  assert(count <= 1);
+  pffft_release_setup(a);
+  pffft_setup_cache_limit(0);
+  pffft_setup_cache_stats(0, 0, &count);
+  assert(count == 0);
+  pffft_setup_cache_limit(64);
+  printf("setup cache is OK\n");
+}
+
+/* compare the double precision transforms with a plain dft computed in
+   double precision (fftpack.c is built for floats) */
+void pffftd_validate_N(int N, int cplx) {
+  int Ndouble = N*(cplx?2:1);
+  int Nbytes = Ndouble * sizeof(double);
+  double *ref, *in, *out, *tmp, *tmp2, *cs;
+  double ref_max = 0, conv_err = 0, conv_max = 0;
+  PFFFTD_Setup *s = pffftd_new_setup(N, cplx ? PFFFT_COMPLEX : PFFFT_REAL);
+  int j, k;
+
+  if (!s) { printf("Skipping N=%d, not supported\n", N); return; }
+  ref = pffft_aligned_malloc(Nbytes);
+  in = pffft_aligned_malloc(Nbytes);
+  out = pffft_aligned_malloc(Nbytes);
+  tmp = pffft_aligned_malloc(Nbytes);
+  tmp2 = pffft_aligned_malloc(Nbytes);
+  cs = malloc(2*N*sizeof(double));
+
+  for (k=0; k < Ndouble; ++k) in[k] = frand()*2-1;
+  for (k=0; k < N; ++k) { cs[2*k] = cos(2*M_PI*k/N); cs[2*k+1] = -sin(2*M_PI*k/N); }
+  for (k=0; k < (cplx ? N : N/2+1); ++k) {
+    double xr = 0, xi = 0;
+    for (j=0; j < N; ++j) {
+      double wr = cs[2*((j*(long)k)%N)], wi = cs[2*((j*(long)k)%N)+1];
+      double ar = cplx ? in[2*j] : in[j], ai = cplx ? in[2*j+1] : 0;
+      xr += ar*wr - ai*wi; xi += ar*wi + ai*wr;
+    }
+    if (cplx) { ref[2*k] = xr; ref[2*k+1] = xi; }
+    else if (k == 0) ref[0] = xr;
+    else if (k == N/2) ref[1] = xr;
+    else { ref[2*k] = xr; ref[2*k+1] = xi; }
+  }
+  for (k = 0; k < Ndouble; ++k) ref_max = MAX(ref_max, fabs(ref[k]));
+
+  // unordered transform, in-place and out-of-place, and reordering
+  pffftd_transform(s, in, tmp, 0, PFFFT_FORWARD);
+  memcpy(tmp2, in, Nbytes);
+  pffftd_transform(s, tmp2, tmp2, 0, PFFFT_FORWARD);
+  for (k = 0; k < Ndouble; ++k) assert(tmp2[k] == tmp[k]);
+  pffftd_zreorder(s, tmp, out, PFFFT_FORWARD);
+  pffftd_zreorder(s, out, tmp2, PFFFT_BACKWARD);
+  for (k = 0; k < Ndouble; ++k) assert(tmp2[k] == tmp[k]);
+  pffftd_transform_ordered(s, in, tmp2, 0, PFFFT_FORWARD);
+  for (k=0; k < Ndouble; ++k) {
+    if (!(fabs(ref[k] - out[k]) < 1e-12*N*ref_max) || tmp2[k] != out[k]) {
+      printf("%s forward PFFFTD mismatch found for N=%d\n", (cplx?"CPLX":"REAL"), N);
+      exit(1);
+    }
+  }
+
+  // half spectrum: the canonical order, with F(N/2) at the end
+  {
+    double *half = pffft_aligned_malloc((Ndouble + 2)*sizeof(double));
+    pffftd_transform_halfspectrum(s, in, half, 0, PFFFT_FORWARD);
+    for (k=0; k < Ndouble; ++k) {
+      assert(half[k] == (cplx || k != 1 ? out[k] : 0));
+    }
+    if (!cplx) assert(half[N] == out[1] && half[N+1] == 0);
+    pffftd_transform_halfspectrum(s, half, half, 0, PFFFT_BACKWARD);
+    for (k = 0; k < Ndouble; ++k) {
+      if (fabs(in[k] - half[k]/N) > 1e-12*N) {
+        printf("%s half spectrum IFFFT PFFFTD does not match for N=%d\n", (cplx?"CPLX":"REAL"), N);
+        exit(1);
+      }
+    }
+    pffft_aligned_free(half);
+  }
+
+  // backward transform
+  pffftd_transform(s, tmp, out, 0, PFFFT_BACKWARD);
+  for (k = 0; k < Ndouble; ++k) {
+    if (fabs(in[k] - out[k]/N) > 1e-12*N) {
+      printf("%s IFFFT PFFFTD does not match for N=%d\n", (cplx?"CPLX":"REAL"), N);
+      exit(1);
+    }
+  }
+
+  // circular convolution in fft domain
+  memset(out, 0, Nbytes);
+  pffftd_zconvolve_accumulate(s, tmp, tmp, out, 0.5);
+  pffftd_zreorder(s, out, tmp2, PFFFT_FORWARD);
+  for (k=0; k < Ndouble; k += 2) {
+    double ar = ref[k], ai = ref[k+1], cr, ci;
+    if (cplx || k > 0) { cr = ar*ar - ai*ai; ci = 2*ar*ai; }
+    else { cr = ar*ar; ci = ai*ai; }
+    conv_err = MAX(conv_err, MAX(fabs(0.5*cr - tmp2[k]), fabs(0.5*ci - tmp2[k+1])));
+    conv_max = MAX(conv_max, MAX(fabs(cr), fabs(ci)));
+  }
+  if (conv_err > 1e-12*conv_max) {
+    printf("zconvolve error ? %g %g\n", conv_err, conv_max); exit(1);
+  }
+  {
+    const double *va[2], *vb[2];
+    va[0] = tmp; va[1] = in;
+    vb[0] = in; vb[1] = in;
+    memcpy(out, in, Nbytes);
+    memcpy(tmp2, in, Nbytes);
+    pffftd_zconvolve_accumulate_many(s, 2, va, vb, out, 0.5);
+    for (k=0; k < 2; ++k) pffftd_zconvolve_accumulate(s, va[k], vb[k], tmp2, 0.5);
+    for (k=0; k < Ndouble; ++k) {
+      if (fabs(out[k] - tmp2[k]) > 1e-12*N*conv_max) {
+        printf("zconvolve_many error ? %g\n", fabs(out[k] - tmp2[k])); exit(1);
+      }
+    }
+  }
+
+  printf("%s PFFFTD is OK for N=%d\n", (cplx?"CPLX":"REAL"), N); fflush(stdout);
+
+  pffftd_destroy_setup(s);
+  pffft_aligned_free(ref);
+  pffft_aligned_free(in);
+  pffft_aligned_free(out);
+  pffft_aligned_free(tmp);
+  pffft_aligned_free(tmp2);
+  free(cs);
+}
+
+void pffftd_validate(int cplx) {
+  static int Ntest[] = { 4, 8, 16, 32, 48, 64, 96, 128, 160, 192, 256, 288, 384, 5*96, 512, 576, 5*128, 800, 864, 1024, 2048, 2592, 4000, 4096,
+                         7*32, 11*64, 13*16, 17*32, 0};
+  int k;
+  for (k = 0; Ntest[k]; ++k) {
+    pffftd_validate_N(Ntest[k], cplx);
+  }
+}
+
+/* reference dft in long double for the accuracy tests: mixed radix,
+   recursive decimation in time. 'roots' holds the Nroots complex
+   exp(-2*i*pi*j/Nroots), N dividing Nroots */
+static void dft_ld(int N, const long double *in, int stride, long double *out, const long double *roots, int Nroots) {
+  long double ybuf[2*16], *y = ybuf;
+  int p, m, r, q, k;
+  if (N == 1) { out[0] = in[0]; out[1] = in[1]; return; }
+  for (p = 2; N % p; ++p) {}
+  m = N/p;
+  for (r=0; r < p; ++r) dft_ld(m, in + 2*r*stride, stride*p, out + 2*r*m, roots, Nroots);
+  if (p > 16) y = malloc(2*p*sizeof(long double));
+  for (k=0; k < m; ++k) {
+    for (r=0; r < p; ++r) { y[2*r] = out[2*(r*m + k)]; y[2*r+1] = out[2*(r*m + k)+1]; }
+    for (q=0; q < p; ++q) {
+      long double re = 0, im = 0;
+      for (r=0; r < p; ++r) {
+        const long double *w = roots + 2*(((long long)r*(k + q*m)) % N)*(Nroots/N);
+        re += y[2*r]*w[0] - y[2*r+1]*w[1];
+        im += y[2*r]*w[1] + y[2*r+1]*w[0];
+      }
+      out[2*(q*m + k)] = re; out[2*(q*m + k)+1] = im;
+    }
+  }
+  if (y != ybuf) free(y);
+}
+
+/* accuracy of the transforms of size N (even for real transforms): rms
+   and max errors of the forward transform, relative to the rms and max
+   magnitudes of a long double reference dft, and rms error of the round
+   trip. Float rounding with correctly rounded twiddles gives an rms
+   error of about 4e-8 * sqrt(log2(N)) (up to 4.1e-8 for the radix 3 and
+   5 sizes); the check allows 6e-8 * sqrt(log2(N)), the 1.5x margin
+   covering the spread of the random inputs and of the simd flavours */
+void pffft_accuracy(int N, int cplx) {
+  int Nfloat = N*(cplx?2:1), k;
+  PFFFT_Setup *s = pffft_new_setup(N, cplx ? PFFFT_COMPLEX : PFFFT_REAL);
+  float *in = pffft_aligned_malloc(Nfloat*sizeof(float)), *out = pffft_aligned_malloc(Nfloat*sizeof(float));
+  long double *x = malloc(2*N*sizeof(long double)), *ref = malloc(2*N*sizeof(long double));
+  long double *roots = malloc(2*N*sizeof(long double));
+  double err2 = 0, ref2 = 0, err_max = 0, ref_max = 0, rt2 = 0, in2 = 0, rms;
+
+  for (k=0; k < N; ++k) {
+    long double A = -2*3.141592653589793238462643383279502884L*k/N;
+    roots[2*k] = cosl(A);
+    roots[2*k+1] = sinl(A);
+  }
+  for (k=0; k < Nfloat; ++k) in[k] = frand()*2-1;
+  for (k=0; k < N; ++k) {
+    x[2*k] = (cplx ? in[2*k] : in[k]);
+    x[2*k+1] = (cplx ? in[2*k+1] : 0);
+  }
+  dft_ld(N, x, 1, ref, roots, N);
+  if (!cplx) {
+    /* the pffft order for real transforms: r(0), r(N/2), then r(k), i(k) */
+    ref[1] = ref[N];
+  }
+  pffft_transform_ordered(s, in, out, 0, PFFFT_FORWARD);
+  for (k=0; k < Nfloat; ++k) {
+    double e = fabs((double)(out[k] - ref[k]));
+    err2 += e*e;
+    ref2 += (double)(ref[k]*ref[k]);
+    err_max = MAX(err_max, e);
+    ref_max = MAX(ref_max, fabs((double)ref[k]));
+  }
+  pffft_transform_ordered(s, out, out, 0, PFFFT_BACKWARD);
+  for (k=0; k < Nfloat; ++k) {
+    double e = out[k]/N - in[k];
+    rt2 += e*e;
+    in2 += (double)in[k]*in[k];
+  }
+  rms = sqrt(err2/ref2);
+  printf("N=%7d, %s accuracy: rms err %8.2e, max err %8.2e, round trip rms err %8.2e\n", N, (cplx?"CPLX":"REAL"),
+         rms, err_max/ref_max, sqrt(rt2/in2));
+  fflush(stdout);
+  if (rms > 6e-8*sqrt(log((double)N)/M_LN2)) {
+    printf("%s transform too inaccurate for N=%d\n", (cplx?"CPLX":"REAL"), N); exit(1);
+  }
+
+  pffft_destroy_setup(s);
+  pffft_aligned_free(in);
+  pffft_aligned_free(out);
+  free(x);
+  free(ref);
+  free(roots);
+}
+
 int array_output_format = 0;
 
 void show_output(const char *name, int N, int cplx, float flops, float t0, float t1, int max_iter) {
@@ -352,6 +1146,26 @@ void benchmark_ffts(int N, int cplx) {
     }
   }
 
+  // PFFFT double precision benchmark (not shown in the array output format)
+  if (!array_output_format) {
+    PFFFTD_Setup *s = pffftd_new_setup(N, cplx ? PFFFT_COMPLEX : PFFFT_REAL);
+    double *Xd = pffft_aligned_malloc(2*Nbytes), *Yd = pffft_aligned_malloc(2*Nbytes), *Zd = pffft_aligned_malloc(2*Nbytes);
+    if (s) {
+      memset(Xd, 0, 2*Nbytes);
+      t0 = uclock_sec();
+      for (iter = 0; iter < max_iter; ++iter) {
+        pffftd_transform(s, Xd, Zd, Yd, PFFFT_FORWARD);
+        pffftd_transform(s, Xd, Zd, Yd, PFFFT_BACKWARD);
+      }
+      t1 = uclock_sec();
+      pffftd_destroy_setup(s);
+
+      flops = (max_iter*2) * ((cplx ? 5 : 2.5)*N*log((double)N)/M_LN2); // see http://www.fftw.org/speed/method.html
+      show_output("PFFFTD", N, cplx, flops, t0, t1, max_iter);
+    }
+    pffft_aligned_free(Xd); pffft_aligned_free(Yd); pffft_aligned_free(Zd);
+  }
+
   if (!array_output_format) {
     printf("--\n");
   }
@@ -361,30 +1175,121 @@ void benchmark_ffts(int N, int cplx) {
   pffft_aligned_free(Z);
 }
 
+/* scaling of the four-step transforms with the number of threads */
+void benchmark_threaded(int N, int cplx) {
+  static int nthreads[] = { 1, 2, 4, 8, 16, 0 };
+  int Nfloat = (cplx ? N*2 : N), max_iter = 5120000/N*4, iter, k;
+  float *X = pffft_aligned_malloc(Nfloat*sizeof(float)), *Y = pffft_aligned_malloc(Nfloat*sizeof(float)), *Z = pffft_aligned_malloc(Nfloat*sizeof(float));
+  double flops = (max_iter*2) * ((cplx ? 5 : 2.5)*N*log((double)N)/M_LN2), t0, t1, t_single;
+  PFFFT_Setup *s = pffft_new_setup(N, cplx ? PFFFT_COMPLEX : PFFFT_REAL);
+
+  memset(X, 0, Nfloat*sizeof(float));
+  /* the reference is the single threaded pffft_transform of the same size */
+  t0 = wclock_sec();
+  for (iter = 0; iter < max_iter; ++iter) {
+    pffft_transform(s, X, Z, Y, PFFFT_FORWARD);
+    pffft_transform(s, X, Z, Y, PFFFT_BACKWARD);
+  }
+  t1 = wclock_sec(); t_single = t1 - t0;
+  pffft_destroy_setup(s);
+  show_output("PFFFT", N, cplx, flops, 0, t_single, max_iter);
+  for (k = 0; nthreads[k]; ++k) {
+    char name[32];
+    s = pffft_new_setup_threaded(N, cplx ? PFFFT_COMPLEX : PFFFT_REAL, nthreads[k], 0, 0);
+    pffft_transform(s, X, Z, Y, PFFFT_FORWARD); // starts the threads of the pool
+    t0 = wclock_sec();
+    for (iter = 0; iter < max_iter; ++iter) {
+      pffft_transform(s, X, Z, Y, PFFFT_FORWARD);
+      pffft_transform(s, X, Z, Y, PFFFT_BACKWARD);
+    }
+    t1 = wclock_sec();
+    pffft_destroy_setup(s);
+    sprintf(name, "4-step %2d thr", nthreads[k]);
+    show_output(name, N, cplx, flops, 0, t1 - t0, max_iter);
+    printf("%40s x%.2f\n", "speedup vs PFFFT:", t_single/(t1 - t0));
+  }
+  printf("--\n");
+  pffft_aligned_free(X);
+  pffft_aligned_free(Y);
+  pffft_aligned_free(Z);
+}
+
 #ifndef PFFFT_SIMD_DISABLE
 void validate_pffft_simd(); // a small function inside pffft.c that will detect compiler bugs with respect to simd instruction 
 #endif
 
 int main(int argc, char **argv) {
   int Nvalues[] = { 64, 96, 128, 160, 192, 256, 384, 5*96, 512, 5*128, 3*256, 800, 1024, 2048, 2400, 4096, 8192, 9*1024, 16384, 32768, 256*1024, 1024*1024, -1 };
-  int i;
+  int i, simd;
 
   if (argc > 1 && strcmp(argv[1], "--array-format") == 0) {
     array_output_format = 1;
   }
 
+  pffft_validate_setup_cache();
+
+  // test all the simd versions available on this cpu
+  for (simd = PFFFT_SIMD_SCALAR; simd <= PFFFT_SIMD_NEON; ++simd) {
+    if (!pffft_simd_select((pffft_simd_t)simd)) continue;
+    printf("testing the %s version of pffft\n", pffft_simd_arch());
 #ifndef PFFFT_SIMD_DISABLE
-  validate_pffft_simd();
+    validate_pffft_simd();
 #endif
-  pffft_validate(1);
-  pffft_validate(0);
+    pffft_validate(1);
+    pffft_validate(0);
+    pffft_validate_batch(1);
+    pffft_validate_batch(0);
+    pffft_validate_threaded(1);
+    pffft_validate_threaded(0);
+    pffft_validate_export(7*64, 1);
+    pffft_validate_export(7*64, 0);
+    pffft_validate_measure(11*13*32, 1);
+    pffft_validate_measure(11*13*32, 0);
+    pffft_validate_init_setup(7*64, 1);
+    pffft_validate_init_setup(7*64, 0);
+    pffft_validate_init_setup(1031, 1); // chirp-z
+    pffft_validate_init_setup(30, 0);
+    pffft_validate_scratch(65536, 1, 0);
+    pffft_validate_scratch(65536, 0, 0);
+    pffft_validate_scratch(1031, 1, 0); // chirp-z
+    pffft_validate_scratch(65536, 1, 1);
+    pffft_validate_scratch(65536, 0, 1);
+    pffft_validate_convolver(64, 0, 1000);
+    pffft_validate_convolver(256, 0, 256);
+    pffft_validate_convolver(100, 0, 37);
+    pffft_validate_convolver(64, 1024, 5000);
+    pffft_validate_convolver(48, 200, 3000);
+    pffft_validate_convolver(32, 32, 700);
+    pffft_validate_convolver(64, 256, 40);
+    pffft_validate_stft(512, 128, 1);
+    pffft_validate_stft(1000, 250, 0);
+    pffft_validate_stft(97, 97, 1);
+    pffft_validate_istft(512, 128, 1, 1);
+    pffft_validate_istft(1000, 300, 1, 0);
+    pffft_validate_istft(256, 256, 0, 0);
+    printf("testing the %s version of pffftd\n", pffftd_simd_arch());
+    pffftd_validate(1);
+    pffftd_validate(0);
+  }
+  pffft_simd_select(PFFFT_SIMD_AUTO);
   if (!array_output_format) {
+    printf("accuracy of the %s version of pffft\n", pffft_simd_arch());
+    for (i=0; Nvalues[i] > 0; ++i) {
+      pffft_accuracy(Nvalues[i], 0);
+      pffft_accuracy(Nvalues[i], 1);
+    }
+    printf("benchmarking the %s version of pffft\n", pffft_simd_arch());
     for (i=0; Nvalues[i] > 0; ++i) {
       benchmark_ffts(Nvalues[i], 0 /* real fft */);
     }
     for (i=0; Nvalues[i] > 0; ++i) {
       benchmark_ffts(Nvalues[i], 1 /* cplx fft */);
     }
+    printf("benchmarking the multithreaded four-step transforms\n");
+    benchmark_threaded(256*1024, 0);
+    benchmark_threaded(256*1024, 1);
+    benchmark_threaded(1024*1024, 0);
+    benchmark_threaded(1024*1024, 1);
   } else {
     printf("| input len ");
     printf("|real FFTPack");